@@ -0,0 +1,15 @@
+#include "AudioBackend.h"
+
+#ifdef __ANDROID__
+#include "OboeAudioBackend.h"
+#else
+#include "SoftwareAudioBackends.h"
+#endif
+
+std::unique_ptr<AudioBackend> createDefaultAudioBackend() {
+#ifdef __ANDROID__
+    return std::make_unique<OboeAudioBackend>();
+#else
+    return std::make_unique<NullAudioBackend>();
+#endif
+}
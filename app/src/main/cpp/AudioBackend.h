@@ -0,0 +1,57 @@
+#ifndef NOISYSYNTH_AUDIOBACKEND_H
+#define NOISYSYNTH_AUDIOBACKEND_H
+
+#include <cstdint>
+#include <memory>
+
+/**
+ * Driven by an AudioBackend.
+ *
+ * onPrepare() runs on the control thread whenever the backend (re)opens the
+ * device, before any onAudioReady() at that rate; this is where rate
+ * dependent state and scratch buffers get set up. onAudioReady() runs on the
+ * audio thread; output holds numFrames * channelCount interleaved floats,
+ * with numFrames never above maxFramesPerBuffer.
+ */
+class AudioCallback {
+public:
+    virtual ~AudioCallback() = default;
+    virtual void onPrepare(float sampleRate, int32_t maxFramesPerBuffer) = 0;
+    virtual void onAudioReady(float* output, int32_t numFrames) = 0;
+};
+
+struct AudioBackendConfig {
+    int32_t sampleRate = 48000;     // requested; 0 = the device's native rate
+    int32_t channelCount = 1;
+    int32_t framesPerBuffer = 0;    // 0 = backend default
+};
+
+/**
+ * Something that pulls audio from an AudioCallback: an Oboe stream on
+ * Android, or one of the software backends in SoftwareAudioBackends.h.
+ *
+ * open() -> start() -> stop() -> close(), all from one control thread.
+ * stop() returns only once no onAudioReady() is running or will run, so the
+ * caller may re-prepare the callback right after it.
+ * getSampleRate() and getFramesPerBuffer() are valid after open().
+ */
+class AudioBackend {
+public:
+    virtual ~AudioBackend() = default;
+
+    virtual bool open(const AudioBackendConfig& config, AudioCallback* callback) = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual void close() = 0;
+    // Between a successful start() and stop()
+    virtual bool isStarted() const = 0;
+
+    virtual int32_t getSampleRate() const = 0;
+    virtual int32_t getFramesPerBuffer() const = 0;
+    virtual const char* getName() const = 0;
+};
+
+// Oboe on Android, the null backend elsewhere
+std::unique_ptr<AudioBackend> createDefaultAudioBackend();
+
+#endif // NOISYSYNTH_AUDIOBACKEND_H
@@ -0,0 +1,78 @@
+#ifndef NOISYSYNTH_AUDIORING_H
+#define NOISYSYNTH_AUDIORING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Single-producer / single-consumer ring of audio samples.
+ *
+ * Storage is allocated once in the constructor. read() and write() copy in
+ * at most two spans and never block, so both sides are safe on real-time
+ * threads.
+ */
+class AudioRing {
+public:
+    explicit AudioRing(size_t capacity) {
+        // Round up to a power of two so wrapping is a mask
+        capacity_ = 1;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        buffer_.assign(capacity_, 0.0f);
+    }
+
+    AudioRing(const AudioRing&) = delete;
+    AudioRing& operator=(const AudioRing&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    size_t availableToRead() const {
+        return writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_relaxed);
+    }
+
+    size_t availableToWrite() const {
+        return capacity_ - (writeIndex_.load(std::memory_order_relaxed)
+                            - readIndex_.load(std::memory_order_acquire));
+    }
+
+    // Producer side. Returns the number of samples written.
+    size_t write(const float* samples, size_t count) {
+        size_t writeIndex = writeIndex_.load(std::memory_order_relaxed);
+        count = std::min(count, availableToWrite());
+        size_t start = writeIndex & (capacity_ - 1);
+        size_t first = std::min(count, capacity_ - start);
+        std::copy_n(samples, first, buffer_.data() + start);
+        std::copy_n(samples + first, count - first, buffer_.data());
+        writeIndex_.store(writeIndex + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Returns the number of samples read.
+    size_t read(float* samples, size_t count) {
+        size_t readIndex = readIndex_.load(std::memory_order_relaxed);
+        count = std::min(count, availableToRead());
+        size_t start = readIndex & (capacity_ - 1);
+        size_t first = std::min(count, capacity_ - start);
+        std::copy_n(buffer_.data() + start, first, samples);
+        std::copy_n(buffer_.data(), count - first, samples + first);
+        readIndex_.store(readIndex + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: drop everything written so far
+    void discard() {
+        readIndex_.store(writeIndex_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    std::vector<float> buffer_;
+    size_t capacity_ = 0;
+    alignas(64) std::atomic<size_t> writeIndex_{0};
+    alignas(64) std::atomic<size_t> readIndex_{0};
+};
+
+#endif // NOISYSYNTH_AUDIORING_H
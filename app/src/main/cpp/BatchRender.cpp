@@ -0,0 +1,151 @@
+#include "BatchRender.h"
+#include "SynthEngine.h"
+#include "WavWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr int32_t kBatchBlockFrames = 512;
+
+/**
+ * Job indices of one worker. Jobs take milliseconds to seconds each, so a
+ * mutex per deque costs nothing measurable; what matters is that workers
+ * only ever meet when one of them steals.
+ */
+class JobDeque {
+public:
+    void push(size_t job) {
+        std::lock_guard<std::mutex> lock(lock_);
+        jobs_.push_back(job);
+    }
+
+    // Owner side
+    bool popBack(size_t& job) {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (jobs_.empty()) {
+            return false;
+        }
+        job = jobs_.back();
+        jobs_.pop_back();
+        return true;
+    }
+
+    // Thief side
+    bool stealFront(size_t& job) {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (jobs_.empty()) {
+            return false;
+        }
+        job = jobs_.front();
+        jobs_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex lock_;
+    std::deque<size_t> jobs_;
+};
+
+} // namespace
+
+BatchResult renderJob(const BatchJob& job) {
+    BatchResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    SynthEngine engine(false);
+    engine.prepare(static_cast<float>(job.sampleRate), kBatchBlockFrames);
+    engine.setRandomSeed(job.seed);
+    engine.applyParams(job.params.values, kParamCount);
+    if (!engine.loadMidiFile(job.midiPath.c_str())) {
+        return result;
+    }
+    engine.startMidiPlayback(false);
+
+    WavWriter writer;
+    if (!writer.open(job.outputPath.c_str(), job.sampleRate, 1)) {
+        return result;
+    }
+
+    const bool untilEnd = job.seconds <= 0.0;
+    const uint64_t maxFrames = untilEnd ? std::numeric_limits<uint64_t>::max()
+                                        : static_cast<uint64_t>(job.seconds * job.sampleRate);
+    uint64_t tailFrames = static_cast<uint64_t>(std::max(0.0, job.tailSeconds) * job.sampleRate);
+    std::vector<float> block(kBatchBlockFrames);
+    bool ok = true;
+    while (result.frames < maxFrames) {
+        int32_t frames = static_cast<int32_t>(std::min<uint64_t>(kBatchBlockFrames, maxFrames - result.frames));
+        // Playback starts with the first block, so only look after it
+        if (untilEnd && result.frames > 0 && !engine.isMidiPlaying()) {
+            if (tailFrames == 0) {
+                break;
+            }
+            frames = static_cast<int32_t>(std::min<uint64_t>(frames, tailFrames));
+            tailFrames -= frames;
+        }
+        engine.render(block.data(), frames);
+        if (!writer.write(block.data(), frames)) {
+            ok = false;
+            break;
+        }
+        result.frames += frames;
+    }
+
+    result.ok = writer.close() && ok;
+    result.renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::vector<BatchResult> renderBatch(const std::vector<BatchJob>& jobs, int threadCount,
+                                     const std::function<void(size_t, const BatchResult&)>& onDone) {
+    std::vector<BatchResult> results(jobs.size());
+    if (jobs.empty()) {
+        return results;
+    }
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    threadCount = static_cast<int>(std::min<size_t>(threadCount, jobs.size()));
+
+    std::unique_ptr<JobDeque[]> deques(new JobDeque[threadCount]);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        deques[i % threadCount].push(i);
+    }
+
+    // Nothing is queued after the start, so a worker that finds every deque
+    // empty is done
+    auto worker = [&](int self) {
+        size_t job;
+        while (true) {
+            bool found = deques[self].popBack(job);
+            for (int offset = 1; !found && offset < threadCount; ++offset) {
+                found = deques[(self + offset) % threadCount].stealFront(job);
+            }
+            if (!found) {
+                return;
+            }
+            BatchResult result = renderJob(jobs[job]);
+            result.worker = self;
+            results[job] = result;
+            if (onDone) {
+                onDone(job, result);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return results;
+}
@@ -0,0 +1,45 @@
+#ifndef NOISYSYNTH_BATCHRENDER_H
+#define NOISYSYNTH_BATCHRENDER_H
+
+#include "SynthParams.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * One offline render: a patch playing a MIDI file into a float WAV file
+ */
+struct BatchJob {
+    std::string midiPath;
+    std::string outputPath;
+    SynthParams params;
+    int32_t sampleRate = 48000;
+    double seconds = 0.0;       // 0 = until the file ends, then tailSeconds more
+    double tailSeconds = 2.0;   // releases and effect tails
+    uint32_t seed = 1;          // SynthEngine::setRandomSeed
+};
+
+struct BatchResult {
+    bool ok = false;
+    uint64_t frames = 0;
+    double renderSeconds = 0.0; // wall time of the job
+    int worker = -1;
+};
+
+// Renders one job on the calling thread with its own engine
+BatchResult renderJob(const BatchJob& job);
+
+/**
+ * Renders jobs on threadCount threads (0 = one per core), one engine per
+ * job. Jobs are dealt round robin into per-worker deques. A worker takes
+ * from the back of its own deque and, when that runs dry, steals from the
+ * front of the others, so uneven job lengths balance out without every
+ * worker contending on one shared queue. Results are in job order; onDone
+ * is called on the worker threads as jobs finish.
+ */
+std::vector<BatchResult> renderBatch(const std::vector<BatchJob>& jobs, int threadCount,
+                                     const std::function<void(size_t, const BatchResult&)>& onDone = nullptr);
+
+#endif // NOISYSYNTH_BATCHRENDER_H
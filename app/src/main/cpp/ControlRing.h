@@ -0,0 +1,160 @@
+#ifndef NOISYSYNTH_CONTROLRING_H
+#define NOISYSYNTH_CONTROLRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/**
+ * Control event written by the UI and applied on the audio thread
+ */
+enum class ControlEventType : int32_t {
+    None = 0,
+    Parameter = 1,   // id = ParamId, value = new value
+    NoteOn = 2,      // id = MIDI note, value = velocity 0..1 (0 = full)
+    NoteOff = 3,     // id = MIDI note
+    PitchBend = 4,   // value = -1..1
+    NoteExpression = 5, // id = MIDI note, arg = NoteExpression lane, value
+    PartNoteOn = 6,     // id = MIDI note, arg = part, value = velocity 0..1 (0 = full)
+    PartNoteOff = 7,    // id = MIDI note, arg = part
+    PartParameter = 8,  // id = ParamId, arg = part, value = new value
+    PartEnabled = 9,    // arg = part, value = 1 on / 0 off
+    PartKeyRange = 10,  // arg = part, id = low note, value = high note
+    PartMidiChannel = 11, // arg = part, id = MIDI channel 0-15, -1 = all
+    PartLevel = 12,     // arg = part, value = level 0..2
+    PartSend = 13       // arg = part, id = PartSend, value = send level 0..1
+};
+
+struct ControlEvent {
+    int32_t type;
+    int32_t id;
+    float value;
+    int32_t arg;
+};
+static_assert(sizeof(ControlEvent) == 16, "ControlEvent layout is shared with Kotlin");
+
+/*
+ * Shared ring layout (native byte order), mirrored in SynthEngine.kt:
+ *
+ *   offset   0  uint32 writeIndex   (producer, published by commit)
+ *   offset  64  uint32 readIndex    (consumer, audio thread)
+ *   offset 128  uint32 capacity     (events, power of two)
+ *   offset 192  ControlEvent events[capacity]
+ *
+ * Indices increase monotonically and wrap at 2^32; slot = index & (capacity - 1).
+ */
+struct ControlRingHeader {
+    alignas(64) std::atomic<uint32_t> writeIndex;
+    alignas(64) std::atomic<uint32_t> readIndex;
+    alignas(64) uint32_t capacity;
+};
+constexpr size_t kControlRingHeaderBytes = 192;
+static_assert(sizeof(ControlRingHeader) == kControlRingHeaderBytes, "ControlRingHeader layout changed");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "ControlRing needs lock-free 32-bit atomics");
+
+/**
+ * Single-producer / single-consumer event ring living in one flat block of
+ * memory, so it can be handed to Kotlin as a direct ByteBuffer.
+ *
+ * The producer writes events into free slots with plain stores and then makes
+ * them visible with a single publish(). The consumer drains everything that
+ * has been published. No locks, no allocation after construction.
+ */
+class ControlRing {
+public:
+    explicit ControlRing(uint32_t capacity) {
+        // Round up to a power of two so wrapping is a mask
+        capacity_ = 1;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        byteSize_ = kControlRingHeaderBytes + capacity_ * sizeof(ControlEvent);
+        // posix_memalign rather than aligned_alloc: the latter needs API 28
+        void* memory = nullptr;
+        if (posix_memalign(&memory, 64, byteSize_) != 0) {
+            std::abort();
+        }
+        memory_ = static_cast<uint8_t*>(memory);
+        std::memset(memory_, 0, byteSize_);
+
+        header_ = new (memory_) ControlRingHeader();
+        header_->writeIndex.store(0, std::memory_order_relaxed);
+        header_->readIndex.store(0, std::memory_order_relaxed);
+        header_->capacity = capacity_;
+        events_ = reinterpret_cast<ControlEvent*>(memory_ + kControlRingHeaderBytes);
+    }
+
+    ~ControlRing() {
+        header_->~ControlRingHeader();
+        std::free(memory_);
+    }
+
+    ControlRing(const ControlRing&) = delete;
+    ControlRing& operator=(const ControlRing&) = delete;
+
+    void* data() { return memory_; }
+    size_t byteSize() const { return byteSize_; }
+    uint32_t capacity() const { return capacity_; }
+
+    /**
+     * Producer side: make every event up to (not including) writeIndex visible.
+     * Rejects indices that would overrun the consumer.
+     */
+    bool publish(uint32_t writeIndex) {
+        uint32_t readIndex = header_->readIndex.load(std::memory_order_acquire);
+        if (writeIndex - readIndex > capacity_) {
+            return false;
+        }
+        header_->writeIndex.store(writeIndex, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: index up to which events have been published
+    uint32_t publishedIndex() const { return header_->writeIndex.load(std::memory_order_relaxed); }
+
+    // Producer side: an event written at index, published or not yet
+    const ControlEvent& eventAt(uint32_t index) const { return events_[index & (capacity_ - 1)]; }
+
+    // Producer side for native callers: write one event and publish it
+    bool push(const ControlEvent& event) {
+        uint32_t writeIndex = header_->writeIndex.load(std::memory_order_relaxed);
+        uint32_t readIndex = header_->readIndex.load(std::memory_order_acquire);
+        if (writeIndex - readIndex >= capacity_) {
+            return false;
+        }
+        events_[writeIndex & (capacity_ - 1)] = event;
+        header_->writeIndex.store(writeIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side (audio thread): hand every published event to handler.
+     * Returns the number of events applied.
+     */
+    template <typename Handler>
+    uint32_t drain(Handler&& handler) {
+        uint32_t readIndex = header_->readIndex.load(std::memory_order_relaxed);
+        uint32_t writeIndex = header_->writeIndex.load(std::memory_order_acquire);
+        uint32_t count = writeIndex - readIndex;
+        if (count == 0 || count > capacity_) {
+            return 0;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            handler(events_[(readIndex + i) & (capacity_ - 1)]);
+        }
+        header_->readIndex.store(writeIndex, std::memory_order_release);
+        return count;
+    }
+
+private:
+    uint8_t* memory_ = nullptr;
+    size_t byteSize_ = 0;
+    uint32_t capacity_ = 0;
+    ControlRingHeader* header_ = nullptr;
+    ControlEvent* events_ = nullptr;
+};
+
+#endif // NOISYSYNTH_CONTROLRING_H
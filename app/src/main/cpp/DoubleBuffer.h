@@ -0,0 +1,58 @@
+#ifndef NOISYSYNTH_DOUBLEBUFFER_H
+#define NOISYSYNTH_DOUBLEBUFFER_H
+
+#include <atomic>
+#include <memory>
+
+/**
+ * Two copies of a large value: the reader (audio thread) uses one while
+ * the writer (one control thread at a time) fills the other, and a single
+ * atomic hands the newer copy over.
+ *
+ * pending_ holds the index of a published copy the reader has not taken
+ * yet, or -1. Both sides take it with exchange(), so exactly one of them
+ * gets it: the reader switches to it at the start of its next block, or
+ * the writer takes it back and overwrites it in place. Either way the
+ * writer never touches the copy the reader is on, and publish() never
+ * waits, even when the reader is not running. The reader never allocates
+ * or locks.
+ */
+template <typename T>
+class DoubleBuffer {
+public:
+    // On the heap: T is meant to be big
+    DoubleBuffer() : buffers_(new T[2]()) {}
+
+    DoubleBuffer(const DoubleBuffer&) = delete;
+    DoubleBuffer& operator=(const DoubleBuffer&) = delete;
+
+    // Writer side: copy value in and make it the reader's next copy
+    void publish(const T& value) {
+        int reclaimed = pending_.exchange(-1, std::memory_order_acq_rel);
+        int target = (reclaimed >= 0) ? reclaimed : 1 - published_;
+        buffers_[target] = value;
+        published_ = target;
+        pending_.store(target, std::memory_order_release);
+    }
+
+    // Reader side: switch to the latest publish, if any. Returns true if it did.
+    bool acquire() {
+        int pending = pending_.exchange(-1, std::memory_order_acq_rel);
+        if (pending < 0) {
+            return false;
+        }
+        active_ = pending;
+        return true;
+    }
+
+    // Reader side: the copy in use since the last acquire()
+    const T& current() const { return buffers_[active_]; }
+
+private:
+    std::unique_ptr<T[]> buffers_;
+    std::atomic<int> pending_{-1};
+    int published_ = 0;   // writer: last copy handed over
+    int active_ = 0;      // reader
+};
+
+#endif // NOISYSYNTH_DOUBLEBUFFER_H
@@ -0,0 +1,72 @@
+#ifndef NOISYSYNTH_LOG_H
+#define NOISYSYNTH_LOG_H
+
+/*
+ * LOGD / LOGI / LOGE for engine code. Define LOG_TAG before including.
+ * Android goes to logcat; host builds print to stderr.
+ *
+ * These write synchronously, so they are for control threads only. On the
+ * audio thread use RTLOGD / RTLOGI / RTLOGE with an RtLogEvent (RtLog.h); they queue
+ * a binary record that a background thread formats and writes.
+ *
+ * NOISYSYNTH_LOG_LEVEL removes calls below it at compile time. It defaults
+ * to errors only on hosts without NOISYSYNTH_HOST_DEBUG_LOG, to info (rare
+ * state changes worth seeing in the field) in release (NDEBUG) builds, and
+ * to debug otherwise.
+ */
+#define NOISYSYNTH_LOG_LEVEL_DEBUG 0
+#define NOISYSYNTH_LOG_LEVEL_INFO 1
+#define NOISYSYNTH_LOG_LEVEL_ERROR 2
+#define NOISYSYNTH_LOG_LEVEL_NONE 3
+
+#ifndef NOISYSYNTH_LOG_LEVEL
+#if !defined(__ANDROID__) && !defined(NOISYSYNTH_HOST_DEBUG_LOG)
+#define NOISYSYNTH_LOG_LEVEL NOISYSYNTH_LOG_LEVEL_ERROR
+#elif defined(NDEBUG)
+#define NOISYSYNTH_LOG_LEVEL NOISYSYNTH_LOG_LEVEL_INFO
+#else
+#define NOISYSYNTH_LOG_LEVEL NOISYSYNTH_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+#include "RtLog.h"
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#define NOISYSYNTH_LOG_DEBUG(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define NOISYSYNTH_LOG_INFO(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define NOISYSYNTH_LOG_ERROR(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#else
+#include <cstdio>
+#define NOISYSYNTH_HOST_LOG(...) \
+    do { std::fprintf(stderr, "%s: ", LOG_TAG); std::fprintf(stderr, __VA_ARGS__); std::fputc('\n', stderr); } while (0)
+#define NOISYSYNTH_LOG_DEBUG(...) NOISYSYNTH_HOST_LOG(__VA_ARGS__)
+#define NOISYSYNTH_LOG_INFO(...) NOISYSYNTH_HOST_LOG(__VA_ARGS__)
+#define NOISYSYNTH_LOG_ERROR(...) NOISYSYNTH_HOST_LOG(__VA_ARGS__)
+#endif
+
+#if NOISYSYNTH_LOG_LEVEL <= NOISYSYNTH_LOG_LEVEL_DEBUG
+#define LOGD(...) NOISYSYNTH_LOG_DEBUG(__VA_ARGS__)
+#define RTLOGD(event, ...) rtLog(RtLogLevel::Debug, RtLogEvent::event, ##__VA_ARGS__)
+#else
+#define LOGD(...) do { } while (0)
+#define RTLOGD(event, ...) do { } while (0)
+#endif
+
+#if NOISYSYNTH_LOG_LEVEL <= NOISYSYNTH_LOG_LEVEL_INFO
+#define LOGI(...) NOISYSYNTH_LOG_INFO(__VA_ARGS__)
+#define RTLOGI(event, ...) rtLog(RtLogLevel::Info, RtLogEvent::event, ##__VA_ARGS__)
+#else
+#define LOGI(...) do { } while (0)
+#define RTLOGI(event, ...) do { } while (0)
+#endif
+
+#if NOISYSYNTH_LOG_LEVEL <= NOISYSYNTH_LOG_LEVEL_ERROR
+#define LOGE(...) NOISYSYNTH_LOG_ERROR(__VA_ARGS__)
+#define RTLOGE(event, ...) rtLog(RtLogLevel::Error, RtLogEvent::event, ##__VA_ARGS__)
+#else
+#define LOGE(...) do { } while (0)
+#define RTLOGE(event, ...) do { } while (0)
+#endif
+
+#endif // NOISYSYNTH_LOG_H
@@ -0,0 +1,167 @@
+#ifndef NOISYSYNTH_LOOPFREEZE_H
+#define NOISYSYNTH_LOOPFREEZE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class LoopFreezeState : int32_t {
+    Off = 0,
+    Waiting = 1,     // for one whole sequencer loop with nothing changing
+    Capturing = 2,   // recording the dry mix of this loop
+    Playing = 3      // replaying it; the sequencer starts no voices
+};
+
+/**
+ * Dry voice mix of one sequencer loop, captured once and replayed for as
+ * long as nothing that shapes it changes. It holds one value per frame per
+ * channel: the single dry bus, or each part's dry signal when parts are
+ * mixed separately. Part levels, sends and the effects after them
+ * therefore stay live.
+ *
+ * Capture starts at a loop start after one whole loop went by unchanged,
+ * so the tails carried over from the previous loop are in the cache and
+ * it repeats seamlessly. A change while playing takes effect at the next
+ * step start: the voices take over there, and the cache fades out over
+ * kFadeFrames.
+ *
+ * allocate() is for the control thread. Everything else is for the audio
+ * thread, and none of it allocates or locks.
+ */
+class LoopFreeze {
+public:
+    static constexpr size_t kCapacity = size_t(1) << 21;   // 8 MB: about 43 s of one channel at 48 kHz
+    static constexpr int kFadeFrames = 1024;
+
+    // Once, before the audio thread first sees freezing enabled
+    void allocate() {
+        if (buffer_.empty()) {
+            buffer_.assign(kCapacity, 0.0f);
+        }
+    }
+
+    LoopFreezeState getState() const { return state_; }
+    bool isPlaying() const { return state_ == LoopFreezeState::Playing; }
+    // Whether process() has anything to do this segment
+    bool isProcessing() const {
+        return state_ == LoopFreezeState::Capturing || state_ == LoopFreezeState::Playing || fadeFrames_ > 0;
+    }
+    int32_t getLength() const { return length_; }
+
+    // Go to target (Waiting or Off). While playing, this happens at the next stepStart().
+    void release(LoopFreezeState target) {
+        if (state_ == LoopFreezeState::Playing) {
+            pending_ = target;
+            releasing_ = true;
+        } else {
+            state_ = target;
+            clean_ = false;
+        }
+    }
+
+    // Go to target now, fading out playback; for when no step start follows
+    void cut(LoopFreezeState target) {
+        if (state_ == LoopFreezeState::Playing) {
+            fadeFrames_ = kFadeFrames;
+        }
+        state_ = target;
+        releasing_ = false;
+        clean_ = false;
+    }
+
+    // A note from outside the sequencer would end up in the capture
+    void liveNote() {
+        if (state_ == LoopFreezeState::Waiting || state_ == LoopFreezeState::Capturing) {
+            state_ = LoopFreezeState::Waiting;
+            clean_ = false;
+        }
+    }
+
+    /**
+     * At the first sample of every sequencer step. Returns true when
+     * playback takes over from the voices: whatever they are playing is in
+     * the cache from here on.
+     */
+    bool stepStart(bool loopStart, int channels) {
+        if (releasing_) {
+            releasing_ = false;
+            fadeFrames_ = kFadeFrames;
+            state_ = pending_;
+            clean_ = false;
+            return false;
+        }
+        if (!loopStart) {
+            return false;
+        }
+        switch (state_) {
+            case LoopFreezeState::Waiting:
+                if (clean_) {
+                    state_ = LoopFreezeState::Capturing;
+                    channels_ = channels;
+                    frames_ = 0;
+                } else {
+                    clean_ = true;
+                }
+                return false;
+            case LoopFreezeState::Capturing:
+                state_ = LoopFreezeState::Playing;
+                length_ = frames_;
+                readFrame_ = 0;
+                fadeFrames_ = 0;
+                return true;
+            case LoopFreezeState::Playing:
+                readFrame_ = 0;
+                return false;
+            case LoopFreezeState::Off:
+            default:
+                return false;
+        }
+    }
+
+    // One frame of the dry mix: recorded while capturing, and the cached frame added while playing
+    void process(float* dry, int channels) {
+        if (state_ == LoopFreezeState::Capturing) {
+            size_t offset = static_cast<size_t>(frames_) * channels_;
+            if (channels != channels_ || offset + channels_ > buffer_.size()) {
+                // Too long to cache, or the parts changed under us
+                state_ = LoopFreezeState::Waiting;
+                clean_ = false;
+            } else {
+                std::copy_n(dry, channels_, buffer_.data() + offset);
+                frames_++;
+            }
+        }
+
+        float gain;
+        if (state_ == LoopFreezeState::Playing) {
+            gain = 1.0f;
+        } else if (fadeFrames_ > 0) {
+            gain = static_cast<float>(fadeFrames_--) / kFadeFrames;
+        } else {
+            return;
+        }
+        const float* frame = buffer_.data() + static_cast<size_t>(readFrame_) * channels_;
+        for (int c = 0; c < std::min(channels, channels_); ++c) {
+            dry[c] += frame[c] * gain;
+        }
+        // A loop is a fraction of a frame longer some times round: hold the last frame
+        if (readFrame_ + 1 < length_) {
+            readFrame_++;
+        }
+    }
+
+private:
+    std::vector<float> buffer_;
+    LoopFreezeState state_ = LoopFreezeState::Off;
+    LoopFreezeState pending_ = LoopFreezeState::Off;
+    bool releasing_ = false;
+    bool clean_ = false;          // a whole loop has gone by unchanged
+    int channels_ = 1;
+    int32_t frames_ = 0;          // captured so far
+    int32_t length_ = 0;          // frames of the captured loop
+    int32_t readFrame_ = 0;
+    int fadeFrames_ = 0;
+};
+
+#endif // NOISYSYNTH_LOOPFREEZE_H
@@ -0,0 +1,231 @@
+#include "MidiFile.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+uint32_t readBE32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+uint16_t readBE16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// Variable-length quantity, at most 4 bytes
+bool readVarLen(const uint8_t* data, size_t size, size_t& pos, uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (pos >= size) {
+            return false;
+        }
+        uint8_t byte = data[pos++];
+        value = (value << 7) | (byte & 0x7F);
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr uint32_t kDefaultTempo = 500000; // 120 BPM
+
+} // namespace
+
+MidiSequence::MidiSequence(size_t capacity)
+    : capacity_(capacity) {
+    events_.reserve(capacity_);
+}
+
+void MidiSequence::clear() {
+    events_.clear();
+    lastTick_ = 0;
+    lengthSeconds_ = 0.0;
+    truncated_ = false;
+}
+
+bool MidiSequence::loadFile(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    return loadFromMemory(data.data(), data.size());
+}
+
+bool MidiSequence::loadFromMemory(const uint8_t* data, size_t size) {
+    clear();
+
+    if (size < 14 || readBE32(data) != 0x4D546864 /* MThd */) {
+        return false;
+    }
+    uint32_t headerLength = readBE32(data + 4);
+    if (headerLength < 6 || 8 + size_t(headerLength) > size) {
+        return false;
+    }
+    uint16_t format = readBE16(data + 8);
+    uint16_t trackCount = readBE16(data + 10);
+    int division = static_cast<int16_t>(readBE16(data + 12));
+    if (format > 1 || division == 0) {
+        return false;
+    }
+
+    size_t pos = 8 + headerLength;
+    for (uint16_t track = 0; track < trackCount && pos + 8 <= size; ++track) {
+        uint32_t chunkLength = readBE32(data + pos + 4);
+        bool isTrack = readBE32(data + pos) == 0x4D54726B; // MTrk
+        pos += 8;
+        if (chunkLength > size - pos) {
+            return false;
+        }
+        if (isTrack && !parseTrack(data + pos, chunkLength)) {
+            return false;
+        }
+        pos += chunkLength;
+    }
+
+    applyTempoMap(division);
+    return true;
+}
+
+bool MidiSequence::append(const MidiEvent& event) {
+    if (events_.size() >= capacity_) {
+        truncated_ = true;
+        return false;
+    }
+    events_.push_back(event);
+    return true;
+}
+
+bool MidiSequence::parseTrack(const uint8_t* data, size_t size) {
+    size_t pos = 0;
+    uint32_t tick = 0;
+    uint8_t runningStatus = 0;
+
+    while (pos < size) {
+        uint32_t delta;
+        if (!readVarLen(data, size, pos, delta) || pos >= size) {
+            return false;
+        }
+        tick += delta;
+
+        uint8_t status = data[pos];
+        if (status & 0x80) {
+            pos++;
+        } else if (runningStatus != 0) {
+            status = runningStatus;
+        } else {
+            return false;
+        }
+
+        if (status == 0xFF) {
+            // Meta event
+            if (pos >= size) {
+                return false;
+            }
+            uint8_t metaType = data[pos++];
+            uint32_t length;
+            if (!readVarLen(data, size, pos, length) || length > size - pos) {
+                return false;
+            }
+            if (metaType == 0x51 && length == 3) {
+                MidiEvent event {};
+                event.tick = tick;
+                event.type = MidiEventType::Tempo;
+                event.tempo = (uint32_t(data[pos]) << 16) | (uint32_t(data[pos + 1]) << 8) | data[pos + 2];
+                append(event);
+            }
+            pos += length;
+            if (metaType == 0x2F) {
+                break; // End of track
+            }
+            continue;
+        }
+
+        if (status == 0xF0 || status == 0xF7) {
+            // SysEx, skipped
+            uint32_t length;
+            if (!readVarLen(data, size, pos, length) || length > size - pos) {
+                return false;
+            }
+            pos += length;
+            continue;
+        }
+
+        runningStatus = status;
+        uint8_t kind = status & 0xF0;
+        int dataBytes = (kind == 0xC0 || kind == 0xD0) ? 1 : 2;
+        if (pos + dataBytes > size) {
+            return false;
+        }
+        uint8_t data1 = data[pos];
+        uint8_t data2 = (dataBytes == 2) ? data[pos + 1] : 0;
+        pos += dataBytes;
+
+        if (kind == 0x90 || kind == 0x80) {
+            MidiEvent event {};
+            event.tick = tick;
+            event.channel = status & 0x0F;
+            event.note = data1 & 0x7F;
+            event.velocity = data2 & 0x7F;
+            // Note on with velocity 0 is a note off
+            event.type = (kind == 0x90 && event.velocity > 0) ? MidiEventType::NoteOn : MidiEventType::NoteOff;
+            append(event);
+        }
+    }
+
+    lastTick_ = std::max(lastTick_, tick);
+    return true;
+}
+
+void MidiSequence::applyTempoMap(int division) {
+    // Order: tick, then tempo changes, then note offs before note ons so a
+    // repeated note at the same tick retriggers instead of being cut off
+    auto rank = [](MidiEventType type) {
+        switch (type) {
+            case MidiEventType::Tempo:   return 0;
+            case MidiEventType::NoteOff: return 1;
+            case MidiEventType::NoteOn:  return 2;
+        }
+        return 3;
+    };
+    std::stable_sort(events_.begin(), events_.end(), [&](const MidiEvent& a, const MidiEvent& b) {
+        if (a.tick != b.tick) {
+            return a.tick < b.tick;
+        }
+        return rank(a.type) < rank(b.type);
+    });
+
+    double secondsPerTick;
+    bool smpte = division < 0;
+    if (smpte) {
+        // Negative division: -frames per second in the high byte, ticks per frame in the low byte
+        int framesPerSecond = -(division >> 8);
+        int ticksPerFrame = division & 0xFF;
+        secondsPerTick = 1.0 / (std::max(1, framesPerSecond) * std::max(1, ticksPerFrame));
+    } else {
+        secondsPerTick = kDefaultTempo * 1.0e-6 / division;
+    }
+
+    uint32_t segmentTick = 0;
+    double segmentTime = 0.0;
+    for (auto& event : events_) {
+        event.time = segmentTime + (event.tick - segmentTick) * secondsPerTick;
+        if (event.type == MidiEventType::Tempo && !smpte) {
+            segmentTick = event.tick;
+            segmentTime = event.time;
+            secondsPerTick = event.tempo * 1.0e-6 / division;
+        }
+    }
+    lengthSeconds_ = segmentTime + (lastTick_ - segmentTick) * secondsPerTick;
+
+    events_.erase(std::remove_if(events_.begin(), events_.end(), [](const MidiEvent& event) {
+        return event.type == MidiEventType::Tempo;
+    }), events_.end());
+}
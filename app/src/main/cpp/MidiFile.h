@@ -0,0 +1,59 @@
+#ifndef NOISYSYNTH_MIDIFILE_H
+#define NOISYSYNTH_MIDIFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr size_t kMaxMidiEvents = 65536;
+
+enum class MidiEventType : uint8_t {
+    NoteOff = 0,
+    NoteOn = 1,
+    Tempo = 2   // only used while loading
+};
+
+struct MidiEvent {
+    double time;        // seconds from the start, tempo map already applied
+    uint32_t tick;
+    uint32_t tempo;     // microseconds per quarter note (Tempo events)
+    MidiEventType type;
+    uint8_t channel;
+    uint8_t note;
+    uint8_t velocity;
+};
+
+/**
+ * Note events of a Standard MIDI File (format 0 or 1), merged across tracks
+ * and sorted by time.
+ *
+ * Event storage is reserved once in the constructor; loading reuses it and
+ * drops events beyond the capacity instead of growing. Loading is meant for a
+ * non-audio thread, reading events is safe anywhere.
+ */
+class MidiSequence {
+public:
+    explicit MidiSequence(size_t capacity = kMaxMidiEvents);
+
+    bool loadFile(const char* path);
+    bool loadFromMemory(const uint8_t* data, size_t size);
+    void clear();
+
+    size_t size() const { return events_.size(); }
+    const MidiEvent& operator[](size_t index) const { return events_[index]; }
+    double getLengthSeconds() const { return lengthSeconds_; }
+    bool wasTruncated() const { return truncated_; }
+
+private:
+    bool parseTrack(const uint8_t* data, size_t size);
+    bool append(const MidiEvent& event);
+    void applyTempoMap(int division);
+
+    std::vector<MidiEvent> events_;
+    size_t capacity_;
+    uint32_t lastTick_ = 0;
+    double lengthSeconds_ = 0.0;
+    bool truncated_ = false;
+};
+
+#endif // NOISYSYNTH_MIDIFILE_H
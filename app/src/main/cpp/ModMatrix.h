@@ -0,0 +1,172 @@
+#ifndef NOISYSYNTH_MODMATRIX_H
+#define NOISYSYNTH_MODMATRIX_H
+
+#include <algorithm>
+#include <cstdint>
+
+constexpr int kMaxModRoutes = 8;
+
+enum class ModSource : int32_t {
+    None = 0,
+    Lfo,             // LFO 1, bipolar -1..1 (raw shape, independent of LFO amount)
+    AmpEnvelope,     // 0..1
+    FilterEnvelope,  // 0..1
+    Velocity,        // 0..1
+    KeyTrack,        // -1..1 around middle C
+    Lfo2,            // LFOs 2-4, bipolar -1..1
+    Lfo3,
+    Lfo4,
+    Pressure,        // per-note expression, 0..1
+    Timbre,          // per-note expression, 0..1
+    Count
+};
+
+enum class ModDestination : int32_t {
+    None = 0,
+    // Per-voice destinations
+    Pitch,           // 1.0 = +1 octave
+    Cutoff,          // added to normalized cutoff
+    Resonance,       // added to normalized resonance
+    Amplitude,       // gain = 1 + mod, never below 0
+    // Global destinations, driven by global sources (LFOs) only
+    DelayMix,
+    ChorusDepth,
+    ReverbMix,
+    Count
+};
+
+constexpr int kModSourceCount = static_cast<int>(ModSource::Count);
+constexpr int kModDestinationCount = static_cast<int>(ModDestination::Count);
+
+// Bit layout of the compiled voice mask, one bit per per-voice destination
+constexpr uint32_t kModPitchBit = 1u << 0;
+constexpr uint32_t kModCutoffBit = 1u << 1;
+constexpr uint32_t kModResonanceBit = 1u << 2;
+constexpr uint32_t kModAmplitudeBit = 1u << 3;
+constexpr uint32_t kVoiceModKernelCount = 16;
+
+// Bit layout of the compiled global mask
+constexpr uint32_t kModDelayMixBit = 1u << 0;
+constexpr uint32_t kModChorusDepthBit = 1u << 1;
+constexpr uint32_t kModReverbMixBit = 1u << 2;
+
+struct ModRoute {
+    ModSource source = ModSource::None;
+    ModDestination destination = ModDestination::None;
+    float amount = 0.0f;
+};
+
+/**
+ * Compiled routing: for each destination, the flat list of sources feeding
+ * it. The voice mask selects which specialized render kernel runs, so a
+ * destination with no routes is never evaluated at all.
+ */
+struct ModRouting {
+    struct Slot {
+        int count = 0;
+        ModSource sources[kMaxModRoutes];
+        float amounts[kMaxModRoutes];
+    };
+
+    uint32_t voiceMask = 0;
+    uint32_t globalMask = 0;
+    Slot slots[kModDestinationCount];
+
+    float evaluate(ModDestination destination, const float* sourceValues) const {
+        const Slot& slot = slots[static_cast<int>(destination)];
+        float sum = 0.0f;
+        for (int i = 0; i < slot.count; ++i) {
+            sum += slot.amounts[i] * sourceValues[static_cast<int>(slot.sources[i])];
+        }
+        return sum;
+    }
+};
+
+/**
+ * Modulation matrix: a fixed set of source -> destination routes.
+ * Every edit recompiles the routing in place (no allocation), so it is safe
+ * to edit from the audio thread when changes arrive through the control ring.
+ */
+class ModMatrix {
+public:
+    ModMatrix() { compile(); }
+
+    void setSource(int route, int source) {
+        if (route < 0 || route >= kMaxModRoutes) return;
+        routes_[route].source = static_cast<ModSource>(std::max(0, std::min(kModSourceCount - 1, source)));
+        compile();
+    }
+
+    void setDestination(int route, int destination) {
+        if (route < 0 || route >= kMaxModRoutes) return;
+        routes_[route].destination = static_cast<ModDestination>(
+            std::max(0, std::min(kModDestinationCount - 1, destination)));
+        compile();
+    }
+
+    void setAmount(int route, float amount) {
+        if (route < 0 || route >= kMaxModRoutes) return;
+        routes_[route].amount = std::max(-1.0f, std::min(1.0f, amount));
+        compile();
+    }
+
+    const ModRoute& getRoute(int route) const { return routes_[route]; }
+    const ModRouting& getRouting() const { return routing_; }
+
+private:
+    static uint32_t voiceBit(ModDestination destination) {
+        switch (destination) {
+            case ModDestination::Pitch:     return kModPitchBit;
+            case ModDestination::Cutoff:    return kModCutoffBit;
+            case ModDestination::Resonance: return kModResonanceBit;
+            case ModDestination::Amplitude: return kModAmplitudeBit;
+            default:                        return 0;
+        }
+    }
+
+    static uint32_t globalBit(ModDestination destination) {
+        switch (destination) {
+            case ModDestination::DelayMix:    return kModDelayMixBit;
+            case ModDestination::ChorusDepth: return kModChorusDepthBit;
+            case ModDestination::ReverbMix:   return kModReverbMixBit;
+            default:                          return 0;
+        }
+    }
+
+    static bool isGlobalSource(ModSource source) {
+        return source == ModSource::Lfo || source == ModSource::Lfo2
+            || source == ModSource::Lfo3 || source == ModSource::Lfo4;
+    }
+
+    void compile() {
+        routing_.voiceMask = 0;
+        routing_.globalMask = 0;
+        for (auto& slot : routing_.slots) {
+            slot.count = 0;
+        }
+
+        for (const auto& route : routes_) {
+            if (route.source == ModSource::None || route.destination == ModDestination::None
+                || route.amount == 0.0f) {
+                continue;
+            }
+            uint32_t global = globalBit(route.destination);
+            if (global != 0 && !isGlobalSource(route.source)) {
+                continue; // per-voice sources cannot drive shared effects
+            }
+
+            auto& slot = routing_.slots[static_cast<int>(route.destination)];
+            slot.sources[slot.count] = route.source;
+            slot.amounts[slot.count] = route.amount;
+            slot.count++;
+
+            routing_.voiceMask |= voiceBit(route.destination);
+            routing_.globalMask |= global;
+        }
+    }
+
+    ModRoute routes_[kMaxModRoutes];
+    ModRouting routing_;
+};
+
+#endif // NOISYSYNTH_MODMATRIX_H
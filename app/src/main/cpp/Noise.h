@@ -0,0 +1,65 @@
+#ifndef NOISYSYNTH_NOISE_H
+#define NOISYSYNTH_NOISE_H
+
+#include "Random.h"
+#include "Simd.h"
+#include <cstdint>
+
+/**
+ * Noise oscillator. White noise comes from four xorshift32 lanes stepped
+ * together (simd::xorshift4), a block of kBlockSize samples at a time;
+ * next() hands the block out one sample per call so the voice loop stays
+ * per-sample. Pink noise runs the block through Paul Kellet's three-pole
+ * approximation of a -3 dB/octave slope.
+ *
+ * Each voice owns one, seeded from the engine seed, so renders repeat.
+ * No allocation or locking; safe on the audio thread.
+ */
+class NoiseSource {
+public:
+    static constexpr int kBlockSize = 16;
+
+    NoiseSource() { seed(1); }
+
+    void seed(uint32_t seed) {
+        Random random(seed);
+        for (auto& lane : lanes_) {
+            lane = random.next();
+        }
+        pink0_ = pink1_ = pink2_ = 0.0f;
+        position_ = kBlockSize;
+    }
+
+    // One sample, -1..1 for white; pink is scaled to about the same RMS
+    float next(bool pink) {
+        if (position_ == kBlockSize) {
+            fill(pink);
+        }
+        return block_[position_++];
+    }
+
+private:
+    void fill(bool pink) {
+        simd::xorshift4(lanes_, block_, kBlockSize);
+        if (pink) {
+            for (float& sample : block_) {
+                pink0_ = 0.99765f * pink0_ + sample * 0.0990460f;
+                pink1_ = 0.96300f * pink1_ + sample * 0.2965164f;
+                pink2_ = 0.57000f * pink2_ + sample * 1.0526913f;
+                sample = (pink0_ + pink1_ + pink2_ + sample * 0.1848f) * kPinkGain;
+            }
+        }
+        position_ = 0;
+    }
+
+    static constexpr float kPinkGain = 0.194f;   // pink RMS ~= white RMS
+
+    uint32_t lanes_[4];
+    float block_[kBlockSize];
+    float pink0_ = 0.0f;
+    float pink1_ = 0.0f;
+    float pink2_ = 0.0f;
+    int position_ = kBlockSize;
+};
+
+#endif // NOISYSYNTH_NOISE_H
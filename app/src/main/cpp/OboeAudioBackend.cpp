@@ -0,0 +1,128 @@
+#include "OboeAudioBackend.h"
+
+#define LOG_TAG "NoisySynth"
+#include "Log.h"
+
+OboeAudioBackend::~OboeAudioBackend() {
+    close();
+}
+
+bool OboeAudioBackend::open(const AudioBackendConfig& config, AudioCallback* callback) {
+    std::lock_guard<std::mutex> guard(lock_);
+    config_ = config;
+    callback_ = callback;
+    return openLocked();
+}
+
+bool OboeAudioBackend::openLocked() {
+    oboe::AudioStreamBuilder builder;
+    builder.setDirection(oboe::Direction::Output);
+    builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+    builder.setSharingMode(oboe::SharingMode::Exclusive);
+    builder.setFormat(oboe::AudioFormat::Float);
+    builder.setChannelCount(config_.channelCount);
+    if (config_.sampleRate > 0) {
+        builder.setSampleRate(config_.sampleRate);
+    }
+    if (config_.framesPerBuffer > 0) {
+        builder.setFramesPerDataCallback(config_.framesPerBuffer);
+    }
+    builder.setDataCallback(this);
+    builder.setErrorCallback(this);
+
+    oboe::Result result = builder.openStream(stream_);
+    if (result != oboe::Result::OK) {
+        LOGE("Failed to create stream. Error: %s", oboe::convertToText(result));
+        stream_.reset();
+        return false;
+    }
+
+    LOGD("Stream created: SR=%d, BufferSize=%d",
+         stream_->getSampleRate(),
+         stream_->getBufferSizeInFrames());
+
+    // Callbacks never ask for more than the buffer holds
+    callback_->onPrepare(static_cast<float>(stream_->getSampleRate()),
+                         stream_->getBufferCapacityInFrames());
+    return true;
+}
+
+bool OboeAudioBackend::start() {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!stream_) {
+        return false;
+    }
+    oboe::Result result = stream_->requestStart();
+    if (result != oboe::Result::OK) {
+        LOGE("Failed to start stream. Error: %s", oboe::convertToText(result));
+        return false;
+    }
+    started_ = true;
+    return true;
+}
+
+void OboeAudioBackend::stop() {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (stream_) {
+        // Blocking: requestStop() returns while a callback may still be
+        // running, and callers re-prepare the engine right after this
+        oboe::Result result = stream_->stop();
+        if (result != oboe::Result::OK) {
+            LOGE("Failed to stop stream. Error: %s", oboe::convertToText(result));
+        }
+    }
+    started_ = false;
+}
+
+bool OboeAudioBackend::isStarted() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return started_;
+}
+
+void OboeAudioBackend::close() {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (stream_) {
+        stream_->close();
+        stream_.reset();
+    }
+    started_ = false;
+    callback_ = nullptr;
+}
+
+int32_t OboeAudioBackend::getSampleRate() const {
+    return stream_ ? stream_->getSampleRate() : 0;
+}
+
+int32_t OboeAudioBackend::getFramesPerBuffer() const {
+    return stream_ ? stream_->getFramesPerBurst() : 0;
+}
+
+oboe::DataCallbackResult OboeAudioBackend::onAudioReady(
+    oboe::AudioStream *audioStream,
+    void *audioData,
+    int32_t numFrames) {
+
+    callback_->onAudioReady(static_cast<float *>(audioData), numFrames);
+    return oboe::DataCallbackResult::Continue;
+}
+
+void OboeAudioBackend::onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) {
+    if (error != oboe::Result::ErrorDisconnected) {
+        LOGE("Stream error: %s", oboe::convertToText(error));
+        return;
+    }
+
+    // The old stream is closed, so no callback can run while the engine
+    // re-prepares for the new device
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!callback_ || stream_.get() != audioStream) {
+        return; // closed on purpose in the meantime
+    }
+    LOGD("Stream disconnected, reopening");
+    stream_.reset();
+    if (openLocked() && started_) {
+        if (stream_->requestStart() != oboe::Result::OK) {
+            LOGE("Failed to restart stream");
+        }
+    }
+}
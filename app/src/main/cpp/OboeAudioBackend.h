@@ -0,0 +1,48 @@
+#ifndef NOISYSYNTH_OBOEAUDIOBACKEND_H
+#define NOISYSYNTH_OBOEAUDIOBACKEND_H
+
+#include "AudioBackend.h"
+#include <oboe/Oboe.h>
+#include <mutex>
+
+/**
+ * Low-latency exclusive Oboe output stream, float samples.
+ *
+ * When the device goes away (headphones unplugged, route change) the stream
+ * is reopened on Oboe's error thread. The new device may run at another rate;
+ * the callback's onPrepare() sees it before the first buffer.
+ */
+class OboeAudioBackend : public AudioBackend,
+                         public oboe::AudioStreamDataCallback,
+                         public oboe::AudioStreamErrorCallback {
+public:
+    ~OboeAudioBackend() override;
+
+    bool open(const AudioBackendConfig& config, AudioCallback* callback) override;
+    bool start() override;
+    void stop() override;
+    void close() override;
+    bool isStarted() const override;
+
+    int32_t getSampleRate() const override;
+    int32_t getFramesPerBuffer() const override;
+    const char* getName() const override { return "oboe"; }
+
+    oboe::DataCallbackResult onAudioReady(
+        oboe::AudioStream *audioStream,
+        void *audioData,
+        int32_t numFrames) override;
+
+    void onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) override;
+
+private:
+    bool openLocked();
+
+    mutable std::mutex lock_;   // open/close vs. reopening on the error thread
+    std::shared_ptr<oboe::AudioStream> stream_;
+    AudioBackendConfig config_;
+    AudioCallback* callback_ = nullptr;
+    bool started_ = false;
+};
+
+#endif // NOISYSYNTH_OBOEAUDIOBACKEND_H
@@ -0,0 +1,307 @@
+#include "PresetBank.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+void copyFixed(char* dest, const char* src, size_t srcLength, size_t length) {
+    std::memset(dest, 0, length);
+    std::memcpy(dest, src, std::min(srcLength, length));
+}
+
+void copyFixed(char* dest, const std::string& src, size_t length) {
+    copyFixed(dest, src.data(), src.size(), length);
+}
+
+bool fitsIn(uint64_t offset, uint64_t bytes, uint64_t total) {
+    return offset <= total && bytes <= total - offset;
+}
+
+} // namespace
+
+int comparePresetNames(const char* a, const char* b, size_t maxLength) {
+    for (size_t i = 0; i < maxLength; ++i) {
+        char ca = lowerAscii(a[i]);
+        char cb = lowerAscii(b[i]);
+        if (ca != cb) {
+            return (static_cast<unsigned char>(ca) < static_cast<unsigned char>(cb)) ? -1 : 1;
+        }
+        if (ca == '\0') {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+PresetBank::~PresetBank() {
+    close();
+}
+
+bool PresetBank::open(const char* path) {
+    close();
+
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PresetBankHeader))) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t length = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    // Validate everything up front so lookups never need bounds checks
+    const auto* header = static_cast<const PresetBankHeader*>(mapping);
+    const uint64_t total = length;
+    const uint64_t count = header->presetCount;
+    const uint64_t expectedRecord = kPresetNameLength + uint64_t(header->paramCount) * sizeof(float);
+    bool valid = header->magic == kPresetBankMagic
+        && header->version == kPresetBankVersion
+        && header->headerSize == sizeof(PresetBankHeader)
+        && header->fileSize == length
+        && header->paramCount > 0
+        && header->recordSize == expectedRecord
+        && header->recordsOffset % 4 == 0
+        && header->nameIndexOffset % 4 == 0
+        && header->tagIndexOffset % 4 == 0
+        && fitsIn(header->recordsOffset, count * header->recordSize, total)
+        && fitsIn(header->nameIndexOffset, count * sizeof(uint32_t), total)
+        && fitsIn(header->tagIndexOffset, uint64_t(header->tagCount) * sizeof(PresetTagEntry), total);
+
+    if (valid) {
+        const auto* names = reinterpret_cast<const uint32_t*>(
+            static_cast<const char*>(mapping) + header->nameIndexOffset);
+        for (uint64_t i = 0; i < count && valid; ++i) {
+            valid = names[i] < count;
+        }
+        const auto* tags = reinterpret_cast<const PresetTagEntry*>(
+            static_cast<const char*>(mapping) + header->tagIndexOffset);
+        for (uint32_t i = 0; i < header->tagCount && valid; ++i) {
+            valid = tags[i].presetIndex < count;
+        }
+    }
+
+    if (!valid) {
+        munmap(mapping, length);
+        return false;
+    }
+
+    // Presets are browsed randomly, not streamed
+    madvise(mapping, length, MADV_RANDOM);
+
+    mapping_ = mapping;
+    mappingSize_ = length;
+    header_ = header;
+    return true;
+}
+
+void PresetBank::close() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    header_ = nullptr;
+}
+
+const char* PresetBank::recordAt(uint32_t index) const {
+    return static_cast<const char*>(mapping_) + header_->recordsOffset
+        + static_cast<size_t>(index) * header_->recordSize;
+}
+
+std::string PresetBank::nameAt(uint32_t index) const {
+    if (!header_ || index >= header_->presetCount) {
+        return std::string();
+    }
+    const char* name = recordAt(index);
+    return std::string(name, strnlen(name, kPresetNameLength));
+}
+
+const float* PresetBank::valuesAt(uint32_t index) const {
+    if (!header_ || index >= header_->presetCount) {
+        return nullptr;
+    }
+    return reinterpret_cast<const float*>(recordAt(index) + kPresetNameLength);
+}
+
+uint32_t PresetBank::sortedIndex(uint32_t position) const {
+    if (!header_ || position >= header_->presetCount) {
+        return 0;
+    }
+    const auto* names = reinterpret_cast<const uint32_t*>(
+        static_cast<const char*>(mapping_) + header_->nameIndexOffset);
+    return names[position];
+}
+
+int PresetBank::find(const char* name) const {
+    if (!header_ || !name) {
+        return -1;
+    }
+
+    // A longer name cannot be stored, so it must not match on its first 32 characters
+    size_t length = strnlen(name, kPresetNameLength + 1);
+    if (length > kPresetNameLength) {
+        return -1;
+    }
+    char key[kPresetNameLength];
+    copyFixed(key, name, length, kPresetNameLength);
+
+    const auto* names = reinterpret_cast<const uint32_t*>(
+        static_cast<const char*>(mapping_) + header_->nameIndexOffset);
+    uint32_t lo = 0;
+    uint32_t hi = header_->presetCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = comparePresetNames(recordAt(names[mid]), key, kPresetNameLength);
+        if (cmp == 0) {
+            return static_cast<int>(names[mid]);
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
+}
+
+uint32_t PresetBank::findByTag(const char* tag, uint32_t* results, uint32_t maxResults) const {
+    if (!header_ || !tag) {
+        return 0;
+    }
+
+    size_t length = strnlen(tag, kPresetTagLength + 1);
+    if (length > kPresetTagLength) {
+        return 0;
+    }
+    char key[kPresetTagLength];
+    copyFixed(key, tag, length, kPresetTagLength);
+
+    const auto* tags = reinterpret_cast<const PresetTagEntry*>(
+        static_cast<const char*>(mapping_) + header_->tagIndexOffset);
+
+    // Lower bound of the tag's run
+    uint32_t lo = 0;
+    uint32_t hi = header_->tagCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (comparePresetNames(tags[mid].tag, key, kPresetTagLength) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    uint32_t found = 0;
+    for (uint32_t i = lo; i < header_->tagCount; ++i) {
+        if (comparePresetNames(tags[i].tag, key, kPresetTagLength) != 0) {
+            break;
+        }
+        if (results && found < maxResults) {
+            results[found] = tags[i].presetIndex;
+        }
+        found++;
+    }
+    return found;
+}
+
+bool PresetBankWriter::addPreset(const std::string& name,
+                                 const std::vector<std::string>& tags,
+                                 const SynthParams& params) {
+    if (name.empty()) {
+        return false;
+    }
+
+    char key[kPresetNameLength];
+    copyFixed(key, name, kPresetNameLength);
+    for (const auto& existing : presets_) {
+        char other[kPresetNameLength];
+        copyFixed(other, existing.name, kPresetNameLength);
+        if (comparePresetNames(key, other, kPresetNameLength) == 0) {
+            return false;
+        }
+    }
+
+    presets_.push_back({name, tags, params});
+    return true;
+}
+
+bool PresetBankWriter::write(const char* path) const {
+    const uint32_t count = static_cast<uint32_t>(presets_.size());
+    const uint32_t recordSize = kPresetNameLength + kParamCount * sizeof(float);
+
+    std::vector<char> records(static_cast<size_t>(count) * recordSize, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        char* record = records.data() + static_cast<size_t>(i) * recordSize;
+        copyFixed(record, presets_[i].name, kPresetNameLength);
+        std::memcpy(record + kPresetNameLength, presets_[i].params.values, kParamCount * sizeof(float));
+    }
+
+    std::vector<uint32_t> nameIndex(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        nameIndex[i] = i;
+    }
+    std::sort(nameIndex.begin(), nameIndex.end(), [&](uint32_t a, uint32_t b) {
+        return comparePresetNames(records.data() + static_cast<size_t>(a) * recordSize,
+                                  records.data() + static_cast<size_t>(b) * recordSize,
+                                  kPresetNameLength) < 0;
+    });
+
+    std::vector<PresetTagEntry> tagIndex;
+    for (uint32_t i = 0; i < count; ++i) {
+        for (const auto& tag : presets_[i].tags) {
+            if (tag.empty()) {
+                continue;
+            }
+            PresetTagEntry entry {};
+            copyFixed(entry.tag, tag, kPresetTagLength);
+            entry.presetIndex = i;
+            tagIndex.push_back(entry);
+        }
+    }
+    std::sort(tagIndex.begin(), tagIndex.end(), [](const PresetTagEntry& a, const PresetTagEntry& b) {
+        int cmp = comparePresetNames(a.tag, b.tag, kPresetTagLength);
+        return cmp != 0 ? cmp < 0 : a.presetIndex < b.presetIndex;
+    });
+
+    PresetBankHeader header {};
+    header.magic = kPresetBankMagic;
+    header.version = kPresetBankVersion;
+    header.headerSize = sizeof(PresetBankHeader);
+    header.presetCount = count;
+    header.paramCount = kParamCount;
+    header.recordSize = recordSize;
+    header.tagCount = static_cast<uint32_t>(tagIndex.size());
+    header.recordsOffset = sizeof(PresetBankHeader);
+    header.nameIndexOffset = header.recordsOffset + static_cast<uint32_t>(records.size());
+    header.tagIndexOffset = header.nameIndexOffset + count * sizeof(uint32_t);
+    header.fileSize = header.tagIndexOffset + header.tagCount * sizeof(PresetTagEntry);
+
+    FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && (records.empty() || std::fwrite(records.data(), records.size(), 1, file) == 1);
+    ok = ok && (nameIndex.empty() || std::fwrite(nameIndex.data(), nameIndex.size() * sizeof(uint32_t), 1, file) == 1);
+    ok = ok && (tagIndex.empty() || std::fwrite(tagIndex.data(), tagIndex.size() * sizeof(PresetTagEntry), 1, file) == 1);
+    ok = (std::fclose(file) == 0) && ok;
+    return ok;
+}
@@ -0,0 +1,117 @@
+#ifndef NOISYSYNTH_PRESETBANK_H
+#define NOISYSYNTH_PRESETBANK_H
+
+#include "SynthParams.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Binary preset bank format (.nspb), little-endian, all sections 4-byte aligned:
+ *
+ *   PresetBankHeader                       64 bytes
+ *   records[presetCount]                   recordSize bytes each:
+ *                                            char name[kPresetNameLength]
+ *                                            float values[paramCount]
+ *   nameIndex[presetCount]                 uint32 record index, sorted by name
+ *   tagIndex[tagCount]                     PresetTagEntry, sorted by (tag, record)
+ *
+ * Names and tags compare case-insensitively. paramCount may differ from
+ * kParamCount: older banks simply leave newer parameters at their defaults.
+ */
+constexpr uint32_t kPresetBankMagic = 0x4250534E; // "NSPB"
+constexpr uint16_t kPresetBankVersion = 1;
+constexpr int kPresetNameLength = 32;
+constexpr int kPresetTagLength = 16;
+
+struct PresetBankHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t presetCount;
+    uint32_t paramCount;
+    uint32_t recordSize;
+    uint32_t tagCount;
+    uint32_t recordsOffset;
+    uint32_t nameIndexOffset;
+    uint32_t tagIndexOffset;
+    uint32_t fileSize;
+    uint32_t reserved[6];
+};
+static_assert(sizeof(PresetBankHeader) == 64, "PresetBankHeader layout changed");
+
+struct PresetTagEntry {
+    char tag[kPresetTagLength];
+    uint32_t presetIndex;
+};
+static_assert(sizeof(PresetTagEntry) == 20, "PresetTagEntry layout changed");
+
+// Case-insensitive compare of two fixed-width, possibly unterminated name fields
+int comparePresetNames(const char* a, const char* b, size_t maxLength);
+
+/**
+ * Read-only view of a memory-mapped preset bank.
+ * Opening validates the header only; nothing is copied to the heap, so
+ * browsing cost does not depend on bank size.
+ */
+class PresetBank {
+public:
+    PresetBank() = default;
+    ~PresetBank();
+    PresetBank(const PresetBank&) = delete;
+    PresetBank& operator=(const PresetBank&) = delete;
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    uint32_t size() const { return header_ ? header_->presetCount : 0; }
+    uint32_t paramCount() const { return header_ ? header_->paramCount : 0; }
+
+    // Record accessors; index is the record (storage) index
+    std::string nameAt(uint32_t index) const;
+    const float* valuesAt(uint32_t index) const;
+
+    // Alphabetical browsing: position 0..size()-1 -> record index
+    uint32_t sortedIndex(uint32_t position) const;
+
+    // O(log n) exact name lookup, returns record index or -1
+    int find(const char* name) const;
+
+    // O(log n + matches) tag lookup. Writes up to maxResults record indices
+    // and returns the total number of presets carrying the tag.
+    uint32_t findByTag(const char* tag, uint32_t* results, uint32_t maxResults) const;
+
+private:
+    const char* recordAt(uint32_t index) const;
+
+    const PresetBankHeader* header_ = nullptr;
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+};
+
+/**
+ * Builds a preset bank in memory and writes it out in one go.
+ * Used by the host CLI tools; never on the audio thread.
+ */
+class PresetBankWriter {
+public:
+    // Returns false if the name is empty or already present
+    bool addPreset(const std::string& name,
+                   const std::vector<std::string>& tags,
+                   const SynthParams& params);
+
+    size_t size() const { return presets_.size(); }
+    bool write(const char* path) const;
+
+private:
+    struct Entry {
+        std::string name;
+        std::vector<std::string> tags;
+        SynthParams params;
+    };
+    std::vector<Entry> presets_;
+};
+
+#endif // NOISYSYNTH_PRESETBANK_H
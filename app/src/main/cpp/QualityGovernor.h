@@ -0,0 +1,107 @@
+#ifndef NOISYSYNTH_QUALITYGOVERNOR_H
+#define NOISYSYNTH_QUALITYGOVERNOR_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * Quality tiers, from full quality down to what keeps a weak device
+ * glitch-free. Higher tiers are cheaper.
+ */
+enum class QualityTier : int32_t {
+    Full = 0,
+    Reduced = 1,
+    Low = 2,
+    Minimal = 3,
+    Count
+};
+constexpr int kQualityTierCount = static_cast<int>(QualityTier::Count);
+
+struct QualitySettings {
+    int maxVoices;                  // new notes only use this many voices; the rest are released
+    bool cheapReverb;               // half the comb filters, one allpass
+    int filterCoefficientInterval;  // samples between SVF coefficient updates
+};
+
+inline constexpr QualitySettings kQualityTiers[kQualityTierCount] = {
+    {8, false, 1},
+    {8, true,  4},
+    {6, true,  16},
+    {4, true,  32},
+};
+
+/**
+ * Watches how much of each callback's time budget the render used and
+ * moves between quality tiers.
+ *
+ * - Step down when the smoothed load passes kStepDownLoad, or at once when
+ *   a single block passes kOverloadLoad. After a step, wait kSettleSeconds
+ *   so the cheaper tier shows up in the measurements before stepping again.
+ * - Step up only after the load has stayed under kStepUpLoad for
+ *   kStepUpSeconds. The gap between the two thresholds is the hysteresis.
+ *
+ * Audio thread only; no allocation, no locks.
+ */
+class QualityGovernor {
+public:
+    static constexpr float kStepDownLoad = 0.75f;
+    static constexpr float kOverloadLoad = 0.95f;
+    static constexpr float kStepUpLoad = 0.45f;
+    static constexpr double kSettleSeconds = 0.5;
+    static constexpr double kStepUpSeconds = 3.0;
+    static constexpr float kSmoothing = 0.1f;   // per block
+
+    // Feed one block. Returns true if the tier changed.
+    bool update(double renderSeconds, double budgetSeconds) {
+        if (budgetSeconds <= 0.0) {
+            return false;
+        }
+        float load = static_cast<float>(renderSeconds / budgetSeconds);
+        smoothedLoad_ += (load - smoothedLoad_) * kSmoothing;
+        peakLoad_ = std::max(peakLoad_ * 0.999f, load);
+        sinceChange_ += budgetSeconds;
+
+        if (sinceChange_ >= kSettleSeconds
+            && (smoothedLoad_ > kStepDownLoad || load > kOverloadLoad)
+            && tier_ < kQualityTierCount - 1) {
+            tier_++;
+            sinceChange_ = 0.0;
+            underSince_ = 0.0;
+            return true;
+        }
+
+        if (smoothedLoad_ < kStepUpLoad) {
+            underSince_ += budgetSeconds;
+            if (underSince_ >= kStepUpSeconds && tier_ > 0) {
+                tier_--;
+                sinceChange_ = 0.0;
+                underSince_ = 0.0;
+                return true;
+            }
+        } else {
+            underSince_ = 0.0;
+        }
+        return false;
+    }
+
+    void reset() {
+        tier_ = 0;
+        smoothedLoad_ = 0.0f;
+        peakLoad_ = 0.0f;
+        sinceChange_ = 0.0;
+        underSince_ = 0.0;
+    }
+
+    QualityTier getTier() const { return static_cast<QualityTier>(tier_); }
+    float getLoad() const { return smoothedLoad_; }
+    float getPeakLoad() const { return peakLoad_; }
+
+private:
+    int tier_ = 0;
+    float smoothedLoad_ = 0.0f;
+    float peakLoad_ = 0.0f;
+    double sinceChange_ = 0.0;
+    double underSince_ = 0.0;
+};
+
+#endif // NOISYSYNTH_QUALITYGOVERNOR_H
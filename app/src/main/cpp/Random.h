@@ -0,0 +1,39 @@
+#ifndef NOISYSYNTH_RANDOM_H
+#define NOISYSYNTH_RANDOM_H
+
+#include <cstdint>
+
+/**
+ * xorshift32 generator. Each engine owns its own, so engines rendering on
+ * different threads never share state and a seed reproduces a render
+ * exactly. No allocation or locking; safe on the audio thread.
+ */
+class Random {
+public:
+    explicit Random(uint32_t seed = 0x9E3779B9u) { setSeed(seed); }
+
+    // 0 would lock xorshift at 0 forever
+    void setSeed(uint32_t seed) { state_ = seed ? seed : 1u; }
+
+    uint32_t next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    // 0 .. range-1, without the bias and division of next() % range
+    int nextInt(int range) {
+        return static_cast<int>((static_cast<uint64_t>(next()) * static_cast<uint32_t>(range)) >> 32);
+    }
+
+    // -1..1
+    float nextBipolar() {
+        return static_cast<float>(next()) * (2.0f / 4294967295.0f) - 1.0f;
+    }
+
+private:
+    uint32_t state_;
+};
+
+#endif // NOISYSYNTH_RANDOM_H
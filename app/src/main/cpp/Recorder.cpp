@@ -0,0 +1,113 @@
+#include "Recorder.h"
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "NoisySynth"
+#include "Log.h"
+
+namespace {
+
+// A 64 KB chunk is about 340 ms of float audio at 48 kHz, so this keeps up
+// with room to spare while waking rarely
+constexpr auto kWriteInterval = std::chrono::milliseconds(50);
+
+} // namespace
+
+Recorder::~Recorder() {
+    stop();
+}
+
+bool Recorder::start(const std::string& path, int32_t sampleRate, WavSampleFormat format) {
+    stop();
+    if (!writer_.open(path.c_str(), sampleRate, 1, format, kPageBytes)) {
+        LOGE("Cannot record to %s", path.c_str());
+        return false;
+    }
+    sampleRate_ = static_cast<float>(sampleRate);
+    chunkFrames_ = kWriteBytes / writer_.getFrameBytes();
+    chunk_.resize(chunkFrames_);
+
+    // Left over from a block that raced the last stop()
+    ring_.discard();
+    framesWritten_.store(0, std::memory_order_relaxed);
+    droppedBlocks_.store(0, std::memory_order_relaxed);
+    droppedFrames_.store(0, std::memory_order_relaxed);
+    latencyMs_.store(0.0f, std::memory_order_relaxed);
+    maxLatencyMs_.store(0.0f, std::memory_order_relaxed);
+    writeFailed_.store(false, std::memory_order_relaxed);
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&Recorder::writerLoop, this);
+    recording_.store(true, std::memory_order_release);
+    LOGD("Recording to %s at %d Hz", path.c_str(), sampleRate);
+    return true;
+}
+
+bool Recorder::stop() {
+    if (!thread_.joinable()) {
+        return true;
+    }
+    recording_.store(false, std::memory_order_release);
+    running_.store(false, std::memory_order_release);
+    thread_.join();
+    drain(true);
+    bool ok = writer_.close() && !writeFailed_.load(std::memory_order_relaxed);
+    LOGD("Recorded %llu frames, %u blocks dropped",
+         static_cast<unsigned long long>(framesWritten_.load(std::memory_order_relaxed)),
+         droppedBlocks_.load(std::memory_order_relaxed));
+    return ok;
+}
+
+void Recorder::push(const float* samples, int32_t numFrames) {
+    if (!recording_.load(std::memory_order_acquire) || numFrames <= 0) {
+        return;
+    }
+    if (ring_.availableToWrite() < static_cast<size_t>(numFrames)) {
+        droppedBlocks_.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames_.fetch_add(static_cast<uint64_t>(numFrames), std::memory_order_relaxed);
+        return;
+    }
+    ring_.write(samples, static_cast<size_t>(numFrames));
+}
+
+RecorderStats Recorder::getStats() const {
+    RecorderStats stats;
+    stats.framesWritten = framesWritten_.load(std::memory_order_relaxed);
+    stats.droppedBlocks = droppedBlocks_.load(std::memory_order_relaxed);
+    stats.droppedFrames = droppedFrames_.load(std::memory_order_relaxed);
+    stats.latencyMs = latencyMs_.load(std::memory_order_relaxed);
+    stats.maxLatencyMs = maxLatencyMs_.load(std::memory_order_relaxed);
+    stats.writeFailed = writeFailed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Recorder::writerLoop() {
+    while (running_.load(std::memory_order_acquire)) {
+        drain(false);
+        std::this_thread::sleep_for(kWriteInterval);
+    }
+}
+
+void Recorder::drain(bool flush) {
+    size_t queued = ring_.availableToRead();
+    float latencyMs = static_cast<float>(queued) * 1000.0f / sampleRate_;
+    latencyMs_.store(latencyMs, std::memory_order_relaxed);
+    if (latencyMs > maxLatencyMs_.load(std::memory_order_relaxed)) {
+        maxLatencyMs_.store(latencyMs, std::memory_order_relaxed);
+    }
+
+    while (queued >= chunkFrames_ || (flush && queued > 0)) {
+        size_t frames = ring_.read(chunk_.data(), std::min(queued, chunkFrames_));
+        queued -= frames;
+        if (writeFailed_.load(std::memory_order_relaxed)) {
+            continue;   // keep emptying the ring so the audio side does not count overruns
+        }
+        if (!writer_.write(chunk_.data(), static_cast<int32_t>(frames))) {
+            LOGE("Recording write failed after %llu frames",
+                 static_cast<unsigned long long>(writer_.getFramesWritten()));
+            writeFailed_.store(true, std::memory_order_relaxed);
+            continue;
+        }
+        framesWritten_.store(writer_.getFramesWritten(), std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef NOISYSYNTH_RECORDER_H
+#define NOISYSYNTH_RECORDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioRing.h"
+#include "WavWriter.h"
+
+struct RecorderStats {
+    uint64_t framesWritten = 0;    // in the file so far
+    uint32_t droppedBlocks = 0;    // callback blocks that found the ring full
+    uint64_t droppedFrames = 0;
+    float latencyMs = 0.0f;        // audio waiting in the ring at the writer's last pass
+    float maxLatencyMs = 0.0f;
+    bool writeFailed = false;      // the file stopped taking data (disk full, removed card)
+};
+
+/**
+ * Records what the device plays to a WAV file without the audio thread
+ * going near the filesystem.
+ *
+ * push() copies each callback's output into a 4 MB ring (about 21 s at
+ * 48 kHz). A writer thread wakes every kWriteInterval and writes whatever
+ * whole kWriteBytes chunks are queued; the file's sample data starts on a
+ * page boundary, so each write covers whole pages. When the ring cannot
+ * take a block, the block is dropped whole and counted; the file then has
+ * a gap, never a partial block.
+ *
+ * start() and stop() open and close the file and run the thread, so they
+ * block; call them from a control thread. push() never blocks, allocates
+ * or makes a system call.
+ */
+class Recorder {
+public:
+    static constexpr size_t kRingSamples = size_t(1) << 20;
+    static constexpr size_t kWriteBytes = 64 * 1024;      // a multiple of the page size
+    static constexpr uint32_t kPageBytes = 4096;
+
+    Recorder() = default;
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Mono, like the engine's output
+    bool start(const std::string& path, int32_t sampleRate, WavSampleFormat format);
+    // Writes out what is queued and closes the file. False if any of it failed.
+    bool stop();
+
+    // Audio thread
+    void push(const float* samples, int32_t numFrames);
+
+    bool isRecording() const { return recording_.load(std::memory_order_relaxed); }
+    RecorderStats getStats() const;
+
+private:
+    void writerLoop();
+    // Writes queued frames in whole chunks, or everything when flushing
+    void drain(bool flush);
+
+    AudioRing ring_{kRingSamples};
+    std::atomic<bool> recording_{false};
+
+    // Writer thread, and the control thread while it is stopped
+    WavWriter writer_;
+    std::vector<float> chunk_;         // one write's worth of frames
+    size_t chunkFrames_ = 0;
+    float sampleRate_ = 48000.0f;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> framesWritten_{0};
+    std::atomic<uint32_t> droppedBlocks_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::atomic<float> latencyMs_{0.0f};
+    std::atomic<float> maxLatencyMs_{0.0f};
+    std::atomic<bool> writeFailed_{false};
+};
+
+#endif // NOISYSYNTH_RECORDER_H
@@ -0,0 +1,183 @@
+#include "RenderTrace.h"
+
+#ifdef NOISYSYNTH_TRACE
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <pthread.h>
+#include <vector>
+
+namespace {
+
+constexpr const char* kStageNames[kTraceStageCount] = {
+    "Callback", "Resampler", "Block", "Control", "Arpeggiator", "Events",
+    "Modulation", "Voices", "Chorus", "Delay", "Reverb", "Master", "Taps",
+};
+
+struct TraceEvent {
+    uint64_t startNs;
+    uint32_t durationNs;
+    uint16_t frames;
+    uint8_t stage;
+    uint8_t summed;
+};
+static_assert(sizeof(TraceEvent) == 16, "trace events are meant to stay 16 bytes");
+
+struct TraceThread {
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> clearedAt{0};   // dump side
+    std::atomic<const char*> name{nullptr};
+    std::atomic<bool> released{false};    // owner has exited; free to reuse
+    TraceEvent events[kTraceCapacity];
+};
+
+TraceThread threads[kTraceThreads];
+std::atomic<int> threadCount{0};          // slots ever claimed
+std::atomic<uint32_t> droppedThreads{0};  // found every slot taken
+
+int claimSlot() {
+    // Unused slots first, so an exited thread's events stay dumpable for
+    // as long as possible
+    int count = threadCount.load(std::memory_order_relaxed);
+    while (count < kTraceThreads) {
+        if (threadCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel)) {
+            return count;
+        }
+    }
+    for (int t = 0; t < kTraceThreads; ++t) {
+        bool released = true;
+        if (threads[t].released.compare_exchange_strong(released, false, std::memory_order_acquire)) {
+            // The old owner's events would show up under this thread's name
+            threads[t].name.store(nullptr, std::memory_order_relaxed);
+            threads[t].clearedAt.store(threads[t].written.load(std::memory_order_relaxed),
+                                       std::memory_order_relaxed);
+            return t;
+        }
+    }
+    droppedThreads.fetch_add(1, std::memory_order_relaxed);
+    return kTraceThreads;
+}
+
+// Gives the slot back when its thread exits: Oboe reopens its stream on a
+// new audio thread, and batch workers come and go. A pthread key rather
+// than a thread_local destructor, whose registration allocates on the
+// thread's first event; setting one of the first keys does not.
+void releaseSlot(void* slot) {
+    threads[reinterpret_cast<intptr_t>(slot) - 1].released.store(true, std::memory_order_release);
+}
+
+pthread_key_t createSlotKey() {
+    pthread_key_t key;
+    pthread_key_create(&key, releaseSlot);
+    return key;
+}
+
+const pthread_key_t slotKey = createSlotKey();
+thread_local int threadSlot = -1;
+
+TraceThread* currentThread() {
+    if (threadSlot < 0) {
+        threadSlot = claimSlot();
+        if (threadSlot < kTraceThreads) {
+            pthread_setspecific(slotKey, reinterpret_cast<void*>(static_cast<intptr_t>(threadSlot) + 1));
+        }
+    }
+    return threadSlot < kTraceThreads ? &threads[threadSlot] : nullptr;
+}
+
+} // namespace
+
+void traceRecord(TraceStage stage, uint64_t startNs, uint64_t endNs, int32_t frames, bool summed) {
+    TraceThread* thread = currentThread();
+    if (!thread) {
+        return;
+    }
+    uint64_t index = thread->written.load(std::memory_order_relaxed);
+    TraceEvent& event = thread->events[index & (kTraceCapacity - 1)];
+    event.startNs = startNs;
+    event.durationNs = static_cast<uint32_t>(std::min<uint64_t>(endNs - startNs, UINT32_MAX));
+    event.frames = static_cast<uint16_t>(std::min<int32_t>(frames, UINT16_MAX));
+    event.stage = static_cast<uint8_t>(stage);
+    event.summed = summed ? 1 : 0;
+    thread->written.store(index + 1, std::memory_order_release);
+}
+
+void traceThreadName(const char* name) {
+    TraceThread* thread = currentThread();
+    if (thread) {
+        thread->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+void traceClear() {
+    int count = std::min(threadCount.load(std::memory_order_acquire), kTraceThreads);
+    for (int t = 0; t < count; ++t) {
+        threads[t].clearedAt.store(threads[t].written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+bool traceCompiledIn() {
+    return true;
+}
+
+bool traceWriteChromeJson(const char* path) {
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    // Threads that found every slot taken recorded nothing; say so rather
+    // than leave a silent gap
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedThreads\":%u},\"traceEvents\":[\n",
+                 static_cast<unsigned>(droppedThreads.load(std::memory_order_relaxed)));
+    bool first = true;
+    std::vector<TraceEvent> events;
+    int count = std::min(threadCount.load(std::memory_order_acquire), kTraceThreads);
+    for (int t = 0; t < count; ++t) {
+        TraceThread& thread = threads[t];
+        const char* name = thread.name.load(std::memory_order_relaxed);
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                           "\"args\":{\"name\":\"%s %d\"}}",
+                     first ? "" : ",\n", t, name ? name : "thread", t);
+        first = false;
+
+        // Copy while the owner may still be writing, then drop whatever it
+        // could have overwritten in the meantime
+        uint64_t end = thread.written.load(std::memory_order_acquire);
+        uint64_t begin = std::max(thread.clearedAt.load(std::memory_order_relaxed),
+                                  end > kTraceCapacity ? end - kTraceCapacity : 0);
+        events.clear();
+        for (uint64_t i = begin; i < end; ++i) {
+            events.push_back(thread.events[i & (kTraceCapacity - 1)]);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t now = thread.written.load(std::memory_order_relaxed);
+        uint64_t safe = now >= kTraceCapacity ? now - kTraceCapacity + 1 : 0;
+        size_t skip = (safe > begin) ? static_cast<size_t>(std::min(safe - begin, end - begin)) : 0;
+
+        for (size_t i = skip; i < events.size(); ++i) {
+            const TraceEvent& event = events[i];
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                               "\"pid\":1,\"tid\":%d,\"args\":{\"frames\":%u}}",
+                         kStageNames[event.stage], event.summed ? "summed" : "scope",
+                         event.startNs / 1000.0, event.durationNs / 1000.0, t,
+                         static_cast<unsigned>(event.frames));
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+#else
+
+void traceClear() {}
+
+bool traceCompiledIn() {
+    return false;
+}
+
+bool traceWriteChromeJson(const char*) {
+    return false;
+}
+
+#endif
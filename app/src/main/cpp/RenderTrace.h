@@ -0,0 +1,157 @@
+#ifndef NOISYSYNTH_RENDERTRACE_H
+#define NOISYSYNTH_RENDERTRACE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Per-stage render timings for finding which stage spikes when a callback
+ * runs late, written out as Chrome trace JSON (chrome://tracing, or
+ * ui.perfetto.dev, which opens the same files).
+ *
+ * Compiled in only with NOISYSYNTH_TRACE; without it the macros and
+ * TraceStages below are empty and the dump functions report that there is
+ * nothing to dump.
+ *
+ * Each thread that records gets its own fixed ring of events in static
+ * storage, claimed with one atomic on its first event and given back when
+ * the thread exits, so recording never allocates, locks or makes a system
+ * call beyond reading the clock. The rings keep the latest kTraceCapacity
+ * events per thread: dump right after a glitch and it is in there.
+ */
+
+// Append only; names in RenderTrace.cpp
+enum class TraceStage : uint8_t {
+    Callback,      // onAudioReady(), all of it
+    Resampler,
+    Block,         // renderBlock(), split into the stages below
+    Control,       // control ring, tuning, transports, loop freeze
+    Arpeggiator,
+    Events,        // MIDI file and sequencer events, lane glides
+    Modulation,    // control ticks, LFOs, global modulation
+    Voices,        // voice mix and poly gain
+    Chorus,
+    Delay,
+    Reverb,
+    Master,        // output gain, limiter, clipping
+    Taps,          // visualization taps
+    Count
+};
+
+constexpr int kTraceStageCount = static_cast<int>(TraceStage::Count);
+constexpr int kTraceThreads = 16;               // threads recording at once; more are counted as dropped
+constexpr uint32_t kTraceCapacity = 1u << 14;   // events per thread, power of two
+
+// Writes every thread's events as Chrome trace JSON. Any thread but a
+// real-time one. False if the file fails or tracing is compiled out.
+bool traceWriteChromeJson(const char* path);
+// Drops everything recorded so far from later dumps
+void traceClear();
+bool traceCompiledIn();
+
+#ifdef NOISYSYNTH_TRACE
+
+inline uint64_t traceNow() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// The cheapest monotonic counter the CPU has, in its own units: a few
+// cycles where the steady clock costs tens of nanoseconds
+inline uint64_t traceTicks() {
+#if defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return traceNow();
+#endif
+}
+
+// summed: a stage timed in pieces and laid out as one span (see TraceStages)
+void traceRecord(TraceStage stage, uint64_t startNs, uint64_t endNs, int32_t frames, bool summed = false);
+// Names the calling thread in dumps; name must outlive the process (a literal)
+void traceThreadName(const char* name);
+
+class TraceScope {
+public:
+    TraceScope(TraceStage stage, int32_t frames) : stage_(stage), frames_(frames), start_(traceNow()) {}
+    ~TraceScope() { traceRecord(stage_, start_, traceNow(), frames_); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceStage stage_;
+    int32_t frames_;
+    uint64_t start_;
+};
+
+/**
+ * Splits a block into stages that interleave sample by sample. Each lap()
+ * charges the ticks since the previous one to a stage; end() converts the
+ * totals with the block's own steady-clock length and records them back to
+ * back from begin(), so in the viewer the stages tile the block in
+ * TraceStage order. Their lengths are measured; their positions inside
+ * the block are not.
+ */
+class TraceStages {
+public:
+    void begin() {
+        startNs_ = traceNow();
+        startTicks_ = traceTicks();
+        last_ = startTicks_;
+        std::fill(sums_, sums_ + kTraceStageCount, 0);
+    }
+    void lap(TraceStage stage) {
+        uint64_t now = traceTicks();
+        sums_[static_cast<int>(stage)] += now - last_;
+        last_ = now;
+    }
+    void end(int32_t frames) {
+        uint64_t endNs = traceNow();
+        uint64_t ticks = traceTicks() - startTicks_;
+        double nsPerTick = ticks > 0 ? static_cast<double>(endNs - startNs_) / static_cast<double>(ticks) : 0.0;
+        uint64_t at = startNs_;
+        for (int s = 0; s < kTraceStageCount; ++s) {
+            if (sums_[s] > 0) {
+                auto length = static_cast<uint64_t>(static_cast<double>(sums_[s]) * nsPerTick);
+                traceRecord(static_cast<TraceStage>(s), at, at + length, frames, true);
+                at += length;
+            }
+        }
+    }
+
+private:
+    uint64_t startNs_ = 0;
+    uint64_t startTicks_ = 0;
+    uint64_t last_ = 0;
+    uint64_t sums_[kTraceStageCount] = {};
+};
+
+#define NOISYSYNTH_TRACE_CONCAT2(a, b) a##b
+#define NOISYSYNTH_TRACE_CONCAT(a, b) NOISYSYNTH_TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(stage, frames) \
+    TraceScope NOISYSYNTH_TRACE_CONCAT(traceScope, __LINE__)(TraceStage::stage, frames)
+#define TRACE_THREAD_NAME(name) traceThreadName(name)
+
+#else
+
+class TraceStages {
+public:
+    void begin() {}
+    void lap(TraceStage) {}
+    void end(int32_t) {}
+};
+
+#define TRACE_SCOPE(stage, frames) do { } while (0)
+#define TRACE_THREAD_NAME(name) do { } while (0)
+
+#endif
+
+#endif // NOISYSYNTH_RENDERTRACE_H
@@ -0,0 +1,93 @@
+#include "Resampler.h"
+#include "Simd.h"
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kKaiserBeta = 8.0;      // about 80 dB stopband
+constexpr double kPassbandFraction = 0.9; // cutoff as a fraction of the lower Nyquist
+
+// Modified Bessel function of the first kind, order 0
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+bool PolyphaseResampler::prepare(int32_t inputRate, int32_t outputRate, int32_t maxOutputFrames) {
+    if (inputRate <= 0 || outputRate <= 0 || maxOutputFrames <= 0) {
+        return false;
+    }
+    int32_t divisor = std::gcd(inputRate, outputRate);
+    int32_t up = outputRate / divisor;
+    int32_t down = inputRate / divisor;
+    if (up > kMaxPhases) {
+        return false;
+    }
+
+    inputRate_ = inputRate;
+    outputRate_ = outputRate;
+    up_ = up;
+    down_ = down;
+
+    // Prototype at the upsampled rate, then split into phases
+    int length = kTapsPerPhase * up;
+    double cutoff = 0.5 * kPassbandFraction / std::max(up, down); // cycles per upsampled sample
+    double center = (length - 1) * 0.5;
+    double windowNorm = besselI0(kKaiserBeta);
+    std::vector<double> prototype(length);
+    double sum = 0.0;
+    for (int i = 0; i < length; ++i) {
+        double x = i - center;
+        double sinc = (x == 0.0) ? 1.0 : std::sin(2.0 * kPi * cutoff * x) / (2.0 * kPi * cutoff * x);
+        double ratio = x / center;
+        double window = besselI0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / windowNorm;
+        prototype[i] = 2.0 * cutoff * sinc * window;
+        sum += prototype[i];
+    }
+
+    // Unity gain per phase on average; row p, tap k sees input n - k
+    coefficients_.assign(static_cast<size_t>(up) * kTapsPerPhase, 0.0f);
+    for (int p = 0; p < up; ++p) {
+        for (int k = 0; k < kTapsPerPhase; ++k) {
+            double h = prototype[static_cast<size_t>(k) * up + p] * up / sum;
+            coefficients_[static_cast<size_t>(p) * kTapsPerPhase + (kTapsPerPhase - 1 - k)] = static_cast<float>(h);
+        }
+    }
+
+    latencySeconds_ = center / (static_cast<double>(up) * inputRate) + 1.0 / inputRate;
+    history_.assign(2 * kTapsPerPhase, 0.0f);
+    reset();
+    maxInputFrames_ = static_cast<int32_t>((static_cast<int64_t>(up - 1) + static_cast<int64_t>(maxOutputFrames) * down) / up);
+    return true;
+}
+
+void PolyphaseResampler::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    historyIndex_ = 0;
+    phase_ = 0;
+}
+
+void PolyphaseResampler::process(const float* input, float* output, int32_t outputFrames) {
+    const float* rows = coefficients_.data();
+    for (int32_t i = 0; i < outputFrames; ++i) {
+        output[i] = simd::dot(history_.data() + historyIndex_, rows + static_cast<size_t>(phase_) * kTapsPerPhase,
+                              kTapsPerPhase);
+        phase_ += down_;
+        while (phase_ >= up_) {
+            phase_ -= up_;
+            push(*input++);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef NOISYSYNTH_RESAMPLER_H
+#define NOISYSYNTH_RESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Streaming polyphase FIR resampler for a fixed rational ratio
+ * (outputRate / inputRate = up / down after reducing by the gcd).
+ *
+ * The prototype is a Kaiser-windowed sinc with kTapsPerPhase taps per
+ * phase, cut off just below the lower of the two Nyquist frequencies. Each
+ * output sample is one kTapsPerPhase-long dot product (simd::dot).
+ *
+ * Pull model: ask inputFramesNeeded(n) for the exact number of input frames
+ * the next n outputs consume, render that many, then call process(). Both
+ * are deterministic, so there is no internal input FIFO.
+ *
+ * prepare() allocates; process() does not.
+ */
+class PolyphaseResampler {
+public:
+    static constexpr int kTapsPerPhase = 32;
+    static constexpr int32_t kMaxPhases = 1024;   // limits the coefficient table to 128 KB
+
+    // False if the reduced ratio needs more than kMaxPhases phases
+    bool prepare(int32_t inputRate, int32_t outputRate, int32_t maxOutputFrames);
+    void reset();
+
+    int32_t inputFramesNeeded(int32_t outputFrames) const {
+        return static_cast<int32_t>((phase_ + static_cast<int64_t>(outputFrames) * down_) / up_);
+    }
+    // Upper bound of inputFramesNeeded() for up to maxOutputFrames outputs
+    int32_t getMaxInputFrames() const { return maxInputFrames_; }
+
+    // input holds inputFramesNeeded(outputFrames) frames
+    void process(const float* input, float* output, int32_t outputFrames);
+
+    // Group delay of the filter, in seconds
+    double getLatencySeconds() const { return latencySeconds_; }
+    int32_t getInputRate() const { return inputRate_; }
+    int32_t getOutputRate() const { return outputRate_; }
+
+private:
+    void push(float sample) {
+        history_[historyIndex_] = sample;
+        history_[historyIndex_ + kTapsPerPhase] = sample;
+        historyIndex_ = (historyIndex_ + 1) % kTapsPerPhase;
+    }
+
+    int32_t inputRate_ = 0;
+    int32_t outputRate_ = 0;
+    int32_t up_ = 1;
+    int32_t down_ = 1;
+    int32_t phase_ = 0;
+    int32_t maxInputFrames_ = 0;
+    double latencySeconds_ = 0.0;
+    std::vector<float> coefficients_;  // up_ rows of kTapsPerPhase, oldest input first
+    std::vector<float> history_;       // last kTapsPerPhase inputs, stored twice so the window is contiguous
+    int historyIndex_ = 0;
+};
+
+#endif // NOISYSYNTH_RESAMPLER_H
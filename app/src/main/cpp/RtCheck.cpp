@@ -0,0 +1,246 @@
+#include "RtCheck.h"
+
+#ifndef NOISYSYNTH_RT_CHECK
+#error "RtCheck.cpp needs NOISYSYNTH_RT_CHECK"
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// glibc's own allocator entry points; forwarding to them needs no dlsym,
+// which itself may allocate
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace {
+
+std::atomic<int> mode{static_cast<int>(RtCheckMode::Count)};
+std::atomic<uint64_t> violations{0};
+std::atomic<const char*> firstViolation{nullptr};
+
+// Set while a violation is being reported, so the report's own calls pass
+thread_local int reporting = 0;
+
+void writeRaw(const char* text) {
+    syscall(SYS_write, 2, text, std::strlen(text));
+}
+
+void violation(const char* function) {
+    if (rtcheck::renderDepth == 0 || reporting) {
+        return;
+    }
+    reporting = 1;
+    violations.fetch_add(1, std::memory_order_relaxed);
+    const char* expected = nullptr;
+    firstViolation.compare_exchange_strong(expected, function, std::memory_order_relaxed);
+
+    auto current = static_cast<RtCheckMode>(mode.load(std::memory_order_relaxed));
+    if (current != RtCheckMode::Count) {
+        writeRaw("rtcheck: ");
+        writeRaw(function);
+        writeRaw(" called inside render\n");
+        if (current == RtCheckMode::Abort) {
+            std::abort();
+        }
+    }
+    reporting = 0;
+}
+
+template <typename Function>
+Function next(const char* name) {
+    return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+}
+
+// Resolve the real function once, on first use
+#define RTCHECK_REAL(name) \
+    static const auto real = next<decltype(&::name)>(#name)
+
+} // namespace
+
+void rtCheckSetMode(RtCheckMode newMode) {
+    mode.store(static_cast<int>(newMode), std::memory_order_relaxed);
+}
+
+uint64_t rtCheckViolationCount() {
+    return violations.load(std::memory_order_relaxed);
+}
+
+const char* rtCheckFirstViolation() {
+    return firstViolation.load(std::memory_order_relaxed);
+}
+
+void rtCheckReset() {
+    violations.store(0, std::memory_order_relaxed);
+    firstViolation.store(nullptr, std::memory_order_relaxed);
+}
+
+extern "C" {
+
+// Allocation (operator new/delete come through here too)
+
+void* malloc(size_t size) {
+    violation("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    violation("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    violation("realloc");
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+    if (pointer) {
+        violation("free");
+    }
+    __libc_free(pointer);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    violation("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) {
+    violation("posix_memalign");
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* memory = __libc_memalign(alignment, size);
+    if (!memory) {
+        return ENOMEM;
+    }
+    *pointer = memory;
+    return 0;
+}
+
+// Locks and condition variables (std::mutex, std::condition_variable)
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    violation("pthread_mutex_lock");
+    RTCHECK_REAL(pthread_mutex_lock);
+    return real(mutex);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex) {
+    violation("pthread_mutex_trylock");
+    RTCHECK_REAL(pthread_mutex_trylock);
+    return real(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex) {
+    violation("pthread_cond_wait");
+    RTCHECK_REAL(pthread_cond_wait);
+    return real(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time) {
+    violation("pthread_cond_timedwait");
+    RTCHECK_REAL(pthread_cond_timedwait);
+    return real(condition, mutex, time);
+}
+
+int pthread_cond_signal(pthread_cond_t* condition) {
+    violation("pthread_cond_signal");
+    RTCHECK_REAL(pthread_cond_signal);
+    return real(condition);
+}
+
+int pthread_cond_broadcast(pthread_cond_t* condition) {
+    violation("pthread_cond_broadcast");
+    RTCHECK_REAL(pthread_cond_broadcast);
+    return real(condition);
+}
+
+// File I/O and sleeps
+
+int open(const char* path, int flags, ...) {
+    violation("open");
+    mode_t fileMode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_list args;
+        va_start(args, flags);
+        fileMode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+    RTCHECK_REAL(open);
+    return real(path, flags, fileMode);
+}
+
+ssize_t read(int fd, void* buffer, size_t count) {
+    violation("read");
+    RTCHECK_REAL(read);
+    return real(fd, buffer, count);
+}
+
+ssize_t write(int fd, const void* buffer, size_t count) {
+    violation("write");
+    RTCHECK_REAL(write);
+    return real(fd, buffer, count);
+}
+
+int close(int fd) {
+    violation("close");
+    RTCHECK_REAL(close);
+    return real(fd);
+}
+
+FILE* fopen(const char* path, const char* fileMode) {
+    violation("fopen");
+    RTCHECK_REAL(fopen);
+    return real(path, fileMode);
+}
+
+size_t fwrite(const void* data, size_t size, size_t count, FILE* file) {
+    violation("fwrite");
+    RTCHECK_REAL(fwrite);
+    return real(data, size, count, file);
+}
+
+int fputs(const char* text, FILE* file) {
+    violation("fputs");
+    RTCHECK_REAL(fputs);
+    return real(text, file);
+}
+
+int fprintf(FILE* file, const char* format, ...) {
+    violation("fprintf");
+    va_list args;
+    va_start(args, format);
+    int result = vfprintf(file, format, args);
+    va_end(args);
+    return result;
+}
+
+int nanosleep(const struct timespec* duration, struct timespec* remaining) {
+    violation("nanosleep");
+    RTCHECK_REAL(nanosleep);
+    return real(duration, remaining);
+}
+
+int usleep(useconds_t microseconds) {
+    violation("usleep");
+    RTCHECK_REAL(usleep);
+    return real(microseconds);
+}
+
+} // extern "C"
@@ -0,0 +1,57 @@
+#ifndef NOISYSYNTH_RTCHECK_H
+#define NOISYSYNTH_RTCHECK_H
+
+#include <cstdint>
+
+/*
+ * Real-time safety checker for debug and test builds.
+ *
+ * With NOISYSYNTH_RT_CHECK defined, the engine marks its render entry
+ * points with RtRenderScope, which sets a thread-local flag. RtCheck.cpp
+ * interposes malloc/free, pthread mutexes and condition variables, and
+ * common blocking calls (file I/O, stdio, sleeps); any of them hit while
+ * the flag is set is a violation. Link RtCheck.cpp only into test and
+ * debug executables: it replaces those functions for the whole process.
+ *
+ * Without NOISYSYNTH_RT_CHECK, RtRenderScope is empty and nothing else
+ * here exists.
+ */
+#ifdef NOISYSYNTH_RT_CHECK
+
+namespace rtcheck {
+// Nesting depth of RtRenderScope on this thread; plain int so the hooks can
+// read it without touching the allocator
+inline thread_local int renderDepth = 0;
+}
+
+class RtRenderScope {
+public:
+    RtRenderScope() { ++rtcheck::renderDepth; }
+    ~RtRenderScope() { --rtcheck::renderDepth; }
+    RtRenderScope(const RtRenderScope&) = delete;
+    RtRenderScope& operator=(const RtRenderScope&) = delete;
+};
+
+enum class RtCheckMode {
+    Count,   // record and carry on (tests assert on the count)
+    Report,  // record and print each one to stderr
+    Abort    // print and abort(), for a debugger or core dump at the culprit
+};
+
+// Defined in RtCheck.cpp. Thread-safe.
+void rtCheckSetMode(RtCheckMode mode);
+uint64_t rtCheckViolationCount();
+// Name of the first function trapped since the last reset, or nullptr
+const char* rtCheckFirstViolation();
+void rtCheckReset();
+
+#else
+
+class RtRenderScope {
+public:
+    RtRenderScope() {}
+};
+
+#endif
+
+#endif // NOISYSYNTH_RTCHECK_H
@@ -0,0 +1,200 @@
+#include "RtLog.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+namespace {
+
+constexpr const char* kTag = "NoisySynth";
+constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+
+// printf formats, indexed by RtLogEvent. %d/%x/%c take an int argument,
+// everything else a float.
+constexpr const char* kEventFormats[] = {
+    "Note ON: %d (part %d)",
+    "Note RETRIGGER: %d (part %d)",
+    "Note OFF: %d (part %d)",
+    "No free voice for note: %d",
+    "Waveform: %d",
+    "Quality tier %d (load %.2f)",
+};
+static_assert(sizeof(kEventFormats) / sizeof(kEventFormats[0]) == static_cast<size_t>(RtLogEvent::Count),
+              "every RtLogEvent needs a format");
+
+/*
+ * Bounded multi-producer / single-consumer queue (Vyukov). A cell's
+ * sequence tells whose turn it is: equal to the write position means free
+ * for that producer, one past it means filled and ready for the consumer.
+ */
+struct Cell {
+    std::atomic<uint32_t> sequence;
+    RtLogRecord record;
+};
+
+class RtLogRing {
+public:
+    RtLogRing() {
+        for (uint32_t i = 0; i < kRtLogCapacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const RtLogRecord& record) {
+        uint32_t position = writePosition_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[position & (kRtLogCapacity - 1)];
+            uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+            int32_t diff = static_cast<int32_t>(sequence - position);
+            if (diff == 0) {
+                if (writePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                position = writePosition_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record = record;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool pop(RtLogRecord& record) {
+        Cell& cell = cells_[readPosition_ & (kRtLogCapacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != readPosition_ + 1) {
+            return false;
+        }
+        record = cell.record;
+        cell.sequence.store(readPosition_ + kRtLogCapacity, std::memory_order_release);
+        readPosition_++;
+        return true;
+    }
+
+    uint32_t takeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+private:
+    Cell cells_[kRtLogCapacity];
+    alignas(64) std::atomic<uint32_t> writePosition_{0};
+    alignas(64) std::atomic<uint32_t> dropped_{0};
+    alignas(64) uint32_t readPosition_ = 0;
+};
+
+RtLogRing ring;
+
+std::mutex drainMutex;       // one consumer at a time: the drain thread or rtLogFlush()
+std::mutex controlMutex;     // users and the thread handle
+int users = 0;
+std::atomic<bool> running{false};
+std::thread drainThread;
+
+void write(RtLogLevel level, const char* text) {
+#ifdef __ANDROID__
+    int priority = level == RtLogLevel::Error ? ANDROID_LOG_ERROR
+                 : level == RtLogLevel::Info ? ANDROID_LOG_INFO : ANDROID_LOG_DEBUG;
+    __android_log_write(priority, kTag, text);
+#else
+    (void)level;
+    std::fprintf(stderr, "%s: %s\n", kTag, text);
+#endif
+}
+
+// Expand one conversion at a time, taking int or float by its letter
+void format(const RtLogRecord& record, char* out, size_t size) {
+    if (record.event >= static_cast<uint16_t>(RtLogEvent::Count)) {
+        std::snprintf(out, size, "unknown log event %u", record.event);
+        return;
+    }
+    const char* in = kEventFormats[record.event];
+    size_t length = 0;
+    int arg = 0;
+    while (*in && length + 1 < size) {
+        if (*in != '%' || in[1] == '%') {
+            out[length++] = *in;
+            in += (*in == '%') ? 2 : 1;
+            continue;
+        }
+        const char* end = in + 1;
+        while (*end && !std::strchr("diuxXcfFeEgG", *end)) {
+            ++end;
+        }
+        if (!*end) {
+            break;
+        }
+        char spec[16];
+        size_t specLength = std::min(static_cast<size_t>(end - in + 1), sizeof(spec) - 1);
+        std::memcpy(spec, in, specLength);
+        spec[specLength] = '\0';
+
+        RtLogArg value = arg < record.argCount ? record.args[arg] : rtLogArg(0);
+        ++arg;
+        int written = std::strchr("diuxXc", *end)
+            ? std::snprintf(out + length, size - length, spec, value.i)
+            : std::snprintf(out + length, size - length, spec, static_cast<double>(value.f));
+        if (written > 0) {
+            length = std::min(length + static_cast<size_t>(written), size - 1);
+        }
+        in = end + 1;
+    }
+    out[length] = '\0';
+}
+
+void drain() {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    RtLogRecord record;
+    char text[256];
+    while (ring.pop(record)) {
+        format(record, text, sizeof(text));
+        write(record.level, text);
+    }
+    uint32_t dropped = ring.takeDropped();
+    if (dropped > 0) {
+        std::snprintf(text, sizeof(text), "%u log records dropped (ring full)", dropped);
+        write(RtLogLevel::Error, text);
+    }
+}
+
+void drainLoop() {
+    while (running.load(std::memory_order_acquire)) {
+        drain();
+        std::this_thread::sleep_for(kDrainInterval);
+    }
+    drain();
+}
+
+} // namespace
+
+bool rtLogPush(const RtLogRecord& record) {
+    return ring.push(record);
+}
+
+void rtLogAcquire() {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (users++ == 0) {
+        running.store(true, std::memory_order_release);
+        drainThread = std::thread(drainLoop);
+    }
+}
+
+void rtLogRelease() {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (users > 0 && --users == 0) {
+        running.store(false, std::memory_order_release);
+        drainThread.join();
+    }
+}
+
+void rtLogFlush() {
+    drain();
+}
@@ -0,0 +1,83 @@
+#ifndef NOISYSYNTH_RTLOG_H
+#define NOISYSYNTH_RTLOG_H
+
+#include <cstdint>
+
+/*
+ * Logging from the audio thread. A call copies a 16-byte record (event id
+ * plus up to three int/float arguments) into a fixed, lock-free ring;
+ * formatting and the actual logcat / stderr write happen on a background
+ * thread. Use it through RTLOGD / RTLOGI / RTLOGE in Log.h, which compile away
+ * below NOISYSYNTH_LOG_LEVEL.
+ *
+ * Any number of threads may write (each engine in a batch render logs from
+ * its own worker). When the ring is full the record is dropped and
+ * counted; the drain thread reports how many.
+ */
+
+// Add new events at the end and give them a format in RtLog.cpp
+enum class RtLogEvent : uint16_t {
+    NoteOn,          // note, part
+    NoteRetrigger,   // note, part
+    NoteOff,         // note, part
+    NoFreeVoice,     // note
+    Waveform,        // waveform
+    QualityTier,     // tier, load
+    Count
+};
+
+enum class RtLogLevel : uint8_t {
+    Debug,
+    Info,
+    Error
+};
+
+constexpr int kRtLogMaxArgs = 3;
+constexpr uint32_t kRtLogCapacity = 1024;   // records, power of two
+
+union RtLogArg {
+    int32_t i;
+    float f;
+};
+
+struct RtLogRecord {
+    uint16_t event;
+    RtLogLevel level;
+    uint8_t argCount;
+    RtLogArg args[kRtLogMaxArgs];
+};
+static_assert(sizeof(RtLogRecord) == 16, "log records are meant to stay 16 bytes");
+
+inline RtLogArg rtLogArg(int value) { RtLogArg arg; arg.i = value; return arg; }
+inline RtLogArg rtLogArg(float value) { RtLogArg arg; arg.f = value; return arg; }
+inline RtLogArg rtLogArg(double value) { return rtLogArg(static_cast<float>(value)); }
+
+// Never blocks, allocates or makes a system call. Returns false if dropped.
+bool rtLogPush(const RtLogRecord& record);
+
+template <typename... Args>
+inline void rtLog(RtLogLevel level, RtLogEvent event, Args... args) {
+    static_assert(sizeof...(Args) <= kRtLogMaxArgs, "too many log arguments");
+    RtLogRecord record{};
+    record.event = static_cast<uint16_t>(event);
+    record.level = level;
+    record.argCount = static_cast<uint8_t>(sizeof...(Args));
+    int index = 0;
+    ((record.args[index++] = rtLogArg(args)), ...);
+    (void)index;
+    rtLogPush(record);
+}
+
+/*
+ * The drain thread runs while at least one user holds it. SynthEngine
+ * acquires it in its constructor and releases it in its destructor; both
+ * may block, so never call them on the audio thread. Releasing the last
+ * reference drains what is left before the thread exits.
+ */
+void rtLogAcquire();
+void rtLogRelease();
+
+// Format and write everything queued so far on the calling thread
+void rtLogFlush();
+
+#endif // NOISYSYNTH_RTLOG_H
@@ -0,0 +1,113 @@
+#ifndef NOISYSYNTH_SEQUENCER_H
+#define NOISYSYNTH_SEQUENCER_H
+
+#include <cstdint>
+
+/*
+ * Step sequencer data. Everything has a fixed capacity, so a SequencerBank
+ * is one flat block that can be copied whole: the engine edits its own
+ * copy on the control thread and publishes it to the audio thread through
+ * a DoubleBuffer. Playback state lives in SynthEngine.
+ */
+constexpr int kSequencerMaxSteps = 128;      // 16 measures of eighths
+constexpr int kSequencerMaxTracks = 4;
+constexpr int kSequencerMaxChordNotes = 4;
+constexpr int kSequencerMaxPatterns = 16;
+constexpr int kSequencerMaxSongSlots = 64;
+constexpr int kSequencerMaxLanes = 8;               // automated parameters per pattern
+constexpr int kSequencerAutomationInterval = 32;    // samples between the points of a glide
+constexpr float kSequencerMinTempo = 20.0f;         // BPM
+constexpr float kSequencerMaxTempo = 999.0f;
+
+enum class SequencerStepLength {
+    Eighth = 0,
+    Quarter = 1,
+    Half = 2,
+    Whole = 3
+};
+
+// Steps in a 4/4 measure, and beats per step
+inline int sequencerStepsPerMeasure(SequencerStepLength length) {
+    switch (length) {
+        case SequencerStepLength::Eighth:  return 8;
+        case SequencerStepLength::Quarter: return 4;
+        case SequencerStepLength::Half:    return 2;
+        case SequencerStepLength::Whole:   return 1;
+    }
+    return 4;
+}
+
+inline float sequencerStepBeats(SequencerStepLength length) {
+    return 4.0f / static_cast<float>(sequencerStepsPerMeasure(length));
+}
+
+/**
+ * One step of one track: up to kSequencerMaxChordNotes notes started
+ * together. noteCount 0 is a rest; the notes are kept so switching the
+ * step back on restores them.
+ */
+struct SequencerStep {
+    uint8_t notes[kSequencerMaxChordNotes] = {60, 0, 0, 0};
+    uint8_t noteCount = 0;
+    uint8_t velocity = 127;      // 1..127
+    float gate = 0.9f;           // fraction of the step the notes are held, 0.01..1
+};
+
+/**
+ * Automation of one parameter across a pattern. A step with a value locks
+ * the parameter to it for that step (a parameter lock); on steps without
+ * one the parameter goes back to where the patch has it. A glide lane
+ * instead ramps from each value to the next step's, when that step has
+ * one too.
+ */
+struct SequencerLane {
+    int16_t param = -1;          // ParamId, -1 = unused lane
+    int8_t part = -1;            // -1 = the patch setParameter() edits, else that part's
+    bool glide = false;
+    uint32_t hasValue[kSequencerMaxSteps / 32] = {};
+    float values[kSequencerMaxSteps] = {};
+
+    bool isSet(int step) const { return (hasValue[step >> 5] >> (step & 31)) & 1u; }
+    void set(int step, float value) {
+        values[step] = value;
+        hasValue[step >> 5] |= 1u << (step & 31);
+    }
+    void clear(int step) { hasValue[step >> 5] &= ~(1u << (step & 31)); }
+};
+
+struct SequencerPattern {
+    int32_t stepCount = 32;      // 4 measures of eighths
+    SequencerStepLength stepLength = SequencerStepLength::Eighth;
+    SequencerStep steps[kSequencerMaxTracks][kSequencerMaxSteps];
+    SequencerLane lanes[kSequencerMaxLanes];   // at most one per parameter
+};
+
+struct SequencerTrack {
+    int32_t part = -1;           // -1 = every part whose key range holds the note, like noteOn()
+    bool muted = false;
+};
+
+struct SequencerSongSlot {
+    uint8_t pattern = 0;
+    uint8_t repeats = 1;         // times the pattern plays before the next slot
+};
+
+struct SequencerBank {
+    SequencerPattern patterns[kSequencerMaxPatterns];
+    SequencerTrack tracks[kSequencerMaxTracks];
+    SequencerSongSlot song[kSequencerMaxSongSlots];
+    int32_t songLength = 0;
+    bool songMode = false;       // play the song; otherwise loop selectedPattern
+    int32_t selectedPattern = 0;
+
+    // Track 0 of pattern 0 walks up a C major scale, as the sequencer always has
+    SequencerBank() {
+        static const uint8_t kScale[] = {60, 62, 64, 65, 67, 69, 71, 72};
+        for (int i = 0; i < kSequencerMaxSteps; ++i) {
+            patterns[0].steps[0][i].notes[0] = kScale[i % 8];
+            patterns[0].steps[0][i].noteCount = 1;
+        }
+    }
+};
+
+#endif // NOISYSYNTH_SEQUENCER_H
@@ -0,0 +1,139 @@
+#ifndef NOISYSYNTH_SIMD_H
+#define NOISYSYNTH_SIMD_H
+
+/*
+ * Small vector helpers for the hot loops. NEON on ARM (every arm64-v8a and
+ * armeabi-v7a device the app supports), SSE on x86 emulators and hosts, and
+ * a scalar fallback. Pointers need no particular alignment.
+ */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NOISYSYNTH_SIMD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NOISYSYNTH_SIMD_SSE 1
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace simd {
+
+// Sum of a[i] * b[i]; count must be a multiple of 4
+inline float dot(const float* a, const float* b, int count) {
+#if defined(NOISYSYNTH_SIMD_NEON)
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (int i = 0; i < count; i += 4) {
+        sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+#if defined(__aarch64__)
+    return vaddvq_f32(sum);
+#else
+    float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+#elif defined(NOISYSYNTH_SIMD_SSE)
+    __m128 sum = _mm_setzero_ps();
+    for (int i = 0; i < count; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    __m128 shuffled = _mm_movehl_ps(sum, sum);
+    sum = _mm_add_ps(sum, shuffled);
+    shuffled = _mm_shuffle_ps(sum, sum, 0x55);
+    return _mm_cvtss_f32(_mm_add_ss(sum, shuffled));
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+#endif
+}
+
+/*
+ * Four interleaved xorshift32 generators, one per lane: lane i of state
+ * makes out[i], out[i + 4], ... Each output is the new state read as a
+ * signed integer and scaled to -1..1. count must be a multiple of 4. Every
+ * path rounds the same way, so a seed renders identically on all of them.
+ */
+inline void xorshift4(uint32_t* state, float* out, int count) {
+    constexpr float kScale = 1.0f / 2147483648.0f;
+#if defined(NOISYSYNTH_SIMD_NEON)
+    uint32x4_t s = vld1q_u32(state);
+    const float32x4_t scale = vdupq_n_f32(kScale);
+    for (int i = 0; i < count; i += 4) {
+        s = veorq_u32(s, vshlq_n_u32(s, 13));
+        s = veorq_u32(s, vshrq_n_u32(s, 17));
+        s = veorq_u32(s, vshlq_n_u32(s, 5));
+        vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(s)), scale));
+    }
+    vst1q_u32(state, s);
+#elif defined(NOISYSYNTH_SIMD_SSE)
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    const __m128 scale = _mm_set1_ps(kScale);
+    for (int i = 0; i < count; i += 4) {
+        s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+        s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+        s = _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), s);
+#else
+    for (int i = 0; i < count; i += 4) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint32_t s = state[lane];
+            s ^= s << 13;
+            s ^= s >> 17;
+            s ^= s << 5;
+            state[lane] = s;
+            out[i + lane] = static_cast<float>(static_cast<int32_t>(s)) * kScale;
+        }
+    }
+#endif
+}
+
+// Largest |data[i]| into peak, and the sum of data[i]^2 as the result. Any count.
+inline float peakAndEnergy(const float* data, int count, float* peak) {
+    int i = 0;
+    float maxAbs = 0.0f;
+    float energy = 0.0f;
+#if defined(NOISYSYNTH_SIMD_NEON)
+    float32x4_t peaks = vdupq_n_f32(0.0f);
+    float32x4_t sums = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vld1q_f32(data + i);
+        peaks = vmaxq_f32(peaks, vabsq_f32(v));
+        sums = vmlaq_f32(sums, v, v);
+    }
+    float lanes[4];
+    vst1q_f32(lanes, peaks);
+    maxAbs = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    vst1q_f32(lanes, sums);
+    energy = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(NOISYSYNTH_SIMD_SSE)
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peaks = _mm_setzero_ps();
+    __m128 sums = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(data + i);
+        peaks = _mm_max_ps(peaks, _mm_and_ps(v, signMask));
+        sums = _mm_add_ps(sums, _mm_mul_ps(v, v));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, peaks);
+    maxAbs = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    _mm_storeu_ps(lanes, sums);
+    energy = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < count; ++i) {
+        maxAbs = std::max(maxAbs, std::fabs(data[i]));
+        energy += data[i] * data[i];
+    }
+    *peak = maxAbs;
+    return energy;
+}
+
+} // namespace simd
+
+#endif // NOISYSYNTH_SIMD_H
@@ -0,0 +1,173 @@
+#include "SoftwareAudioBackends.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#define LOG_TAG "NoisySynth"
+#include "Log.h"
+
+using Clock = std::chrono::steady_clock;
+
+bool ThreadedAudioBackend::open(const AudioBackendConfig& config, AudioCallback* callback) {
+    close();
+    if (config.sampleRate < 0 || config.channelCount <= 0 || !callback) {
+        return false;
+    }
+    config_ = config;
+    if (config_.sampleRate == 0) {
+        config_.sampleRate = kSoftwareNativeSampleRate;
+    }
+    if (config_.framesPerBuffer <= 0) {
+        config_.framesPerBuffer = defaultFramesPerBuffer();
+    }
+    callback_ = callback;
+    if (!onOpen()) {
+        callback_ = nullptr;
+        return false;
+    }
+    // Allocated here so the audio thread never does
+    buffer_.assign(static_cast<size_t>(maxFramesPerBuffer()) * config_.channelCount, 0.0f);
+    callback_->onPrepare(static_cast<float>(config_.sampleRate), maxFramesPerBuffer());
+    return true;
+}
+
+bool ThreadedAudioBackend::start() {
+    if (!callback_ || thread_.joinable()) {
+        return false;
+    }
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this] {
+        run();
+        running_.store(false, std::memory_order_release);
+    });
+    return true;
+}
+
+void ThreadedAudioBackend::stop() {
+    running_.store(false, std::memory_order_release);
+    waitUntilFinished();
+}
+
+void ThreadedAudioBackend::close() {
+    stop();
+    if (callback_) {
+        onClose();
+        callback_ = nullptr;
+    }
+}
+
+void ThreadedAudioBackend::waitUntilFinished() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+float* ThreadedAudioBackend::pull(int32_t numFrames) {
+    callback_->onAudioReady(buffer_.data(), numFrames);
+    return buffer_.data();
+}
+
+void NullAudioBackend::run() {
+    auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(config_.framesPerBuffer) / config_.sampleRate));
+    auto next = Clock::now();
+    while (isRunning()) {
+        pull(config_.framesPerBuffer);
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+bool WavFileAudioBackend::onOpen() {
+    framesWritten_.store(0, std::memory_order_relaxed);
+    if (!writer_.open(path_.c_str(), config_.sampleRate, config_.channelCount)) {
+        LOGE("Cannot open %s for writing", path_.c_str());
+        return false;
+    }
+    return true;
+}
+
+void WavFileAudioBackend::onClose() {
+    if (!writer_.close()) {
+        LOGE("Failed to finish %s", path_.c_str());
+    }
+}
+
+void WavFileAudioBackend::run() {
+    auto total = static_cast<uint64_t>(std::llround(durationSeconds_ * config_.sampleRate));
+    uint64_t written = 0;
+    while (isRunning() && written < total) {
+        auto frames = static_cast<int32_t>(std::min<uint64_t>(config_.framesPerBuffer, total - written));
+        if (!writer_.write(pull(frames), frames)) {
+            LOGE("Write to %s failed", path_.c_str());
+            break;
+        }
+        written += frames;
+        framesWritten_.store(written, std::memory_order_relaxed);
+    }
+}
+
+int32_t SimulatedAudioBackend::maxFramesPerBuffer() const {
+    return std::max(device_.maxFramesPerCallback, config_.framesPerBuffer);
+}
+
+bool SimulatedAudioBackend::onOpen() {
+    if (device_.minFramesPerCallback <= 0) {
+        device_.minFramesPerCallback = config_.framesPerBuffer;
+    }
+    device_.maxFramesPerCallback = std::max(device_.maxFramesPerCallback, device_.minFramesPerCallback);
+    device_.bufferCount = std::max(device_.bufferCount, 2);
+    device_.jitterSeconds = std::max(device_.jitterSeconds, 0.0);
+    if (device_.clockRatio <= 0.0) {
+        device_.clockRatio = 1.0;
+    }
+    stats_ = SimulatedDeviceStats();
+    return true;
+}
+
+void SimulatedAudioBackend::run() {
+    // Raw mt19937 output is specified by the standard, distributions are
+    // not, so draws are scaled by hand to replay the same on every toolchain
+    std::mt19937 random(device_.seed);
+    auto unit = [&random] { return random() / 4294967296.0; };
+
+    double deviceRate = config_.sampleRate * device_.clockRatio;
+    int32_t sizeRange = device_.maxFramesPerCallback - device_.minFramesPerCallback + 1;
+    double deviceTime = 0.0;
+    double callbackSeconds = 0.0;
+    auto wallStart = Clock::now();
+
+    while (isRunning() && deviceTime < device_.durationSeconds) {
+        auto frames = device_.minFramesPerCallback + static_cast<int32_t>(unit() * sizeRange);
+        double wakeDelay = unit() * device_.jitterSeconds;
+        double period = frames / deviceRate;
+
+        if (device_.realTime) {
+            std::this_thread::sleep_until(wallStart + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(deviceTime + wakeDelay)));
+        }
+        auto callbackStart = Clock::now();
+        pull(frames);
+        double elapsed = std::chrono::duration<double>(Clock::now() - callbackStart).count();
+
+        // The device asks for a buffer when one has played out; the rest of
+        // the queue is all that plays while this one is late and rendering
+        double headroom = (device_.bufferCount - 1) * period;
+        if (wakeDelay + elapsed > headroom) {
+            stats_.lateCallbacks++;
+        }
+        stats_.callbacks++;
+        stats_.frames += frames;
+        stats_.maxCallbackSeconds = std::max(stats_.maxCallbackSeconds, elapsed);
+        stats_.maxLoad = std::max(stats_.maxLoad, elapsed / period);
+        callbackSeconds += elapsed;
+        deviceTime += period;
+    }
+
+    stats_.wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    stats_.meanCallbackSeconds = stats_.callbacks ? callbackSeconds / stats_.callbacks : 0.0;
+    stats_.outputLatencySeconds = device_.bufferCount * device_.maxFramesPerCallback / deviceRate
+        + device_.jitterSeconds;
+    stats_.realTimeFactor = stats_.wallSeconds > 0.0 ? deviceTime / stats_.wallSeconds : 0.0;
+}
@@ -0,0 +1,147 @@
+#ifndef NOISYSYNTH_SOFTWAREAUDIOBACKENDS_H
+#define NOISYSYNTH_SOFTWAREAUDIOBACKENDS_H
+
+#include "AudioBackend.h"
+#include "WavWriter.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What the software backends report as their native rate
+constexpr int32_t kSoftwareNativeSampleRate = 48000;
+
+/**
+ * Base for backends that run the callback on their own std::thread.
+ * Subclasses implement run(), which returns when isRunning() goes false or
+ * when the backend is done by itself (for example a fixed-length render).
+ * Subclass destructors must call close() so run() never outlives them.
+ */
+class ThreadedAudioBackend : public AudioBackend {
+public:
+    bool open(const AudioBackendConfig& config, AudioCallback* callback) override;
+    bool start() override;
+    void stop() override;
+    void close() override;
+    bool isStarted() const override { return thread_.joinable(); }
+
+    int32_t getSampleRate() const override { return config_.sampleRate; }
+    int32_t getFramesPerBuffer() const override { return config_.framesPerBuffer; }
+
+    // Blocks until run() returns, either by itself or after stop()
+    void waitUntilFinished();
+
+protected:
+    virtual int32_t defaultFramesPerBuffer() const { return 192; }
+    virtual int32_t maxFramesPerBuffer() const { return config_.framesPerBuffer; }
+    virtual bool onOpen() { return true; }
+    virtual void onClose() {}
+    virtual void run() = 0;
+
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Has the callback fill buffer_ with numFrames <= maxFramesPerBuffer()
+    float* pull(int32_t numFrames);
+
+    AudioBackendConfig config_;
+
+private:
+    AudioCallback* callback_ = nullptr;
+    std::vector<float> buffer_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+};
+
+/**
+ * Calls back at the real-time rate and throws the audio away. The default
+ * backend on hosts without an audio device.
+ */
+class NullAudioBackend final : public ThreadedAudioBackend {
+public:
+    ~NullAudioBackend() override { close(); }
+    const char* getName() const override { return "null"; }
+
+protected:
+    void run() override;
+};
+
+/**
+ * Renders durationSeconds of audio as fast as the callback allows and writes
+ * it to a float WAV file.
+ */
+class WavFileAudioBackend final : public ThreadedAudioBackend {
+public:
+    WavFileAudioBackend(std::string path, double durationSeconds)
+        : path_(std::move(path)), durationSeconds_(durationSeconds) {}
+    ~WavFileAudioBackend() override { close(); }
+    const char* getName() const override { return "wav"; }
+
+    uint64_t getFramesWritten() const { return framesWritten_.load(std::memory_order_relaxed); }
+
+protected:
+    int32_t defaultFramesPerBuffer() const override { return 256; }
+    bool onOpen() override;
+    void onClose() override;
+    void run() override;
+
+private:
+    std::string path_;
+    double durationSeconds_;
+    WavWriter writer_;
+    std::atomic<uint64_t> framesWritten_{0};
+};
+
+struct SimulatedDeviceConfig {
+    // Frames per callback, drawn uniformly from [min, max]; 0 = the
+    // AudioBackendConfig buffer size
+    int32_t minFramesPerCallback = 0;
+    int32_t maxFramesPerCallback = 0;
+    int32_t bufferCount = 2;          // device queue depth in callbacks, at least 2
+    double jitterSeconds = 0.0;       // each wakeup is late by up to this much
+    double clockRatio = 1.0;          // device clock / nominal rate, 1.0001 = +100 ppm
+    double durationSeconds = 10.0;    // device time to simulate
+    bool realTime = false;            // false: virtual clock, as fast as possible
+    uint32_t seed = 1;
+};
+
+struct SimulatedDeviceStats {
+    uint64_t callbacks = 0;
+    uint64_t frames = 0;
+    uint64_t lateCallbacks = 0;       // would have been an audible glitch
+    double meanCallbackSeconds = 0.0;
+    double maxCallbackSeconds = 0.0;
+    double maxLoad = 0.0;             // callback time / callback period
+    double outputLatencySeconds = 0.0;
+    double wallSeconds = 0.0;
+    double realTimeFactor = 0.0;      // device seconds rendered per wall second
+};
+
+/**
+ * Simulated output device for reproducing device timing on a host.
+ *
+ * The callback schedule (buffer sizes, wakeup jitter, clock drift) comes
+ * from a seeded generator, so the same config replays the same schedule.
+ * Each callback is timed; it counts as late when wakeup delay plus render
+ * time exceeds the audio still queued in the device. With realTime off the
+ * device clock is virtual and the run takes as long as the rendering.
+ */
+class SimulatedAudioBackend final : public ThreadedAudioBackend {
+public:
+    explicit SimulatedAudioBackend(const SimulatedDeviceConfig& device) : device_(device) {}
+    ~SimulatedAudioBackend() override { close(); }
+    const char* getName() const override { return "simulated"; }
+
+    // Valid once waitUntilFinished() has returned
+    const SimulatedDeviceStats& getStats() const { return stats_; }
+
+protected:
+    int32_t maxFramesPerBuffer() const override;
+    bool onOpen() override;
+    void run() override;
+
+private:
+    SimulatedDeviceConfig device_;
+    SimulatedDeviceStats stats_;
+};
+
+#endif // NOISYSYNTH_SOFTWAREAUDIOBACKENDS_H
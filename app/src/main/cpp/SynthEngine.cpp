@@ -1,24 +1,16 @@
 #include "SynthEngine.h"
-#include <android/log.h>
-#include <cstdlib>
+#include <chrono>
 
 #define LOG_TAG "NoisySynth"
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-
-SynthEngine::SynthEngine() 
-    : currentWaveform_(Waveform::SAWTOOTH),
-      filterCutoff_(0.5f),
-      filterResonance_(0.3f),
-      attack_(0.01f),
-      decay_(0.1f),
-      sustain_(0.7f),
-      release_(0.3f),
-      filterAttack_(0.01f),
-      filterDecay_(0.2f),
-      filterSustain_(0.5f),
-      filterRelease_(0.3f),
-      filterEnvAmount_(0.5f),
+#include "Log.h"
+#include "RtCheck.h"
+
+SynthEngine::SynthEngine(bool startAudio)
+    : SynthEngine(startAudio ? createDefaultAudioBackend() : nullptr) {
+}
+
+SynthEngine::SynthEngine(std::unique_ptr<AudioBackend> backend)
+    : backend_(std::move(backend)),
       delayEnabled_(false),
       delayTime_(0.35f),
       delayFeedback_(0.4f),
@@ -39,86 +31,495 @@ SynthEngine::SynthEngine()
       arpIndex_(0),
       currentArpNote_(-1),
       arpNoteActive_(false),
-      sequencerEnabled_(false),
-      sequencerTempoBpm_(120.0f),
-      sequencerStepLength_(SequencerStepLength::Eighth),
-      sequencerMeasures_(4),
-      sequencerSampleCounter_(0.0f),
-      sequencerCurrentStep_(0),
-      sequencerActiveNote_(-1),
-      sequencerNoteActive_(false) {
+      sequencerEdit_(std::make_unique<SequencerBank>()),
+      sequencerMeasures_(4) {
     
+#if NOISYSYNTH_LOG_LEVEL < NOISYSYNTH_LOG_LEVEL_NONE
+    rtLogAcquire();
+#endif
+
     // Initialize voices
     voices_.resize(kMaxVoices);
+    for (size_t i = 0; i < voices_.size(); ++i) {
+        voices_[i].seedRandom(static_cast<uint32_t>(i + 1));
+    }
+
+    // Held notes are deduplicated MIDI notes, so this never grows on the audio thread
+    heldNotes_.reserve(128);
+
+    parts_[0].enabled = true;
+
+    prepare(kSampleRate, kDefaultMaxBlockSize);
+    if (!backend_) {
+        return;
+    }
     
-    // Create audio stream
-    oboe::AudioStreamBuilder builder;
-    builder.setDirection(oboe::Direction::Output);
-    builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-    builder.setSharingMode(oboe::SharingMode::Exclusive);
-    builder.setFormat(oboe::AudioFormat::Float);
-    builder.setChannelCount(oboe::ChannelCount::Mono);
-    builder.setSampleRate(kSampleRate);
-    builder.setDataCallback(this);
-    
-    oboe::Result result = builder.openStream(stream_);
-    if (result != oboe::Result::OK) {
-        LOGE("Failed to create stream. Error: %s", oboe::convertToText(result));
+    // Ask for the device's own rate so the platform never resamples behind
+    // our back; onPrepare() decides what to do with it
+    AudioBackendConfig config;
+    config.sampleRate = 0;
+    config.channelCount = 1;
+    if (!backend_->open(config, this)) {
+        LOGE("Failed to open %s audio backend", backend_->getName());
         return;
     }
 
-    
-    initializeEffects(stream_->getSampleRate());
-    configureSequenceLength();
-        
-    LOGD("Stream created: SR=%d, BufferSize=%d",
-         stream_->getSampleRate(),
-         stream_->getBufferSizeInFrames());
-    
-    // Start the stream
-    result = stream_->requestStart();
-    if (result != oboe::Result::OK) {
-        LOGE("Failed to start stream. Error: %s", oboe::convertToText(result));
+    if (!backend_->start()) {
+        LOGE("Failed to start %s audio backend", backend_->getName());
     }
 }
 
 SynthEngine::~SynthEngine() {
-    if (stream_) {
-        stream_->close();
+    if (backend_) {
+        backend_->close();
     }
+    stopRenderAheadThread();
+#if NOISYSYNTH_LOG_LEVEL < NOISYSYNTH_LOG_LEVEL_NONE
+    rtLogRelease();
+#endif
 }
 
-oboe::DataCallbackResult SynthEngine::onAudioReady(
-    oboe::AudioStream *audioStream,
-    void *audioData,
-    int32_t numFrames) {
-    
-    float *outputBuffer = static_cast<float *>(audioData);
-    float sampleRate = audioStream->getSampleRate();
-    
+void SynthEngine::prepare(float sampleRate, int32_t maxBlockSize) {
+    // The ahead thread renders too; it must not run while buffers change
+    bool renderAhead = renderThread_.joinable();
+    stopRenderAheadThread();
+    renderMode_.store(static_cast<int>(RenderMode::JustInTime), std::memory_order_seq_cst);
+    handoverPending_ = false;
+    idleFrames_ = 0;
+
+    sampleRate_ = sampleRate;
+    invSampleRate_ = 1.0f / sampleRate;
+    samplesPerMs_ = sampleRate / 1000.0f;
+    maxBlockSize_ = std::max<int32_t>(1, maxBlockSize);
+
+    for (auto& voice : voices_) {
+        voice.prepare(sampleRate);
+    }
+    for (auto& lfo : globalLfos_) {
+        lfo.prepare(sampleRate);
+    }
+    pitchControlGlideTime_ = -1.0f; // glide coefficient depends on the rate
+    initializeEffects(sampleRate);
+    tapVoices_.assign(maxBlockSize_, 0.0f);
+    tapEffects_.assign(maxBlockSize_, 0.0f);
+    if (visualTaps_) {
+        visualTaps_->setSampleRate(sampleRate);
+    }
+    // A loop cached at another rate would play at the wrong speed
+    loopFreeze_.cut(loopFreeze_.getState() == LoopFreezeState::Off ? LoopFreezeState::Off
+                                                                   : LoopFreezeState::Waiting);
+
+    if (renderAhead) {
+        setRenderAheadEnabled(true);
+    }
+    LOGD("Prepared: SR=%.0f, max block=%d", sampleRate, maxBlockSize_);
+}
+
+void SynthEngine::onPrepare(float sampleRate, int32_t maxFramesPerBuffer) {
+    std::lock_guard<std::mutex> guard(prepareLock_);
+    auto deviceRate = static_cast<int32_t>(sampleRate);
+    deviceSampleRate_.store(deviceRate, std::memory_order_relaxed);
+    deviceMaxFrames_ = maxFramesPerBuffer;
+
+    resamplerActive_ = false;
+    if (renderRateMode_ == RenderRateMode::Internal && deviceRate != static_cast<int32_t>(kSampleRate)) {
+        if (resampler_.prepare(static_cast<int32_t>(kSampleRate), deviceRate, maxFramesPerBuffer)) {
+            resamplerInput_.assign(resampler_.getMaxInputFrames(), 0.0f);
+            resamplerActive_ = true;
+        } else {
+            LOGE("No resampler for %d Hz, rendering natively", deviceRate);
+        }
+    }
+
+    if (resamplerActive_) {
+        prepare(kSampleRate, resampler_.getMaxInputFrames());
+    } else {
+        prepare(sampleRate, maxFramesPerBuffer);
+    }
+    resampling_.store(resamplerActive_, std::memory_order_relaxed);
+    resamplerLatency_.store(resamplerActive_ ? resampler_.getLatencySeconds() : 0.0, std::memory_order_relaxed);
+    resamplerLoad_.store(0.0f, std::memory_order_relaxed);
+    resamplerLoadSmoothed_ = 0.0f;
+    LOGD("Device %d Hz, rendering at %.0f Hz%s", deviceRate, sampleRate_,
+         resamplerActive_ ? " + resampler" : "");
+}
+
+void SynthEngine::setRenderRateMode(RenderRateMode mode) {
+    int32_t maxFrames;
+    {
+        // onPrepare() also runs on Oboe's error thread when a device reopens
+        std::lock_guard<std::mutex> guard(prepareLock_);
+        if (mode == renderRateMode_) {
+            return;
+        }
+        renderRateMode_ = mode;
+        maxFrames = deviceMaxFrames_;
+    }
+    if (backend_ && backend_->getSampleRate() > 0) {
+        bool started = backend_->isStarted();
+        backend_->stop();   // waits for the last callback, so nothing renders while preparing
+        onPrepare(static_cast<float>(backend_->getSampleRate()), maxFrames);
+        if (started) {
+            backend_->start();
+        }
+    }
+}
+
+void SynthEngine::onAudioReady(float* output, int32_t numFrames) {
+    RtRenderScope renderScope;
+    TRACE_THREAD_NAME("audio");
+    TRACE_SCOPE(Callback, numFrames);
+    if (!resamplerActive_) {
+        renderForStream(output, numFrames);
+        recordOutput(output, numFrames);
+        return;
+    }
+
+    int32_t inputFrames = resampler_.inputFramesNeeded(numFrames);
+    renderForStream(resamplerInput_.data(), inputFrames);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        TRACE_SCOPE(Resampler, numFrames);
+        resampler_.process(resamplerInput_.data(), output, numFrames);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    float load = static_cast<float>(elapsed.count() * deviceSampleRate_.load(std::memory_order_relaxed) / numFrames);
+    resamplerLoadSmoothed_ += (load - resamplerLoadSmoothed_) * QualityGovernor::kSmoothing;
+    resamplerLoad_.store(resamplerLoadSmoothed_, std::memory_order_relaxed);
+    recordOutput(output, numFrames);
+}
+
+void SynthEngine::recordOutput(const float* output, int32_t numFrames) {
+    if (recorderEnabled_.load(std::memory_order_acquire)) {
+        recorder_->push(output, numFrames);
+    }
+}
+
+void SynthEngine::renderForStream(float* output, int32_t numFrames) {
+    bool live = liveInput_.exchange(false, std::memory_order_acq_rel);
+
+    if (renderMode_.load(std::memory_order_relaxed) == static_cast<int>(RenderMode::Ahead)) {
+        if (!live && renderAheadEnabled_.load(std::memory_order_relaxed)) {
+            size_t read = renderAheadRing_.read(output, numFrames);
+            if (read < static_cast<size_t>(numFrames)) {
+                std::fill(output + read, output + numFrames, 0.0f);
+                renderAheadUnderruns_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+        // Someone is playing: take the engine back from the ahead thread
+        renderMode_.store(static_cast<int>(RenderMode::JustInTime), std::memory_order_seq_cst);
+        handoverPending_ = true;
+    }
+
+    if (handoverPending_) {
+        if (renderThreadBusy_.load(std::memory_order_seq_cst)) {
+            // The ahead thread is finishing a chunk; keep playing what it made
+            size_t read = renderAheadRing_.read(output, numFrames);
+            std::fill(output + read, output + numFrames, 0.0f);
+            return;
+        }
+        finishHandover(output, numFrames);
+        handoverPending_ = false;
+        idleFrames_ = 0;
+        return;
+    }
+
+    auto renderStart = std::chrono::steady_clock::now();
+    render(output, numFrames);
+    std::chrono::duration<double> renderTime = std::chrono::steady_clock::now() - renderStart;
+    updateQualityGovernor(renderTime.count(), numFrames);
+
+    idleFrames_ = live ? 0 : idleFrames_ + numFrames;
+    if (idleFrames_ >= static_cast<int64_t>(kRenderAheadIdleSeconds * sampleRate_)
+        && renderAheadEnabled_.load(std::memory_order_relaxed)
+        && renderThreadRunning_.load(std::memory_order_relaxed)
+        && canRenderAhead()) {
+        startRenderingAhead();
+    }
+}
+
+void SynthEngine::updateQualityGovernor(double renderSeconds, int32_t numFrames) {
+    if (!governorEnabled_.load(std::memory_order_relaxed)) {
+        if (governor_.getTier() != QualityTier::Full) {
+            governor_.reset();
+            applyQualityTier(QualityTier::Full);
+        }
+        return;
+    }
+
+    if (governor_.update(renderSeconds, numFrames / static_cast<double>(sampleRate_))) {
+        applyQualityTier(governor_.getTier());
+    }
+    renderLoad_.store(governor_.getLoad(), std::memory_order_relaxed);
+    peakRenderLoad_.store(governor_.getPeakLoad(), std::memory_order_relaxed);
+}
+
+void SynthEngine::applyQualityTier(QualityTier tier) {
+    const QualitySettings& settings = kQualityTiers[static_cast<int>(tier)];
+
+    voiceLimit_ = std::min(settings.maxVoices, static_cast<int>(voices_.size()));
+    for (size_t i = voiceLimit_; i < voices_.size(); ++i) {
+        // Let notes beyond the limit finish with their release
+        if (voices_[i].isKeyHeld()) {
+            voices_[i].noteOff();
+        }
+    }
+    for (auto& voice : voices_) {
+        voice.getFilter().setCoefficientInterval(settings.filterCoefficientInterval);
+    }
+
+    size_t combs = settings.cheapReverb ? reverbCombs_.size() / 2 : 0;
+    size_t allpasses = settings.cheapReverb ? 1 : 0;
+    if (combs == 0 && reverbActiveCombs_ != 0) {
+        // Combs that sat out still hold old audio; start them from silence
+        for (size_t i = reverbActiveCombs_; i < reverbCombs_.size(); ++i) {
+            std::fill(reverbCombs_[i].buffer.begin(), reverbCombs_[i].buffer.end(), 0.0f);
+            reverbCombs_[i].filterStore = 0.0f;
+        }
+        for (size_t i = reverbActiveAllpasses_; i < reverbAllpasses_.size(); ++i) {
+            std::fill(reverbAllpasses_[i].buffer.begin(), reverbAllpasses_[i].buffer.end(), 0.0f);
+        }
+    }
+    reverbActiveCombs_ = combs;
+    reverbActiveAllpasses_ = allpasses;
+
+    qualityTier_.store(static_cast<int>(tier), std::memory_order_relaxed);
+    // Info, so release builds still show why a device sounds thinner
+    RTLOGI(QualityTier, static_cast<int>(tier), governor_.getLoad());
+}
+
+bool SynthEngine::canRenderAhead() const {
+    // Something has to be generating notes on its own
+    return sequencerEnabled_.load(std::memory_order_relaxed)
+        || midiPlaying_.load(std::memory_order_relaxed)
+        || (arpeggiatorEnabled_ && !heldNotes_.empty());
+}
+
+void SynthEngine::startRenderingAhead() {
+    renderAheadRing_.discard();
+
+    // One chunk covers the callbacks until the ahead thread wakes up
+    render(renderAheadScratch_.data(), kRenderAheadChunkFrames);
+    renderAheadRing_.write(renderAheadScratch_.data(), kRenderAheadChunkFrames);
+
+    renderMode_.store(static_cast<int>(RenderMode::Ahead), std::memory_order_seq_cst);
+    LOGD("Render-ahead: on");
+}
+
+void SynthEngine::finishHandover(float* output, int32_t numFrames) {
+    render(output, numFrames);
+
+    // The engine is ahead of what was heard by the buffered amount; crossfade
+    // from the buffered audio so the jump does not click
+    int32_t fade = std::min(numFrames, kRenderAheadCrossfadeFrames);
+    fade = static_cast<int32_t>(renderAheadRing_.read(renderAheadScratch_.data(), fade));
+    for (int32_t i = 0; i < fade; ++i) {
+        float gain = static_cast<float>(i + 1) / static_cast<float>(fade + 1);
+        output[i] = renderAheadScratch_[i] * (1.0f - gain) + output[i] * gain;
+    }
+    renderAheadRing_.discard();
+    LOGD("Render-ahead: off");
+}
+
+void SynthEngine::renderAheadLoop() {
+    using namespace std::chrono_literals;
+    TRACE_THREAD_NAME("render-ahead");
+
+    while (renderThreadRunning_.load(std::memory_order_acquire)) {
+        // Busy flag first, then the mode: pairs with the callback storing the
+        // mode and then reading the flag, so one of the two always backs off
+        renderThreadBusy_.store(true, std::memory_order_seq_cst);
+        if (renderMode_.load(std::memory_order_seq_cst) != static_cast<int>(RenderMode::Ahead)) {
+            renderThreadBusy_.store(false, std::memory_order_seq_cst);
+            std::this_thread::sleep_for(5ms);
+            continue;
+        }
+
+        size_t depth = static_cast<size_t>(kRenderAheadSeconds * sampleRate_);
+        while (renderAheadRing_.availableToRead() < depth
+               && renderAheadRing_.availableToWrite() >= static_cast<size_t>(kRenderAheadChunkFrames)
+               && renderMode_.load(std::memory_order_seq_cst) == static_cast<int>(RenderMode::Ahead)) {
+            render(renderAheadScratch_.data(), kRenderAheadChunkFrames);
+            renderAheadRing_.write(renderAheadScratch_.data(), kRenderAheadChunkFrames);
+        }
+
+        renderThreadBusy_.store(false, std::memory_order_seq_cst);
+        std::this_thread::sleep_for(2ms);
+    }
+}
+
+void SynthEngine::setRenderAheadEnabled(bool enabled) {
+    renderAheadEnabled_.store(enabled, std::memory_order_release);
+    if (enabled && !renderThread_.joinable()) {
+        renderThreadRunning_.store(true, std::memory_order_release);
+        renderThread_ = std::thread(&SynthEngine::renderAheadLoop, this);
+    } else if (!enabled) {
+        // The callback notices the flag and takes the engine back
+        stopRenderAheadThread();
+    }
+}
+
+void SynthEngine::stopRenderAheadThread() {
+    renderThreadRunning_.store(false, std::memory_order_release);
+    if (renderThread_.joinable()) {
+        renderThread_.join();
+    }
+}
+
+bool SynthEngine::commitControlEvents(uint32_t writeIndex) {
+    // A live note means someone is playing along: leave render-ahead. Knob
+    // moves stay ahead, since each exit skips the buffered part of the sequence.
+    uint32_t from = controlRing_.publishedIndex();
+    if (writeIndex - from <= controlRing_.capacity()) {
+        for (uint32_t index = from; index != writeIndex; ++index) {
+            auto type = static_cast<ControlEventType>(controlRing_.eventAt(index).type);
+            if (type == ControlEventType::NoteOn || type == ControlEventType::PartNoteOn) {
+                liveInput_.store(true, std::memory_order_release);
+                break;
+            }
+        }
+    }
+    return controlRing_.publish(writeIndex);
+}
+
+void SynthEngine::render(float* output, int32_t numFrames) {
+    RtRenderScope renderScope;
+    // Nothing below ever sees more than the prepared block size
+    while (numFrames > maxBlockSize_) {
+        renderBlock(output, maxBlockSize_);
+        output += maxBlockSize_;
+        numFrames -= maxBlockSize_;
+    }
+    renderBlock(output, numFrames);
+}
+
+void SynthEngine::renderBlock(float* output, int32_t numFrames) {
+    TRACE_SCOPE(Block, numFrames);
+    traceStages_.begin();
+
     // Clear output buffer
-    std::fill_n(outputBuffer, numFrames, 0.0f);
-    
-    // CRITICAL FIX: Process arpeggiator/sequencer ONCE per buffer, not per sample!
+    std::fill_n(output, numFrames, 0.0f);
+
+    // Apply everything the UI committed since the last callback
+    processControlEvents();
+    // Once per block, so steps and synced LFOs agree on it for the whole block
+    sequencerTempoBpm_ = sequencerTempo_.load(std::memory_order_relaxed);
+    processTuningUpdate();
+    processMidiTransport();
+    processSequencerTransport();
+    processLoopFreeze();
+    visualTapping_ = visualTapsEnabled_.load(std::memory_order_acquire);
+    traceStages_.lap(TraceStage::Control);
+
+    // CRITICAL FIX: Process arpeggiator ONCE per buffer, not per sample!
     // This prevents timing chaos and stuck notes
-    processSequencer(sampleRate, numFrames);
-    if (!sequencerEnabled_) {
-        processArpeggiator(sampleRate, numFrames);
+    if (!sequencerRunning_) {
+        processArpeggiator(numFrames);
+        traceStages_.lap(TraceStage::Arpeggiator);
     }
-    
-    // Process each frame
-    for (int32_t i = 0; i < numFrames; i++) {
+
+    // MIDI file and sequencer events split the block so each lands on its
+    // exact sample
+    int32_t frame = 0;
+    while (frame < numFrames) {
+        int32_t segmentEnd = processMidiEvents(frame, numFrames);
+        segmentEnd = std::min(segmentEnd, processSequencerEvents(frame, numFrames));
+        traceStages_.lap(TraceStage::Events);
+        renderFrames(output, frame, segmentEnd);
+        frame = segmentEnd;
+    }
+    if (midiPlaying_.load(std::memory_order_relaxed)) {
+        midiPosition_ += numFrames;
+    }
+    if (sequencerRunning_) {
+        sequencerPosition_ += numFrames;
+    }
+
+    if (visualTapping_) {
+        const float* taps[kVisualTapCount] = {tapVoices_.data(), tapEffects_.data(), output};
+        visualTaps_->write(taps, numFrames);
+        traceStages_.lap(TraceStage::Taps);
+    }
+    traceStages_.end(numFrames);
+}
+
+// One render loop per combination of routed voice destinations, picked once
+// per block segment, so unused routes cost nothing inside the sample loop
+const SynthEngine::RenderKernel SynthEngine::kRenderKernels[kVoiceModKernelCount] = {
+    &SynthEngine::renderFramesKernel<0>,  &SynthEngine::renderFramesKernel<1>,
+    &SynthEngine::renderFramesKernel<2>,  &SynthEngine::renderFramesKernel<3>,
+    &SynthEngine::renderFramesKernel<4>,  &SynthEngine::renderFramesKernel<5>,
+    &SynthEngine::renderFramesKernel<6>,  &SynthEngine::renderFramesKernel<7>,
+    &SynthEngine::renderFramesKernel<8>,  &SynthEngine::renderFramesKernel<9>,
+    &SynthEngine::renderFramesKernel<10>, &SynthEngine::renderFramesKernel<11>,
+    &SynthEngine::renderFramesKernel<12>, &SynthEngine::renderFramesKernel<13>,
+    &SynthEngine::renderFramesKernel<14>, &SynthEngine::renderFramesKernel<15>,
+};
+
+void SynthEngine::renderFrames(float* output, int32_t start, int32_t end) {
+    if (modMatrix_.getRouting().globalMask == 0) {
+        delayMixMod_ = 0.0f;
+        chorusDepthMod_ = 0.0f;
+        reverbMixMod_ = 0.0f;
+    }
+    (this->*kRenderKernels[modMatrix_.getRouting().voiceMask])(output, start, end);
+}
+
+template <uint32_t VoiceModMask>
+void SynthEngine::renderFramesKernel(float* output, int32_t start, int32_t end) {
+    const ModRouting& routing = modMatrix_.getRouting();
+    LfoFrame lfoFrame;
+    lfoFrame.perVoiceMask = perVoiceLfoMask_;
+    lfoFrame.lfo1Amount = lfoAmount_;
+    const bool freezing = loopFreeze_.isProcessing();
+    float* tapVoices = visualTapping_ ? tapVoices_.data() : nullptr;
+    float* tapEffects = visualTapping_ ? tapEffects_.data() : nullptr;
+
+    for (int32_t i = start; i < end; i++) {
         float sample = 0.0f;
- 
-        // Generate LFO value
-        float lfoValue = lfo_.process(sampleRate);
+
+        // LFOs are evaluated at control rate and interpolated per sample
+        if (controlCountdown_ <= 0) {
+            processControlTick();
+            controlCountdown_ = kControlRateInterval;
+        }
+        controlCountdown_--;
+        for (int l = 0; l < kNumLfos; ++l) {
+            lfoFrame.globalValues[l] = globalLfos_[l].next();
+        }
+
+        // Global destinations only see global sources
+        if (routing.globalMask != 0) {
+            float sources[kModSourceCount] = {};
+            sources[static_cast<int>(ModSource::Lfo)] = lfoFrame.globalValues[0];
+            sources[static_cast<int>(ModSource::Lfo2)] = lfoFrame.globalValues[1];
+            sources[static_cast<int>(ModSource::Lfo3)] = lfoFrame.globalValues[2];
+            sources[static_cast<int>(ModSource::Lfo4)] = lfoFrame.globalValues[3];
+            delayMixMod_ = routing.evaluate(ModDestination::DelayMix, sources);
+            chorusDepthMod_ = routing.evaluate(ModDestination::ChorusDepth, sources);
+            reverbMixMod_ = routing.evaluate(ModDestination::ReverbMix, sources);
+        }
+        traceStages_.lap(TraceStage::Modulation);
         
-        // Mix all active voices
+        // Mix all active voices, per part when parts need their own gains
         int activeVoices = 0;
-        for (auto& voice : voices_) {
-            if (voice.isActive()) {
-                sample += voice.process(sampleRate, lfoValue);
-                activeVoices++;
+        float partSums[kMaxParts];
+        if (partMixing_) {
+            std::fill_n(partSums, partCount_, 0.0f);
+            for (auto& voice : voices_) {
+                if (voice.isActive()) {
+                    partSums[voice.getPart()] += voice.processKernel<VoiceModMask>(lfoFrame, routing);
+                    activeVoices++;
+                }
+            }
+        } else {
+            for (auto& voice : voices_) {
+                if (voice.isActive()) {
+                    sample += voice.processKernel<VoiceModMask>(lfoFrame, routing);
+                    activeVoices++;
+                }
             }
         }
         
@@ -132,14 +533,62 @@ oboe::DataCallbackResult SynthEngine::onAudioReady(
         const float smoothing = 0.001f;  // ~10–20 ms depending on buffer size
         polyGain_ += smoothing * (targetPolyGain - polyGain_);
         
-        sample *= polyGain_;
-
+        if (partMixing_) {
+            // Each stage only processes what the parts send it; the rest of
+            // their dry signal goes around it. dryGains tracks how much of
+            // each part's dry signal is still in the bus.
+            float dryScale = polyGain_;
+            if (freezing) {
+                // The cache holds each part's dry signal after the poly gain
+                for (int p = 0; p < partCount_; ++p) {
+                    partSums[p] *= polyGain_;
+                }
+                loopFreeze_.process(partSums, partCount_);
+                dryScale = 1.0f;
+            }
+            float dryGains[kMaxParts];
+            for (int p = 0; p < partCount_; ++p) {
+                dryGains[p] = parts_[p].level * dryScale;
+                sample += partSums[p] * dryGains[p];
+            }
+            if (tapVoices) {
+                tapVoices[i] = sample;
+            }
+            traceStages_.lap(TraceStage::Voices);
+            float chorusMix = (chorusEnabled_ && !chorusBuffer_.empty()) ? chorusMix_ : 0.0f;
+            float delayMix = delayEnabled_ ? std::max(0.0f, std::min(1.0f, delayMix_ + delayMixMod_)) : 0.0f;
+            float bypass = mixPartSend(PartSend::Chorus, chorusMix, partSums, dryGains);
+            sample = bypass + processChorus(sample - bypass);
+            traceStages_.lap(TraceStage::Chorus);
+            bypass = mixPartSend(PartSend::Delay, delayMix, partSums, dryGains);
+            sample = bypass + processDelay(sample - bypass);
+            traceStages_.lap(TraceStage::Delay);
+            float reverbMix = reverbEnabled_ ? std::max(0.0f, std::min(1.0f, reverbMix_ + reverbMixMod_)) : 0.0f;
+            bypass = mixPartSend(PartSend::Reverb, reverbMix, partSums, dryGains);
+            sample = bypass + processReverb(sample - bypass);
+            traceStages_.lap(TraceStage::Reverb);
+        } else {
+            sample *= polyGain_;
+            if (freezing) {
+                loopFreeze_.process(&sample, 1);
+            }
+            if (tapVoices) {
+                tapVoices[i] = sample;
+            }
+            traceStages_.lap(TraceStage::Voices);
+
+            // Apply modulation effects
+            sample = processChorus(sample);
+            traceStages_.lap(TraceStage::Chorus);
+            sample = processDelay(sample);
+            traceStages_.lap(TraceStage::Delay);
+            sample = processReverb(sample);
+            traceStages_.lap(TraceStage::Reverb);
+        }
 
-        
-        // Apply modulation effects
-        sample = processChorus(sample, sampleRate);
-        sample = processDelay(sample, sampleRate);
-        sample = processReverb(sample, sampleRate);
+        if (tapEffects) {
+            tapEffects[i] = sample;
+        }
 
         // Apply master headroom and gentle limiting
         sample *= outputGain_;
@@ -156,13 +605,41 @@ oboe::DataCallbackResult SynthEngine::onAudioReady(
         // Final limiting
         sample = std::max(-1.0f, std::min(1.0f, sample));
         
-        outputBuffer[i] = sample;
+        output[i] = sample;
+        traceStages_.lap(TraceStage::Master);
     }
-    
-    return oboe::DataCallbackResult::Continue;
 }
 
-void SynthEngine::noteOn(int midiNote) {
+void SynthEngine::processControlTick() {
+    // The sequencer tempo is the engine tempo for synced LFOs
+    for (int l = 0; l < kNumLfos; ++l) {
+        globalLfos_[l].controlTick(lfoSettings_[l].shape, lfoSettings_[l].cycleHz(sequencerTempoBpm_));
+    }
+
+    // Bend ratio and glide coefficient only change with their inputs
+    if (pitchBend_ != pitchControlBend_) {
+        pitchControlBend_ = pitchBend_;
+        pitchControl_.bendRatio = std::exp2(pitchBend_ / 12.0f);
+    }
+    if (glideTime_ != pitchControlGlideTime_) {
+        pitchControlGlideTime_ = glideTime_;
+        pitchControl_.glideCoeff = (glideTime_ > 0.0f)
+            ? 1.0f - std::exp(-kControlRateInterval / (glideTime_ * sampleRate_))
+            : 1.0f;
+    }
+
+    for (auto& voice : voices_) {
+        if (voice.isActive()) {
+            voice.controlTick(lfoSettings_, perVoiceLfoMask_, sequencerTempoBpm_, pitchControl_);
+        }
+    }
+}
+
+void SynthEngine::noteOn(int midiNote, float velocity) {
+    noteOnRouted(midiNote, velocity, -1);
+}
+
+void SynthEngine::noteOnRouted(int midiNote, float velocity, int channel) {
     if (arpeggiatorEnabled_ && !suppressArpCapture_) {
         if (std::find(heldNotes_.begin(), heldNotes_.end(), midiNote) == heldNotes_.end()) {
             heldNotes_.push_back(midiNote);
@@ -170,319 +647,1225 @@ void SynthEngine::noteOn(int midiNote) {
         return;
     }
 
-    // First check if this note is already playing
-    Voice* existingVoice = findVoiceForNote(midiNote);
+    uint32_t parts = routeNote(midiNote, channel);
+    for (int part = 0; part < partCount_; ++part) {
+        if (parts & (1u << part)) {
+            startPartVoice(part, midiNote, velocity);
+        }
+    }
+}
+
+void SynthEngine::partNoteOn(int part, int midiNote, float velocity) {
+    if (part < 0 || part >= kMaxParts || !parts_[part].enabled || midiNote < 0 || midiNote > 127) {
+        return;
+    }
+    startPartVoice(part, midiNote, velocity);
+}
+
+void SynthEngine::startPartVoice(int part, int midiNote, float velocity) {
+    Part& target = parts_[part];
+    const TuningTable& tuning = tuningTables_[tuningActiveTable_.load(std::memory_order_relaxed)];
+    int glideFrom = (glideTime_ > 0.0f) ? target.glideFromNote : -1;
+    target.glideFromNote = midiNote;
+    noteParts_[midiNote] |= static_cast<uint8_t>(1u << part);
+
+    // First check if this note is already playing on this part
+    Voice* existingVoice = findVoiceForNote(part, midiNote);
     if (existingVoice) {
         // Retrigger the existing voice
-        existingVoice->noteOn(midiNote, currentWaveform_);
-        existingVoice->getAmpEnvelope().setAttack(attack_);
-        existingVoice->getAmpEnvelope().setDecay(decay_);
-        existingVoice->getAmpEnvelope().setSustain(sustain_);
-        existingVoice->getAmpEnvelope().setRelease(release_);
-        existingVoice->getFilterEnvelope().setAttack(filterAttack_);
-        existingVoice->getFilterEnvelope().setDecay(filterDecay_);
-        existingVoice->getFilterEnvelope().setSustain(filterSustain_);
-        existingVoice->getFilterEnvelope().setRelease(filterRelease_);
-        existingVoice->setFilterEnvelopeAmount(filterEnvAmount_);
-        existingVoice->getFilter().setCutoff(filterCutoff_);
-        existingVoice->getFilter().setResonance(filterResonance_);
-        LOGD("Note RETRIGGER: %d", midiNote);
+        existingVoice->noteOn(midiNote, target.patch.waveform, velocity, tuning);
+        existingVoice->applyPatch(target.patch);
+        RTLOGD(NoteRetrigger, midiNote, part);
         return;
     }
     
-    // Find a free voice
+    // Find a free voice in the shared pool
     Voice* voice = findFreeVoice();
     if (voice) {
-        voice->noteOn(midiNote, currentWaveform_);
-        voice->getAmpEnvelope().setAttack(attack_);
-        voice->getAmpEnvelope().setDecay(decay_);
-        voice->getAmpEnvelope().setSustain(sustain_);
-        voice->getAmpEnvelope().setRelease(release_);
-        voice->getFilterEnvelope().setAttack(filterAttack_);
-        voice->getFilterEnvelope().setDecay(filterDecay_);
-        voice->getFilterEnvelope().setSustain(filterSustain_);
-        voice->getFilterEnvelope().setRelease(filterRelease_);
-        voice->setFilterEnvelopeAmount(filterEnvAmount_);
-        voice->getFilter().setCutoff(filterCutoff_);
-        voice->getFilter().setResonance(filterResonance_);
-        LOGD("Note ON: %d", midiNote);
+        voice->setPart(part);
+        voice->noteOn(midiNote, target.patch.waveform, velocity, tuning, glideFrom);
+        voice->applyPatch(target.patch);
+        RTLOGD(NoteOn, midiNote, part);
     } else {
-        LOGD("No free voice for note: %d", midiNote);
+        RTLOGD(NoFreeVoice, midiNote);
     }
 }
 
 void SynthEngine::noteOff(int midiNote) {
+    noteOffRouted(midiNote, -1);
+}
+
+void SynthEngine::noteOffRouted(int midiNote, int channel) {
     if (arpeggiatorEnabled_ && !suppressArpCapture_) {
         heldNotes_.erase(std::remove(heldNotes_.begin(), heldNotes_.end(), midiNote), heldNotes_.end());
         if (midiNote == currentArpNote_ && arpNoteActive_) {
-            Voice* voice = findVoiceForNote(midiNote);
+            releaseNote(midiNote, ~0u);
+            arpNoteActive_ = false;
+            currentArpNote_ = -1;
+        }
+        return;
+    }
+
+    // Parts on other channels keep their notes; key ranges do not matter here
+    uint32_t parts = 0;
+    for (int part = 0; part < kMaxParts; ++part) {
+        if (channel < 0 || parts_[part].midiChannel < 0 || parts_[part].midiChannel == channel) {
+            parts |= 1u << part;
+        }
+    }
+    releaseNote(midiNote, parts);
+}
+
+void SynthEngine::partNoteOff(int part, int midiNote) {
+    if (part < 0 || part >= kMaxParts) {
+        return;
+    }
+    releaseNote(midiNote, 1u << part);
+}
+
+void SynthEngine::releaseNote(int midiNote, uint32_t parts) {
+    if (midiNote < 0 || midiNote > 127) {
+        return;
+    }
+    // Only the parts the note was started on, whatever the key ranges are now
+    uint32_t started = noteParts_[midiNote] & parts;
+    for (int part = 0; part < kMaxParts; ++part) {
+        if (started & (1u << part)) {
+            Voice* voice = findVoiceForNote(part, midiNote);
             if (voice) {
                 voice->noteOff();
+                RTLOGD(NoteOff, midiNote, part);
             }
-            arpNoteActive_ = false;
-            currentArpNote_ = -1;
         }
+    }
+    noteParts_[midiNote] &= static_cast<uint8_t>(~started);
+}
+
+uint32_t SynthEngine::routeNote(int midiNote, int channel) const {
+    uint32_t parts = 0;
+    for (int part = 0; part < partCount_; ++part) {
+        const Part& candidate = parts_[part];
+        if (candidate.enabled
+            && midiNote >= candidate.lowNote && midiNote <= candidate.highNote
+            && (channel < 0 || candidate.midiChannel < 0 || candidate.midiChannel == channel)) {
+            parts |= 1u << part;
+        }
+    }
+    return parts;
+}
+
+void SynthEngine::setWaveform(int waveform) {
+    setPartParameter(0, ParamId::Waveform, static_cast<float>(waveform));
+    RTLOGD(Waveform, waveform);
+}
+
+void SynthEngine::setFilterCutoff(float cutoff) {
+    setPartParameter(0, ParamId::FilterCutoff, cutoff);
+}
+
+void SynthEngine::setFilterResonance(float resonance) {
+    setPartParameter(0, ParamId::FilterResonance, resonance);
+}
+
+void SynthEngine::setAttack(float attack) {
+    setPartParameter(0, ParamId::Attack, attack);
+}
+
+void SynthEngine::setDecay(float decay) {
+    setPartParameter(0, ParamId::Decay, decay);
+}
+
+void SynthEngine::setSustain(float sustain) {
+    setPartParameter(0, ParamId::Sustain, sustain);
+}
+
+void SynthEngine::setRelease(float release) {
+    setPartParameter(0, ParamId::Release, release);
+}
+
+void SynthEngine::setFilterAttack(float attack) {
+    setPartParameter(0, ParamId::FilterAttack, attack);
+}
+
+void SynthEngine::setFilterDecay(float decay) {
+    setPartParameter(0, ParamId::FilterDecay, decay);
+}
+
+void SynthEngine::setFilterSustain(float sustain) {
+    setPartParameter(0, ParamId::FilterSustain, sustain);
+}
+
+void SynthEngine::setFilterRelease(float release) {
+    setPartParameter(0, ParamId::FilterRelease, release);
+}
+
+void SynthEngine::setFilterEnvelopeAmount(float amount) {
+    setPartParameter(0, ParamId::FilterEnvAmount, amount);
+}
+
+void SynthEngine::setPartParameter(int part, ParamId id, float value) {
+    invalidateLoopFreeze();
+    applyPartParameter(part, id, value);
+}
+
+void SynthEngine::applyPartParameter(int part, ParamId id, float value) {
+    if (part < 0 || part >= kMaxParts) {
         return;
     }
+    PartPatch& patch = parts_[part].patch;
+    switch (id) {
+        case ParamId::Waveform:
+            // Sounding notes keep their waveform
+            patch.waveform = static_cast<Waveform>(value);
+            return;
+        case ParamId::FilterCutoff:    patch.filterCutoff = value; break;
+        case ParamId::FilterResonance: patch.filterResonance = value; break;
+        case ParamId::Attack:          patch.attack = value; break;
+        case ParamId::Decay:           patch.decay = value; break;
+        case ParamId::Sustain:         patch.sustain = value; break;
+        case ParamId::Release:         patch.release = value; break;
+        case ParamId::FilterAttack:    patch.filterAttack = value; break;
+        case ParamId::FilterDecay:     patch.filterDecay = value; break;
+        case ParamId::FilterSustain:   patch.filterSustain = value; break;
+        case ParamId::FilterRelease:   patch.filterRelease = value; break;
+        case ParamId::FilterEnvAmount: patch.filterEnvAmount = value; break;
+        default:                       return;   // engine-wide parameter
+    }
+    for (auto& voice : voices_) {
+        if (voice.getPart() == part) {
+            voice.applyPatch(patch);
+        }
+    }
+}
 
-    Voice* voice = findVoiceForNote(midiNote);
-    if (voice) {
-        voice->noteOff();
-        LOGD("Note OFF: %d", midiNote);
+float SynthEngine::getPartParameter(int part, ParamId id) const {
+    if (part < 0 || part >= kMaxParts) {
+        return 0.0f;
+    }
+    const PartPatch& patch = parts_[part].patch;
+    switch (id) {
+        case ParamId::Waveform:        return static_cast<float>(patch.waveform);
+        case ParamId::FilterCutoff:    return patch.filterCutoff;
+        case ParamId::FilterResonance: return patch.filterResonance;
+        case ParamId::Attack:          return patch.attack;
+        case ParamId::Decay:           return patch.decay;
+        case ParamId::Sustain:         return patch.sustain;
+        case ParamId::Release:         return patch.release;
+        case ParamId::FilterAttack:    return patch.filterAttack;
+        case ParamId::FilterDecay:     return patch.filterDecay;
+        case ParamId::FilterSustain:   return patch.filterSustain;
+        case ParamId::FilterRelease:   return patch.filterRelease;
+        case ParamId::FilterEnvAmount: return patch.filterEnvAmount;
+        default:                       return 0.0f;
+    }
+}
+
+void SynthEngine::setPartPatch(int part, const SynthParams& params) {
+    for (int id = static_cast<int>(ParamId::Waveform); id <= static_cast<int>(ParamId::FilterEnvAmount); ++id) {
+        setPartParameter(part, static_cast<ParamId>(id), params.values[id]);
+    }
+}
+
+bool SynthEngine::applyPartPreset(int part, int index) {
+    SynthParams params;
+    if (!getPresetParams(index, params)) {
+        return false;
+    }
+    setPartPatch(part, params);
+    return true;
+}
+
+void SynthEngine::setPartEnabled(int part, bool enabled) {
+    // Part 0 is the engine's own patch and always plays
+    if (part <= 0 || part >= kMaxParts || parts_[part].enabled == enabled) {
+        return;
+    }
+    parts_[part].enabled = enabled;
+    invalidateLoopFreeze();
+    if (!enabled) {
+        for (int note = 0; note < 128; ++note) {
+            releaseNote(note, 1u << part);
+        }
+    }
+    updatePartMixing();
+}
+
+bool SynthEngine::isPartEnabled(int part) const {
+    return part >= 0 && part < kMaxParts && parts_[part].enabled;
+}
+
+void SynthEngine::setPartKeyRange(int part, int lowNote, int highNote) {
+    if (part < 0 || part >= kMaxParts) {
+        return;
+    }
+    invalidateLoopFreeze();
+    parts_[part].lowNote = std::max(0, std::min(127, lowNote));
+    parts_[part].highNote = std::max(0, std::min(127, highNote));
+}
+
+void SynthEngine::setPartMidiChannel(int part, int channel) {
+    if (part < 0 || part >= kMaxParts) {
+        return;
+    }
+    invalidateLoopFreeze();
+    parts_[part].midiChannel = (channel < 0) ? -1 : std::min(15, channel);
+}
+
+void SynthEngine::setPartLevel(int part, float level) {
+    if (part < 0 || part >= kMaxParts) {
+        return;
+    }
+    parts_[part].level = std::max(0.0f, std::min(2.0f, level));
+    updatePartMixing();
+}
+
+void SynthEngine::setPartSend(int part, PartSend send, float level) {
+    int index = static_cast<int>(send);
+    if (part < 0 || part >= kMaxParts || index < 0 || index >= kPartSendCount) {
+        return;
+    }
+    parts_[part].sends[index] = std::max(0.0f, std::min(1.0f, level));
+    updatePartMixing();
+}
+
+void SynthEngine::updatePartMixing() {
+    // Disabled parts stay in the mix until their voices have rung out
+    int count = 1;
+    for (int part = 0; part < kMaxParts; ++part) {
+        if (parts_[part].enabled) {
+            count = part + 1;
+        }
+    }
+    for (const auto& voice : voices_) {
+        if (voice.isActive()) {
+            count = std::max(count, voice.getPart() + 1);
+        }
+    }
+    partCount_ = count;
+
+    const Part& first = parts_[0];
+    partMixing_ = partCount_ > 1 || first.level != 1.0f
+        || std::any_of(std::begin(first.sends), std::end(first.sends), [](float send) { return send != 1.0f; });
+}
+
+// Returns the dry signal of what skips this stage and lowers the remaining
+// dry gain of what goes through it by the stage's mix
+float SynthEngine::mixPartSend(PartSend send, float effectMix, const float* partSums, float* dryGains) const {
+    float bypass = 0.0f;
+    for (int p = 0; p < partCount_; ++p) {
+        float amount = parts_[p].sends[static_cast<int>(send)];
+        bypass += partSums[p] * dryGains[p] * (1.0f - amount);
+        dryGains[p] *= 1.0f - amount * effectMix;
+    }
+    return bypass;
+}
+
+void SynthEngine::setLFORate(float rate) {
+    setLfoRate(0, rate);
+}
+
+void SynthEngine::setLFOAmount(float amount) {
+    lfoAmount_ = std::max(0.0f, std::min(1.0f, amount));
+}
+
+void SynthEngine::setLfoRate(int lfo, float rate) {
+    if (lfo < 0 || lfo >= kNumLfos) return;
+    lfoSettings_[lfo].rate = std::max(0.1f, rate);
+}
+
+void SynthEngine::setLfoShape(int lfo, int shape) {
+    if (lfo < 0 || lfo >= kNumLfos) return;
+    lfoSettings_[lfo].shape = static_cast<LfoShape>(std::max(0, std::min(4, shape)));
+}
+
+void SynthEngine::setLfoSync(int lfo, int division) {
+    if (lfo < 0 || lfo >= kNumLfos) return;
+    lfoSettings_[lfo].syncDivision = std::max(0, std::min(kLfoSyncDivisions - 1, division));
+}
+
+void SynthEngine::setGlideTime(float seconds) {
+    glideTime_ = std::max(0.0f, std::min(5.0f, seconds));
+}
+
+void SynthEngine::setPitchBendRange(float semitones) {
+    pitchBendRange_ = std::max(0.0f, std::min(24.0f, semitones));
+}
+
+void SynthEngine::setPitchBend(float bend) {
+    // Stored in semitones so a range change alone does not move held notes
+    invalidateLoopFreeze();
+    pitchBend_ = std::max(-1.0f, std::min(1.0f, bend)) * pitchBendRange_;
+}
+
+void SynthEngine::setNoteExpression(int midiNote, NoteExpression lane, float value) {
+    if (lane == NoteExpression::PitchBend) {
+        value = std::max(-48.0f, std::min(48.0f, value));
+    } else {
+        value = std::max(0.0f, std::min(1.0f, value));
+    }
+    // Every part layered on the note follows it
+    for (auto& voice : voices_) {
+        if (voice.getMidiNote() == midiNote && voice.isKeyHeld()) {
+            voice.setExpression(lane, value);
+        }
+    }
+}
+
+void SynthEngine::setLfoPerVoice(int lfo, bool perVoice) {
+    if (lfo < 0 || lfo >= kNumLfos) return;
+    lfoSettings_[lfo].perVoice = perVoice;
+    if (perVoice) {
+        perVoiceLfoMask_ |= (1u << lfo);
+    } else {
+        perVoiceLfoMask_ &= ~(1u << lfo);
+    }
+}
+
+void SynthEngine::setDelayEnabled(bool enabled) {
+    delayEnabled_ = enabled;
+}
+
+void SynthEngine::setDelayTime(float time) {
+    delayTime_ = std::max(0.0f, time);
+}
+
+void SynthEngine::setDelayFeedback(float feedback) {
+    delayFeedback_ = std::max(0.0f, std::min(0.99f, feedback));
+}
+
+void SynthEngine::setDelayMix(float mix) {
+    delayMix_ = std::max(0.0f, std::min(1.0f, mix));
+}
+
+void SynthEngine::setChorusEnabled(bool enabled) {
+    chorusEnabled_ = enabled;
+}
+
+void SynthEngine::setChorusRate(float rate) {
+    chorusRate_ = std::max(0.0f, rate);
+}
+
+void SynthEngine::setChorusDepth(float depth) {
+    chorusDepth_ = std::max(0.0f, std::min(1.0f, depth));
+}
+
+void SynthEngine::setChorusMix(float mix) {
+    chorusMix_ = std::max(0.0f, std::min(1.0f, mix));
+}
+
+void SynthEngine::setReverbEnabled(bool enabled) {
+    reverbEnabled_ = enabled;
+}
+
+void SynthEngine::setReverbSize(float size) {
+    reverbSize_ = std::max(0.0f, std::min(1.0f, size));
+}
+
+void SynthEngine::setReverbDamping(float damping) {
+    reverbDamping_ = std::max(0.0f, std::min(1.0f, damping));
+}
+
+void SynthEngine::setReverbMix(float mix) {
+    reverbMix_ = std::max(0.0f, std::min(1.0f, mix));
+}
+
+void SynthEngine::setArpeggiatorEnabled(bool enabled) {
+    if (!enabled && arpeggiatorEnabled_ && arpNoteActive_) {
+        // Turn off any active arp note when disabling
+        suppressArpCapture_ = true;
+        noteOff(currentArpNote_);
+        suppressArpCapture_ = false;
+    }
+
+    arpeggiatorEnabled_ = enabled;
+
+    if (!enabled) {
+        // Reset arp state completely when disabling
+        heldNotes_.clear();
+        arpSampleCounter_ = 0.0f;
+        arpIndex_ = 0;
+        arpNoteActive_ = false;
+        arpStepStarted_ = false;
+        currentArpNote_ = -1;
+    } else {
+        // When enabling, start from a clean step boundary
+        arpSampleCounter_ = 0.0f;
+        arpIndex_ = 0;
+        arpNoteActive_ = false;
+        arpStepStarted_ = false;
+        currentArpNote_ = -1;
+    }
+}
+
+
+void SynthEngine::setArpeggiatorPattern(int pattern) {
+    arpeggiatorPattern_ = std::max(0, std::min(3, pattern));
+}
+
+void SynthEngine::setArpeggiatorRate(float bpm) {
+    arpeggiatorRateBpm_ = std::max(20.0f, bpm);
+}
+
+void SynthEngine::setArpeggiatorGate(float gate) {
+    arpeggiatorGate_ = std::max(0.05f, std::min(1.0f, gate));
+}
+
+void SynthEngine::setArpeggiatorSubdivision(int subdivision) {
+    int clamped = std::max(0, std::min(3, subdivision));
+    arpeggiatorSubdivision_ = clamped;
+    switch (clamped) {
+        case 0:
+            arpeggiatorStepMultiplier_ = 2.0f;
+            break;
+        case 2:
+            arpeggiatorStepMultiplier_ = 0.5f;
+            break;
+        case 3:
+            arpeggiatorStepMultiplier_ = 0.25f;
+            break;
+        case 1:
+        default:
+            arpeggiatorStepMultiplier_ = 1.0f;
+            break;
+    }
+}
+
+void SynthEngine::setSequencerEnabled(bool enabled) {
+    // The audio thread sees the change at its next block, releases what the
+    // sequencer was playing and starts again from the first step
+    sequencerEnabled_.store(enabled, std::memory_order_release);
+}
+
+void SynthEngine::setSequencerTempo(float bpm) {
+    invalidateLoopFreeze();
+    sequencerTempo_.store(std::max(kSequencerMinTempo, std::min(kSequencerMaxTempo, bpm)),
+                          std::memory_order_relaxed);
+}
+
+void SynthEngine::publishSequencer() {
+    sequencerBank_.publish(*sequencerEdit_);
+}
+
+SequencerPattern* SynthEngine::editSequencerPattern(int pattern) {
+    if (pattern < 0 || pattern >= kSequencerMaxPatterns) {
+        return nullptr;
+    }
+    return &sequencerEdit_->patterns[pattern];
+}
+
+void SynthEngine::setSequencerStepLength(int stepLength) {
+    int clamped = std::max(0, std::min(3, stepLength));
+    setSequencerPatternLength(sequencerEdit_->selectedPattern,
+                              sequencerMeasures_ * sequencerStepsPerMeasure(static_cast<SequencerStepLength>(clamped)),
+                              clamped);
+}
+
+void SynthEngine::setSequencerMeasures(int measures) {
+    sequencerMeasures_ = std::max(1, measures);
+    const SequencerPattern& pattern = sequencerEdit_->patterns[sequencerEdit_->selectedPattern];
+    setSequencerPatternLength(sequencerEdit_->selectedPattern,
+                              sequencerMeasures_ * sequencerStepsPerMeasure(pattern.stepLength),
+                              static_cast<int>(pattern.stepLength));
+}
+
+void SynthEngine::setSequencerStep(int index, int midiNote, bool active) {
+    if (index < 0 || index >= kSequencerMaxSteps) {
+        return;
+    }
+    SequencerStep& step = sequencerEdit_->patterns[sequencerEdit_->selectedPattern].steps[0][index];
+    step.notes[0] = static_cast<uint8_t>(std::max(0, std::min(127, midiNote)));
+    step.noteCount = active ? 1 : 0;
+    publishSequencer();
+}
+
+void SynthEngine::setSequencerPatternLength(int pattern, int steps, int stepLength) {
+    SequencerPattern* target = editSequencerPattern(pattern);
+    if (!target) {
+        return;
+    }
+    target->stepCount = std::max(1, std::min(kSequencerMaxSteps, steps));
+    target->stepLength = static_cast<SequencerStepLength>(std::max(0, std::min(3, stepLength)));
+    publishSequencer();
+}
+
+void SynthEngine::setSequencerChordStep(int pattern, int track, int step, const int* notes, int noteCount,
+                                        float velocity, float gate) {
+    SequencerPattern* target = editSequencerPattern(pattern);
+    if (!target || track < 0 || track >= kSequencerMaxTracks || step < 0 || step >= kSequencerMaxSteps) {
+        return;
+    }
+    SequencerStep& edited = target->steps[track][step];
+    noteCount = std::max(0, std::min(kSequencerMaxChordNotes, noteCount));
+    for (int i = 0; i < noteCount; ++i) {
+        edited.notes[i] = static_cast<uint8_t>(std::max(0, std::min(127, notes[i])));
+    }
+    edited.noteCount = static_cast<uint8_t>(noteCount);
+    edited.velocity = static_cast<uint8_t>(std::max(1.0f, std::min(127.0f, velocity * 127.0f + 0.5f)));
+    edited.gate = std::max(0.01f, std::min(1.0f, gate));
+    publishSequencer();
+}
+
+void SynthEngine::clearSequencerPattern(int pattern) {
+    SequencerPattern* target = editSequencerPattern(pattern);
+    if (!target) {
+        return;
+    }
+    *target = SequencerPattern();
+    publishSequencer();
+}
+
+void SynthEngine::copySequencerPattern(int from, int to) {
+    SequencerPattern* source = editSequencerPattern(from);
+    SequencerPattern* target = editSequencerPattern(to);
+    if (!source || !target || source == target) {
+        return;
+    }
+    *target = *source;
+    publishSequencer();
+}
+
+void SynthEngine::setSequencerTrack(int track, int part, bool muted) {
+    if (track < 0 || track >= kSequencerMaxTracks) {
+        return;
+    }
+    sequencerEdit_->tracks[track].part = (part >= 0 && part < kMaxParts) ? part : -1;
+    sequencerEdit_->tracks[track].muted = muted;
+    publishSequencer();
+}
+
+void SynthEngine::selectSequencerPattern(int pattern) {
+    if (pattern < 0 || pattern >= kSequencerMaxPatterns) {
+        return;
+    }
+    sequencerEdit_->selectedPattern = pattern;
+    sequencerMeasures_ = std::max(1, sequencerEdit_->patterns[pattern].stepCount
+                                     / sequencerStepsPerMeasure(sequencerEdit_->patterns[pattern].stepLength));
+    publishSequencer();
+}
+
+void SynthEngine::setSequencerSong(const int* patterns, const int* repeats, int length) {
+    length = std::max(0, std::min(kSequencerMaxSongSlots, length));
+    for (int i = 0; i < length; ++i) {
+        sequencerEdit_->song[i].pattern = static_cast<uint8_t>(std::max(0, std::min(kSequencerMaxPatterns - 1, patterns[i])));
+        sequencerEdit_->song[i].repeats = static_cast<uint8_t>(std::max(1, std::min(255, repeats ? repeats[i] : 1)));
+    }
+    sequencerEdit_->songLength = length;
+    publishSequencer();
+}
+
+void SynthEngine::setSequencerSongMode(bool enabled) {
+    sequencerEdit_->songMode = enabled;
+    publishSequencer();
+}
+
+void SynthEngine::setLoopFreezeEnabled(bool enabled) {
+    if (enabled) {
+        loopFreeze_.allocate();
+    }
+    loopFreezeEnabled_.store(enabled, std::memory_order_release);
+}
+
+void SynthEngine::setVisualTapsEnabled(bool enabled) {
+    if (enabled) {
+        if (!visualTaps_) {
+            visualTaps_ = std::make_unique<VisualTaps>();
+        }
+        visualTaps_->setSampleRate(sampleRate_);
+        visualTaps_->start();
+        visualTapsEnabled_.store(true, std::memory_order_release);
+    } else {
+        visualTapsEnabled_.store(false, std::memory_order_release);
+        if (visualTaps_) {
+            visualTaps_->stop();
+        }
+    }
+}
+
+bool SynthEngine::startRecording(const std::string& path, WavSampleFormat format) {
+    if (!recorder_) {
+        recorder_ = std::make_unique<Recorder>();
+    }
+    int32_t rate = deviceSampleRate_.load(std::memory_order_relaxed);
+    if (rate <= 0) {
+        rate = static_cast<int32_t>(sampleRate_);
+    }
+    if (!recorder_->start(path, rate, format)) {
+        return false;
+    }
+    recorderEnabled_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool SynthEngine::stopRecording() {
+    recorderEnabled_.store(false, std::memory_order_release);
+    return recorder_ ? recorder_->stop() : true;
+}
+
+RecorderStats SynthEngine::getRecorderStats() const {
+    return recorder_ ? recorder_->getStats() : RecorderStats();
+}
+
+void SynthEngine::processLoopFreeze() {
+    bool enabled = loopFreezeEnabled_.load(std::memory_order_acquire);
+    // A MIDI file plays notes the loop does not repeat
+    bool changed = loopFreezeInvalid_.exchange(false, std::memory_order_acq_rel)
+        || midiPlaying_.load(std::memory_order_relaxed);
+    if (!enabled) {
+        if (loopFreeze_.getState() != LoopFreezeState::Off) {
+            loopFreeze_.release(LoopFreezeState::Off);
+        }
+    } else if (changed || loopFreeze_.getState() == LoopFreezeState::Off) {
+        loopFreeze_.release(LoopFreezeState::Waiting);
     }
+    loopFreezeState_.store(static_cast<int>(loopFreeze_.getState()), std::memory_order_relaxed);
 }
 
-void SynthEngine::setWaveform(int waveform) {
-    currentWaveform_ = static_cast<Waveform>(waveform);
-    LOGD("Waveform: %d", waveform);
+// Per-voice parameters are always automated per part, so setParameter()'s
+// patch is part 0; engine-wide ones have no part
+static int sequencerLanePart(int param, int part) {
+    if (param < static_cast<int>(ParamId::Waveform) || param > static_cast<int>(ParamId::FilterEnvAmount)) {
+        return -1;
+    }
+    return (part >= 0 && part < kMaxParts) ? part : 0;
 }
 
-void SynthEngine::setFilterCutoff(float cutoff) {
-    filterCutoff_ = cutoff;
-    for (auto& voice : voices_) {
-        voice.getFilter().setCutoff(cutoff);
+int SynthEngine::findSequencerLane(const SequencerPattern& pattern, int param, int part) const {
+    for (int lane = 0; lane < kSequencerMaxLanes; ++lane) {
+        if (pattern.lanes[lane].param == param && (param < 0 || pattern.lanes[lane].part == part)) {
+            return lane;
+        }
     }
+    return -1;
 }
 
-void SynthEngine::setFilterResonance(float resonance) {
-    filterResonance_ = resonance;
-    for (auto& voice : voices_) {
-        voice.getFilter().setResonance(resonance);
+bool SynthEngine::setSequencerLane(int pattern, int lane, int param, int part, bool glide) {
+    SequencerPattern* target = editSequencerPattern(pattern);
+    if (!target || lane < 0 || lane >= kSequencerMaxLanes || param >= kParamCount) {
+        return false;
+    }
+    param = std::max(-1, param);
+    part = sequencerLanePart(param, part);
+    if (param >= 0) {
+        int existing = findSequencerLane(*target, param, part);
+        if (existing >= 0 && existing != lane) {
+            return false;
+        }
+    }
+    SequencerLane& edited = target->lanes[lane];
+    if (edited.param != param || edited.part != part) {
+        // Values of another parameter mean nothing for this one
+        edited = SequencerLane();
     }
+    edited.param = static_cast<int16_t>(param);
+    edited.part = static_cast<int8_t>(part);
+    edited.glide = param >= 0 && glide;
+    publishSequencer();
+    return true;
 }
 
-void SynthEngine::setAttack(float attack) {
-    attack_ = attack;
-    for (auto& voice : voices_) {
-        voice.getAmpEnvelope().setAttack(attack);
+bool SynthEngine::setSequencerParameterLock(int pattern, int step, ParamId id, int part, float value) {
+    SequencerPattern* target = editSequencerPattern(pattern);
+    int param = static_cast<int>(id);
+    if (!target || step < 0 || step >= kSequencerMaxSteps || param < 0 || param >= kParamCount) {
+        return false;
     }
+    part = sequencerLanePart(param, part);
+    int lane = findSequencerLane(*target, param, part);
+    if (lane < 0) {
+        lane = findSequencerLane(*target, -1, -1);
+        if (lane < 0) {
+            return false;
+        }
+        target->lanes[lane] = SequencerLane();
+        target->lanes[lane].param = static_cast<int16_t>(param);
+        target->lanes[lane].part = static_cast<int8_t>(part);
+    }
+    const ParamInfo& info = kParamInfo[param];
+    target->lanes[lane].set(step, std::max(info.minValue, std::min(info.maxValue, value)));
+    publishSequencer();
+    return true;
 }
 
-void SynthEngine::setDecay(float decay) {
-    decay_ = decay;
-    for (auto& voice : voices_) {
-        voice.getAmpEnvelope().setDecay(decay);
+void SynthEngine::clearSequencerParameterLock(int pattern, int step, ParamId id, int part) {
+    SequencerPattern* target = editSequencerPattern(pattern);
+    int param = static_cast<int>(id);
+    if (!target || step < 0 || step >= kSequencerMaxSteps || param < 0 || param >= kParamCount) {
+        return;
+    }
+    int lane = findSequencerLane(*target, param, sequencerLanePart(param, part));
+    if (lane >= 0) {
+        target->lanes[lane].clear(step);
+        publishSequencer();
     }
 }
 
-void SynthEngine::setSustain(float sustain) {
-    sustain_ = sustain;
-    for (auto& voice : voices_) {
-        voice.getAmpEnvelope().setSustain(sustain);
+bool SynthEngine::recordSequencerParameter(ParamId id, int part, float value) {
+    int32_t playhead = sequencerPlayhead_.load(std::memory_order_acquire);
+    if (playhead < 0) {
+        return false;
     }
+    return setSequencerParameterLock(playhead / kSequencerMaxSteps, playhead % kSequencerMaxSteps, id, part, value);
 }
 
-void SynthEngine::setRelease(float release) {
-    release_ = release;
-    for (auto& voice : voices_) {
-        voice.getAmpEnvelope().setRelease(release);
+void SynthEngine::setRandomSeed(uint32_t seed) {
+    random_.setSeed(seed);
+    for (int l = 0; l < kNumLfos; ++l) {
+        globalLfos_[l].seed(seed * 0x9E3779B9u + static_cast<uint32_t>(l) + 1u);
+    }
+    for (size_t i = 0; i < voices_.size(); ++i) {
+        voices_[i].seedRandom(seed + static_cast<uint32_t>(i) + 1u);
     }
 }
 
-void SynthEngine::setFilterAttack(float attack) {
-    filterAttack_ = attack;
-    for (auto& voice : voices_) {
-        voice.getFilterEnvelope().setAttack(attack);
+void SynthEngine::setParameter(ParamId id, float value) {
+    // The effects run live during loop freeze; everything else shapes the cached voices
+    if (id < ParamId::DelayEnabled || id > ParamId::ReverbMix) {
+        invalidateLoopFreeze();
     }
+    applyParameter(id, value);
 }
 
-void SynthEngine::setFilterDecay(float decay) {
-    filterDecay_ = decay;
-    for (auto& voice : voices_) {
-        voice.getFilterEnvelope().setDecay(decay);
+void SynthEngine::applyParameter(ParamId id, float value) {
+    int modIndex = static_cast<int>(id) - static_cast<int>(kFirstModRouteParam);
+    if (modIndex >= 0 && modIndex < kMaxModRoutes * kModRouteParamStride) {
+        int route = modIndex / kModRouteParamStride;
+        switch (modIndex % kModRouteParamStride) {
+            case 0: modMatrix_.setSource(route, static_cast<int>(value)); break;
+            case 1: modMatrix_.setDestination(route, static_cast<int>(value)); break;
+            default: modMatrix_.setAmount(route, value); break;
+        }
+        return;
     }
-}
 
-void SynthEngine::setFilterSustain(float sustain) {
-    filterSustain_ = sustain;
-    for (auto& voice : voices_) {
-        voice.getFilterEnvelope().setSustain(sustain);
+    int lfoIndex = static_cast<int>(id) - static_cast<int>(kFirstExtraLfoParam);
+    if (lfoIndex >= 0 && lfoIndex < (kNumLfos - 1) * kLfoParamStride) {
+        int lfo = 1 + lfoIndex / kLfoParamStride;
+        switch (lfoIndex % kLfoParamStride) {
+            case 0: setLfoRate(lfo, value); break;
+            case 1: setLfoShape(lfo, static_cast<int>(value)); break;
+            case 2: setLfoSync(lfo, static_cast<int>(value)); break;
+            default: setLfoPerVoice(lfo, value >= 0.5f); break;
+        }
+        return;
     }
-}
 
-void SynthEngine::setFilterRelease(float release) {
-    filterRelease_ = release;
-    for (auto& voice : voices_) {
-        voice.getFilterEnvelope().setRelease(release);
+    switch (id) {
+        case ParamId::Waveform:        setWaveform(static_cast<int>(value)); break;
+        case ParamId::FilterCutoff:    setFilterCutoff(value); break;
+        case ParamId::FilterResonance: setFilterResonance(value); break;
+        case ParamId::Attack:          setAttack(value); break;
+        case ParamId::Decay:           setDecay(value); break;
+        case ParamId::Sustain:         setSustain(value); break;
+        case ParamId::Release:         setRelease(value); break;
+        case ParamId::FilterAttack:    setFilterAttack(value); break;
+        case ParamId::FilterDecay:     setFilterDecay(value); break;
+        case ParamId::FilterSustain:   setFilterSustain(value); break;
+        case ParamId::FilterRelease:   setFilterRelease(value); break;
+        case ParamId::FilterEnvAmount: setFilterEnvelopeAmount(value); break;
+        case ParamId::LfoRate:         setLFORate(value); break;
+        case ParamId::LfoAmount:       setLFOAmount(value); break;
+        case ParamId::DelayEnabled:    setDelayEnabled(value >= 0.5f); break;
+        case ParamId::DelayTime:       setDelayTime(value); break;
+        case ParamId::DelayFeedback:   setDelayFeedback(value); break;
+        case ParamId::DelayMix:        setDelayMix(value); break;
+        case ParamId::ChorusEnabled:   setChorusEnabled(value >= 0.5f); break;
+        case ParamId::ChorusRate:      setChorusRate(value); break;
+        case ParamId::ChorusDepth:     setChorusDepth(value); break;
+        case ParamId::ChorusMix:       setChorusMix(value); break;
+        case ParamId::ReverbEnabled:   setReverbEnabled(value >= 0.5f); break;
+        case ParamId::ReverbSize:      setReverbSize(value); break;
+        case ParamId::ReverbDamping:   setReverbDamping(value); break;
+        case ParamId::ReverbMix:       setReverbMix(value); break;
+        case ParamId::ArpEnabled:      setArpeggiatorEnabled(value >= 0.5f); break;
+        case ParamId::ArpPattern:      setArpeggiatorPattern(static_cast<int>(value)); break;
+        case ParamId::ArpRate:         setArpeggiatorRate(value); break;
+        case ParamId::ArpGate:         setArpeggiatorGate(value); break;
+        case ParamId::ArpSubdivision:  setArpeggiatorSubdivision(static_cast<int>(value)); break;
+        case ParamId::Lfo1Shape:       setLfoShape(0, static_cast<int>(value)); break;
+        case ParamId::Lfo1Sync:        setLfoSync(0, static_cast<int>(value)); break;
+        case ParamId::Lfo1PerVoice:    setLfoPerVoice(0, value >= 0.5f); break;
+        case ParamId::GlideTime:       setGlideTime(value); break;
+        case ParamId::PitchBendRange:  setPitchBendRange(value); break;
+        default:                       break;
     }
 }
 
-void SynthEngine::setFilterEnvelopeAmount(float amount) {
-    filterEnvAmount_ = amount;
-    for (auto& voice : voices_) {
-        voice.setFilterEnvelopeAmount(amount);
+float SynthEngine::getParameter(ParamId id) const {
+    int modIndex = static_cast<int>(id) - static_cast<int>(kFirstModRouteParam);
+    if (modIndex >= 0 && modIndex < kMaxModRoutes * kModRouteParamStride) {
+        const ModRoute& route = modMatrix_.getRoute(modIndex / kModRouteParamStride);
+        switch (modIndex % kModRouteParamStride) {
+            case 0: return static_cast<float>(route.source);
+            case 1: return static_cast<float>(route.destination);
+            default: return route.amount;
+        }
     }
-}
 
-void SynthEngine::setLFORate(float rate) {
-    lfo_.setRate(rate);
-}
+    int lfoIndex = static_cast<int>(id) - static_cast<int>(kFirstExtraLfoParam);
+    if (lfoIndex >= 0 && lfoIndex < (kNumLfos - 1) * kLfoParamStride) {
+        const LfoSettings& lfo = lfoSettings_[1 + lfoIndex / kLfoParamStride];
+        switch (lfoIndex % kLfoParamStride) {
+            case 0: return lfo.rate;
+            case 1: return static_cast<float>(lfo.shape);
+            case 2: return static_cast<float>(lfo.syncDivision);
+            default: return lfo.perVoice ? 1.0f : 0.0f;
+        }
+    }
 
-void SynthEngine::setLFOAmount(float amount) {
-    lfo_.setAmount(amount);
+    switch (id) {
+        case ParamId::Waveform:
+        case ParamId::FilterCutoff:
+        case ParamId::FilterResonance:
+        case ParamId::Attack:
+        case ParamId::Decay:
+        case ParamId::Sustain:
+        case ParamId::Release:
+        case ParamId::FilterAttack:
+        case ParamId::FilterDecay:
+        case ParamId::FilterSustain:
+        case ParamId::FilterRelease:
+        case ParamId::FilterEnvAmount: return getPartParameter(0, id);
+        case ParamId::LfoRate:         return lfoSettings_[0].rate;
+        case ParamId::LfoAmount:       return lfoAmount_;
+        case ParamId::DelayEnabled:    return delayEnabled_ ? 1.0f : 0.0f;
+        case ParamId::DelayTime:       return delayTime_;
+        case ParamId::DelayFeedback:   return delayFeedback_;
+        case ParamId::DelayMix:        return delayMix_;
+        case ParamId::ChorusEnabled:   return chorusEnabled_ ? 1.0f : 0.0f;
+        case ParamId::ChorusRate:      return chorusRate_;
+        case ParamId::ChorusDepth:     return chorusDepth_;
+        case ParamId::ChorusMix:       return chorusMix_;
+        case ParamId::ReverbEnabled:   return reverbEnabled_ ? 1.0f : 0.0f;
+        case ParamId::ReverbSize:      return reverbSize_;
+        case ParamId::ReverbDamping:   return reverbDamping_;
+        case ParamId::ReverbMix:       return reverbMix_;
+        case ParamId::ArpEnabled:      return arpeggiatorEnabled_ ? 1.0f : 0.0f;
+        case ParamId::ArpPattern:      return static_cast<float>(arpeggiatorPattern_);
+        case ParamId::ArpRate:         return arpeggiatorRateBpm_;
+        case ParamId::ArpGate:         return arpeggiatorGate_;
+        case ParamId::ArpSubdivision:  return static_cast<float>(arpeggiatorSubdivision_);
+        case ParamId::Lfo1Shape:       return static_cast<float>(lfoSettings_[0].shape);
+        case ParamId::Lfo1Sync:        return static_cast<float>(lfoSettings_[0].syncDivision);
+        case ParamId::Lfo1PerVoice:    return lfoSettings_[0].perVoice ? 1.0f : 0.0f;
+        case ParamId::GlideTime:       return glideTime_;
+        case ParamId::PitchBendRange:  return pitchBendRange_;
+        default:                       break;
+    }
+    return 0.0f;
 }
 
-void SynthEngine::setDelayEnabled(bool enabled) {
-    delayEnabled_ = enabled;
+void SynthEngine::applyParams(const float* values, int count) {
+    // Parameters missing from an older snapshot fall back to their defaults
+    for (int i = 0; i < kParamCount; ++i) {
+        float value = (i < count) ? values[i] : kParamInfo[i].defaultValue;
+        setParameter(static_cast<ParamId>(i), value);
+    }
 }
 
-void SynthEngine::setDelayTime(float time) {
-    delayTime_ = std::max(0.0f, time);
+SynthParams SynthEngine::getParams() const {
+    SynthParams params;
+    for (int i = 0; i < kParamCount; ++i) {
+        params.values[i] = getParameter(static_cast<ParamId>(i));
+    }
+    return params;
 }
 
-void SynthEngine::setDelayFeedback(float feedback) {
-    delayFeedback_ = std::max(0.0f, std::min(0.99f, feedback));
+bool SynthEngine::loadPresetBank(const char* path) {
+    if (!presetBank_.open(path)) {
+        LOGE("Failed to open preset bank: %s", path);
+        return false;
+    }
+    LOGD("Preset bank loaded: %u presets", presetBank_.size());
+    return true;
 }
 
-void SynthEngine::setDelayMix(float mix) {
-    delayMix_ = std::max(0.0f, std::min(1.0f, mix));
+bool SynthEngine::getPresetParams(int index, SynthParams& params) const {
+    if (index < 0 || static_cast<uint32_t>(index) >= presetBank_.size()) {
+        return false;
+    }
+    params.reset();
+    int count = std::min(static_cast<int>(presetBank_.paramCount()), kParamCount);
+    std::copy_n(presetBank_.valuesAt(index), count, params.values);
+    return true;
 }
 
-void SynthEngine::setChorusEnabled(bool enabled) {
-    chorusEnabled_ = enabled;
+bool SynthEngine::applyPreset(int index) {
+    if (index < 0 || static_cast<uint32_t>(index) >= presetBank_.size()) {
+        return false;
+    }
+    // Values are read straight out of the mapping, no parsing step
+    applyParams(presetBank_.valuesAt(index), static_cast<int>(presetBank_.paramCount()));
+    return true;
 }
 
-void SynthEngine::setChorusRate(float rate) {
-    chorusRate_ = std::max(0.0f, rate);
+void SynthEngine::processControlEvents() {
+    controlRing_.drain([this](const ControlEvent& event) {
+        switch (static_cast<ControlEventType>(event.type)) {
+            case ControlEventType::Parameter:
+                if (event.id >= 0 && event.id < kParamCount) {
+                    updateSequencerLaneBase(event.id, -1, event.value);
+                    setParameter(static_cast<ParamId>(event.id), event.value);
+                }
+                break;
+            case ControlEventType::NoteOn:
+                if (event.id >= 0 && event.id <= 127) {
+                    loopFreeze_.liveNote();
+                    noteOn(event.id, (event.value > 0.0f) ? std::min(1.0f, event.value) : 1.0f);
+                }
+                break;
+            case ControlEventType::NoteOff:
+                if (event.id >= 0 && event.id <= 127) {
+                    noteOff(event.id);
+                }
+                break;
+            case ControlEventType::PitchBend:
+                setPitchBend(event.value);
+                break;
+            case ControlEventType::NoteExpression:
+                if (event.arg >= 0 && event.arg < kNoteExpressionCount) {
+                    setNoteExpression(event.id, static_cast<NoteExpression>(event.arg), event.value);
+                }
+                break;
+            case ControlEventType::PartNoteOn:
+                if (event.id >= 0 && event.id <= 127) {
+                    loopFreeze_.liveNote();
+                    partNoteOn(event.arg, event.id, (event.value > 0.0f) ? std::min(1.0f, event.value) : 1.0f);
+                }
+                break;
+            case ControlEventType::PartNoteOff:
+                if (event.id >= 0 && event.id <= 127) {
+                    partNoteOff(event.arg, event.id);
+                }
+                break;
+            case ControlEventType::PartParameter:
+                if (event.id >= 0 && event.id < kParamCount) {
+                    updateSequencerLaneBase(event.id, event.arg, event.value);
+                    setPartParameter(event.arg, static_cast<ParamId>(event.id), event.value);
+                }
+                break;
+            // Part layout and mixing only change here, between blocks, so
+            // the render loop never sees partCount_ move under it
+            case ControlEventType::PartEnabled:
+                setPartEnabled(event.arg, event.value != 0.0f);
+                break;
+            case ControlEventType::PartKeyRange:
+                setPartKeyRange(event.arg, event.id, static_cast<int>(event.value));
+                break;
+            case ControlEventType::PartMidiChannel:
+                setPartMidiChannel(event.arg, event.id);
+                break;
+            case ControlEventType::PartLevel:
+                setPartLevel(event.arg, event.value);
+                break;
+            case ControlEventType::PartSend:
+                if (event.id >= 0 && event.id < kPartSendCount) {
+                    setPartSend(event.arg, static_cast<PartSend>(event.id), event.value);
+                }
+                break;
+            case ControlEventType::None:
+            default:
+                break;
+        }
+    });
 }
 
-void SynthEngine::setChorusDepth(float depth) {
-    chorusDepth_ = std::max(0.0f, std::min(1.0f, depth));
+void SynthEngine::processTuningUpdate() {
+    int loaded = tuningLoadedTable_.load(std::memory_order_acquire);
+    if (loaded != tuningActiveTable_.load(std::memory_order_relaxed)) {
+        tuningActiveTable_.store(loaded, std::memory_order_release);
+        invalidateLoopFreeze();
+    }
 }
 
-void SynthEngine::setChorusMix(float mix) {
-    chorusMix_ = std::max(0.0f, std::min(1.0f, mix));
+bool SynthEngine::publishTuning() {
+    int active = tuningActiveTable_.load(std::memory_order_acquire);
+    int target = (active == 0) ? 1 : 0;
+    if (!buildTuningTable(tuningScale_, tuningMapping_, tuningTables_[target])) {
+        LOGE("Tuning rejected: reference key %d is unmapped", tuningMapping_.referenceNote);
+        return false;
+    }
+    tuningLoadedTable_.store(target, std::memory_order_release);
+    return true;
 }
 
-void SynthEngine::setReverbEnabled(bool enabled) {
-    reverbEnabled_ = enabled;
-}
+bool SynthEngine::loadScalaTuning(const char* sclPath, const char* kbmPath) {
+    // As with MIDI files, never rebuild the copy that is about to be picked up
+    if (tuningLoadedTable_.load(std::memory_order_relaxed)
+        != tuningActiveTable_.load(std::memory_order_acquire)) {
+        LOGE("Tuning load rejected: previous tuning not yet picked up");
+        return false;
+    }
 
-void SynthEngine::setReverbSize(float size) {
-    reverbSize_ = std::max(0.0f, std::min(1.0f, size));
-}
+    ScalaScale scale;
+    if (!scale.loadFile(sclPath)) {
+        LOGE("Failed to load Scala scale: %s", sclPath);
+        return false;
+    }
+    KeyboardMapping mapping;
+    mapping.referenceFrequency = tuningMapping_.referenceFrequency;
+    if (kbmPath && !mapping.loadFile(kbmPath)) {
+        LOGE("Failed to load keyboard mapping: %s", kbmPath);
+        return false;
+    }
 
-void SynthEngine::setReverbDamping(float damping) {
-    reverbDamping_ = std::max(0.0f, std::min(1.0f, damping));
+    KeyboardMapping previousMapping = tuningMapping_;
+    ScalaScale previousScale = tuningScale_;
+    tuningScale_ = scale;
+    tuningMapping_ = mapping;
+    if (!publishTuning()) {
+        tuningScale_ = previousScale;
+        tuningMapping_ = previousMapping;
+        return false;
+    }
+    LOGD("Tuning loaded: %s (%d degrees)", tuningScale_.getDescription().c_str(), tuningScale_.size());
+    return true;
 }
 
-void SynthEngine::setReverbMix(float mix) {
-    reverbMix_ = std::max(0.0f, std::min(1.0f, mix));
+bool SynthEngine::setTuningReference(float referenceHz) {
+    if (tuningLoadedTable_.load(std::memory_order_relaxed)
+        != tuningActiveTable_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    double previous = tuningMapping_.referenceFrequency;
+    tuningMapping_.referenceFrequency = std::max(100.0f, std::min(1000.0f, referenceHz));
+    if (!publishTuning()) {
+        tuningMapping_.referenceFrequency = previous;
+        return false;
+    }
+    return true;
 }
 
-void SynthEngine::setArpeggiatorEnabled(bool enabled) {
-    if (!enabled && arpeggiatorEnabled_ && arpNoteActive_) {
-        // Turn off any active arp note when disabling
-        suppressArpCapture_ = true;
-        noteOff(currentArpNote_);
-        suppressArpCapture_ = false;
+bool SynthEngine::resetTuning() {
+    if (tuningLoadedTable_.load(std::memory_order_relaxed)
+        != tuningActiveTable_.load(std::memory_order_acquire)) {
+        return false;
     }
+    // Back to 12-TET, keeping the reference pitch
+    KeyboardMapping mapping;
+    mapping.referenceFrequency = tuningMapping_.referenceFrequency;
+    tuningScale_ = ScalaScale();
+    tuningMapping_ = mapping;
+    return publishTuning();
+}
 
-    arpeggiatorEnabled_ = enabled;
-
-    if (!enabled) {
-        // Reset arp state completely when disabling
-        heldNotes_.clear();
-        arpSampleCounter_ = 0.0f;
-        arpIndex_ = 0;
-        arpNoteActive_ = false;
-        arpStepStarted_ = false;
-        currentArpNote_ = -1;
-    } else {
-        // When enabling, start from a clean step boundary
-        arpSampleCounter_ = 0.0f;
-        arpIndex_ = 0;
-        arpNoteActive_ = false;
-        arpStepStarted_ = false;
-        currentArpNote_ = -1;
+bool SynthEngine::loadMidiFile(const char* path) {
+    // The previous hand-over must have been picked up by the audio thread,
+    // otherwise we could be parsing into the sequence it is about to play
+    int playing = midiPlayingSequence_.load(std::memory_order_acquire);
+    int loaded = midiLoadedSequence_.load(std::memory_order_relaxed);
+    if (loaded != playing) {
+        LOGE("MIDI load rejected: previous file not yet picked up");
+        return false;
     }
-}
 
+    int target = (playing == 0) ? 1 : 0;
+    MidiSequence& sequence = midiSequences_[target];
+    if (!sequence.loadFile(path)) {
+        LOGE("Failed to load MIDI file: %s", path);
+        return false;
+    }
+    if (sequence.wasTruncated()) {
+        LOGE("MIDI file truncated to %zu events", sequence.size());
+    }
+    LOGD("MIDI file loaded: %zu events, %.1f s", sequence.size(), sequence.getLengthSeconds());
 
-void SynthEngine::setArpeggiatorPattern(int pattern) {
-    arpeggiatorPattern_ = std::max(0, std::min(3, pattern));
+    midiLoadedSequence_.store(target, std::memory_order_release);
+    return true;
 }
 
-void SynthEngine::setArpeggiatorRate(float bpm) {
-    arpeggiatorRateBpm_ = std::max(20.0f, bpm);
+void SynthEngine::startMidiPlayback(bool loop) {
+    midiCommand_.store(static_cast<int>(loop ? MidiCommand::StartLooping : MidiCommand::Start),
+                       std::memory_order_release);
 }
 
-void SynthEngine::setArpeggiatorGate(float gate) {
-    arpeggiatorGate_ = std::max(0.05f, std::min(1.0f, gate));
+void SynthEngine::stopMidiPlayback() {
+    midiCommand_.store(static_cast<int>(MidiCommand::Stop), std::memory_order_release);
 }
 
-void SynthEngine::setArpeggiatorSubdivision(int subdivision) {
-    int clamped = std::max(0, std::min(3, subdivision));
-    switch (clamped) {
-        case 0:
-            arpeggiatorStepMultiplier_ = 2.0f;
-            break;
-        case 2:
-            arpeggiatorStepMultiplier_ = 0.5f;
+void SynthEngine::processMidiTransport() {
+    int loaded = midiLoadedSequence_.load(std::memory_order_acquire);
+    if (loaded != midiPlayingSequence_.load(std::memory_order_relaxed)) {
+        // New file: stop whatever was playing from the old one
+        releaseMidiNotes();
+        midiPlaying_.store(false, std::memory_order_relaxed);
+        midiPlayingSequence_.store(loaded, std::memory_order_release);
+    }
+
+    auto command = static_cast<MidiCommand>(midiCommand_.exchange(0, std::memory_order_acq_rel));
+    switch (command) {
+        case MidiCommand::Start:
+        case MidiCommand::StartLooping:
+            releaseMidiNotes();
+            midiLooping_ = (command == MidiCommand::StartLooping);
+            midiNextEvent_ = 0;
+            midiPosition_ = 0;
+            midiPlaying_.store(loaded >= 0, std::memory_order_relaxed);
             break;
-        case 3:
-            arpeggiatorStepMultiplier_ = 0.25f;
+        case MidiCommand::Stop:
+            releaseMidiNotes();
+            midiPlaying_.store(false, std::memory_order_relaxed);
             break;
-        case 1:
-        default:
-            arpeggiatorStepMultiplier_ = 1.0f;
+        case MidiCommand::None:
             break;
     }
 }
 
-void SynthEngine::setSequencerEnabled(bool enabled) {
-    if (!enabled && sequencerNoteActive_) {
-        // Turn off any active sequencer note when disabling
-        suppressArpCapture_ = true;
-        noteOff(sequencerActiveNote_);
-        suppressArpCapture_ = false;
-    }
-
-    sequencerEnabled_ = enabled;
-
-    if (!enabled) {
-        // Reset sequencer state completely when disabling
-        sequencerSampleCounter_ = 0.0f;
-        sequencerCurrentStep_ = 0;
-        sequencerActiveNote_ = -1;
-        sequencerNoteActive_ = false;
-        sequencerStepStarted_ = false;
-    } else {
-        // When enabling, start from the first step with a clean state
-        sequencerSampleCounter_ = 0.0f;
-        sequencerCurrentStep_ = 0;
-        sequencerActiveNote_ = -1;
-        sequencerNoteActive_ = false;
-        sequencerStepStarted_ = false;
+int32_t SynthEngine::processMidiEvents(int32_t frame, int32_t numFrames) {
+    if (!midiPlaying_.load(std::memory_order_relaxed)) {
+        return numFrames;
     }
-}
 
+    const MidiSequence& sequence = midiSequences_[midiPlayingSequence_.load(std::memory_order_relaxed)];
 
-void SynthEngine::setSequencerTempo(float bpm) {
-    sequencerTempoBpm_ = std::max(20.0f, bpm);
-}
+    while (true) {
+        const int64_t now = midiPosition_ + frame;
 
-void SynthEngine::setSequencerStepLength(int stepLength) {
-    int clamped = std::max(0, std::min(3, stepLength));
-    sequencerStepLength_ = static_cast<SequencerStepLength>(clamped);
-    configureSequenceLength();
-}
+        // Dispatch everything that is due at or before this sample
+        while (midiNextEvent_ < sequence.size()) {
+            const MidiEvent& event = sequence[midiNextEvent_];
+            int64_t eventSample = static_cast<int64_t>(event.time * sampleRate_ + 0.5);
+            if (eventSample > now) {
+                return static_cast<int32_t>(std::min<int64_t>(numFrames, frame + (eventSample - now)));
+            }
+            uint16_t channelBit = static_cast<uint16_t>(1u << (event.channel & 15));
+            if (event.type == MidiEventType::NoteOn) {
+                noteOnRouted(event.note, event.velocity / 127.0f, event.channel & 15);
+                midiNotesOn_[event.note] |= channelBit;
+            } else if (event.type == MidiEventType::NoteOff && (midiNotesOn_[event.note] & channelBit)) {
+                noteOffRouted(event.note, event.channel & 15);
+                midiNotesOn_[event.note] &= static_cast<uint16_t>(~channelBit);
+            }
+            midiNextEvent_++;
+        }
 
-void SynthEngine::setSequencerMeasures(int measures) {
-    sequencerMeasures_ = std::max(1, measures);
-    configureSequenceLength();
+        // End of the file: wrap around or stop
+        int64_t lengthSamples = static_cast<int64_t>(sequence.getLengthSeconds() * sampleRate_ + 0.5);
+        if (now < lengthSamples) {
+            return static_cast<int32_t>(std::min<int64_t>(numFrames, frame + (lengthSamples - now)));
+        }
+        releaseMidiNotes();
+        if (!midiLooping_ || lengthSamples <= 0) {
+            midiPlaying_.store(false, std::memory_order_relaxed);
+            return numFrames;
+        }
+        midiNextEvent_ = 0;
+        midiPosition_ -= lengthSamples;
+    }
 }
 
-void SynthEngine::setSequencerStep(int index, int midiNote, bool active) {
-    if (index < 0 || index >= static_cast<int>(sequencerSteps_.size())) {
-        return;
+void SynthEngine::releaseMidiNotes() {
+    for (int note = 0; note < 128; ++note) {
+        for (int channel = 0; midiNotesOn_[note] != 0; ++channel) {
+            if (midiNotesOn_[note] & (1u << channel)) {
+                noteOffRouted(note, channel);
+                midiNotesOn_[note] &= static_cast<uint16_t>(~(1u << channel));
+            }
+        }
     }
-    sequencerSteps_[index].midiNote = std::max(0, std::min(127, midiNote));
-    sequencerSteps_[index].active = active;
 }
 
 // CRITICAL FIX: Process arpeggiator ONCE per buffer, not per sample!
-void SynthEngine::processArpeggiator(float sampleRate, int32_t numFrames) {
+void SynthEngine::processArpeggiator(int32_t numFrames) {
     if (!arpeggiatorEnabled_ || heldNotes_.empty()) {
         return;
     }
@@ -491,7 +1874,7 @@ void SynthEngine::processArpeggiator(float sampleRate, int32_t numFrames) {
     arpSampleCounter_ += numFrames;
 
     float stepDuration = (60.0f / arpeggiatorRateBpm_) * arpeggiatorStepMultiplier_;
-    float stepDurationSamples = stepDuration * sampleRate;
+    float stepDurationSamples = stepDuration * sampleRate_;
     float gateTimeSamples = stepDurationSamples * arpeggiatorGate_;
 
     // Start a new step (and its note) if we haven't yet
@@ -521,7 +1904,7 @@ void SynthEngine::processArpeggiator(float sampleRate, int32_t numFrames) {
             }
             case 3: // Random
             default:
-                idx = std::rand() % noteCount;
+                idx = random_.nextInt(noteCount);
                 break;
         }
 
@@ -578,129 +1961,263 @@ void SynthEngine::processArpeggiator(float sampleRate, int32_t numFrames) {
 }
 
 
-// CRITICAL FIX: Process sequencer ONCE per buffer, not per sample!
-void SynthEngine::processSequencer(float sampleRate, int32_t numFrames) {
-    if (!sequencerEnabled_ || sequencerSteps_.empty()) {
-        return;
+void SynthEngine::processSequencerTransport() {
+    // Edits published since the last block; notes already sounding keep
+    // their own record, so they are released correctly whatever changed
+    if (sequencerBank_.acquire()) {
+        invalidateLoopFreeze();
     }
 
-    // Advance position within the current step
-    sequencerSampleCounter_ += numFrames;
+    bool enabled = sequencerEnabled_.load(std::memory_order_acquire);
+    if (enabled == sequencerRunning_) {
+        return;
+    }
+    // No step start follows a stop, so a frozen loop cannot wait for one
+    loopFreeze_.cut(loopFreeze_.getState() == LoopFreezeState::Off ? LoopFreezeState::Off
+                                                                   : LoopFreezeState::Waiting);
+    releaseSequencerNotes();
+    restoreSequencerLanes();
+    sequencerPlayhead_.store(-1, std::memory_order_release);
+    sequencerRunning_ = enabled;
+    sequencerStepStarted_ = false;
+    sequencerStep_ = 0;
+    sequencerSongSlot_ = 0;
+    sequencerRepeat_ = 0;
+    sequencerPosition_ = 0.0;
+
+    const SequencerBank& bank = sequencerBank_.current();
+    sequencerPattern_ = (bank.songMode && bank.songLength > 0) ? bank.song[0].pattern : bank.selectedPattern;
+}
 
-    float beatSeconds = 60.0f / sequencerTempoBpm_;
-    float lengthMultiplier = 1.0f;
-    switch (sequencerStepLength_) {
-        case SequencerStepLength::Eighth:
-            lengthMultiplier = 0.5f;
-            break;
-        case SequencerStepLength::Quarter:
-            lengthMultiplier = 1.0f;
-            break;
-        case SequencerStepLength::Half:
-            lengthMultiplier = 2.0f;
-            break;
-        case SequencerStepLength::Whole:
-            lengthMultiplier = 4.0f;
-            break;
+int32_t SynthEngine::processSequencerEvents(int32_t frame, int32_t numFrames) {
+    if (!sequencerRunning_) {
+        return numFrames;
     }
 
-    float stepDuration = beatSeconds * lengthMultiplier;
-    float stepDurationSamples = stepDuration * sampleRate;
-    float gateTimeSamples = stepDurationSamples * 0.9f;
+    const SequencerBank& bank = sequencerBank_.current();
+    while (true) {
+        const SequencerPattern& pattern = bank.patterns[sequencerPattern_];
+        const double stepSamples = sequencerStepBeats(pattern.stepLength) * 60.0 / sequencerTempoBpm_ * sampleRate_;
+        const double now = sequencerPosition_ + frame;
 
-    // Start the current step's note if we haven't yet
-    if (!sequencerStepStarted_) {
-        const auto& step = sequencerSteps_[sequencerCurrentStep_ % sequencerSteps_.size()];
-        sequencerActiveNote_ = step.midiNote;
+        if (!sequencerStepStarted_) {
+            startSequencerStep(bank);
+        }
 
-        if (step.active) {
-            suppressArpCapture_ = true;
-            noteOn(step.midiNote);
-            suppressArpCapture_ = false;
-            sequencerNoteActive_ = true;
-        } else {
-            sequencerNoteActive_ = false;
+        // Glide points fall every kSequencerAutomationInterval samples from
+        // the step start, wherever the blocks happen to split
+        double next = stepSamples;
+        if (sequencerGlidingLanes_ > 0) {
+            if (now >= sequencerNextGlide_) {
+                glideSequencerLanes(static_cast<float>(std::min(1.0, now / stepSamples)));
+                sequencerNextGlide_ = (std::floor(now / kSequencerAutomationInterval) + 1.0)
+                                      * kSequencerAutomationInterval;
+            }
+            next = std::min(next, sequencerNextGlide_);
+        }
+
+        // Gates that close within this step
+        for (int track = 0; track < kSequencerMaxTracks; ++track) {
+            const SequencerSounding& sounding = sequencerSounding_[track];
+            if (sounding.noteCount == 0) {
+                continue;
+            }
+            double gateEnd = sounding.gate * stepSamples;
+            if (now >= gateEnd) {
+                releaseSequencerTrack(track);
+            } else {
+                next = std::min(next, gateEnd);
+            }
+        }
+
+        if (now >= stepSamples) {
+            releaseSequencerNotes();
+            sequencerPosition_ -= stepSamples;
+            advanceSequencerStep(bank);
+            continue;
         }
+        return static_cast<int32_t>(std::min<double>(numFrames, frame + std::ceil(next - now)));
+    }
+}
+
+void SynthEngine::startSequencerStep(const SequencerBank& bank) {
+    const SequencerPattern& pattern = bank.patterns[sequencerPattern_];
+    if (sequencerStep_ >= pattern.stepCount) {
+        // The pattern was shortened under us
+        sequencerStep_ = 0;
+    }
+    sequencerPlayhead_.store(sequencerPattern_ * kSequencerMaxSteps + sequencerStep_, std::memory_order_release);
 
+    // Locks first, so the step's notes start with them
+    startSequencerLanes(pattern);
+
+    bool loopStart = sequencerStep_ == 0
+        && (!bank.songMode || bank.songLength == 0 || (sequencerSongSlot_ == 0 && sequencerRepeat_ == 0));
+    if (loopFreeze_.stepStart(loopStart, partMixing_ ? partCount_ : 1)) {
+        // The captured loop already holds these voices and their tails
+        for (auto& voice : voices_) {
+            voice.silence();
+        }
+        for (auto& sounding : sequencerSounding_) {
+            sounding.noteCount = 0;
+        }
+    }
+    if (loopFreeze_.isPlaying()) {
         sequencerStepStarted_ = true;
+        return;
     }
 
-    // Gate off the note part-way through the step
-    if (sequencerNoteActive_ && sequencerSampleCounter_ >= gateTimeSamples) {
-        suppressArpCapture_ = true;
-        noteOff(sequencerActiveNote_);
-        suppressArpCapture_ = false;
-        sequencerNoteActive_ = false;
+    suppressArpCapture_ = true;
+    for (int track = 0; track < kSequencerMaxTracks; ++track) {
+        const SequencerStep& step = pattern.steps[track][sequencerStep_];
+        if (bank.tracks[track].muted || step.noteCount == 0) {
+            continue;
+        }
+        releaseSequencerTrack(track);
+
+        SequencerSounding& sounding = sequencerSounding_[track];
+        sounding.part = bank.tracks[track].part;
+        sounding.gate = step.gate;
+        float velocity = step.velocity / 127.0f;
+        for (int i = 0; i < step.noteCount; ++i) {
+            if (sounding.part >= 0) {
+                partNoteOn(sounding.part, step.notes[i], velocity);
+            } else {
+                noteOn(step.notes[i], velocity);
+            }
+            sounding.notes[i] = step.notes[i];
+        }
+        sounding.noteCount = step.noteCount;
     }
+    suppressArpCapture_ = false;
+    sequencerStepStarted_ = true;
+}
 
-    // Advance to the next step when its duration has elapsed
-    if (sequencerSampleCounter_ >= stepDurationSamples) {
-        // Make sure note is off before advancing
-        if (sequencerNoteActive_) {
-            suppressArpCapture_ = true;
-            noteOff(sequencerActiveNote_);
-            suppressArpCapture_ = false;
-            sequencerNoteActive_ = false;
+void SynthEngine::advanceSequencerStep(const SequencerBank& bank) {
+    sequencerStepStarted_ = false;
+    if (++sequencerStep_ < bank.patterns[sequencerPattern_].stepCount) {
+        return;
+    }
+
+    // End of the pattern: next repeat, next song slot or the selected pattern
+    sequencerStep_ = 0;
+    if (bank.songMode && bank.songLength > 0) {
+        if (sequencerSongSlot_ >= bank.songLength) {
+            sequencerSongSlot_ = 0;
+            sequencerRepeat_ = 0;
+        } else if (++sequencerRepeat_ >= bank.song[sequencerSongSlot_].repeats) {
+            sequencerRepeat_ = 0;
+            sequencerSongSlot_ = (sequencerSongSlot_ + 1) % bank.songLength;
         }
+        sequencerPattern_ = bank.song[sequencerSongSlot_].pattern;
+    } else {
+        sequencerPattern_ = bank.selectedPattern;
+    }
+}
 
-        sequencerSampleCounter_ -= stepDurationSamples;
-        if (!sequencerSteps_.empty()) {
-            sequencerCurrentStep_ = (sequencerCurrentStep_ + 1) % sequencerSteps_.size();
+void SynthEngine::releaseSequencerTrack(int track) {
+    SequencerSounding& sounding = sequencerSounding_[track];
+    suppressArpCapture_ = true;
+    for (int i = 0; i < sounding.noteCount; ++i) {
+        if (sounding.part >= 0) {
+            partNoteOff(sounding.part, sounding.notes[i]);
         } else {
-            sequencerCurrentStep_ = 0;
+            noteOff(sounding.notes[i]);
         }
-        sequencerStepStarted_ = false;
     }
+    suppressArpCapture_ = false;
+    sounding.noteCount = 0;
 }
 
+void SynthEngine::releaseSequencerNotes() {
+    for (int track = 0; track < kSequencerMaxTracks; ++track) {
+        releaseSequencerTrack(track);
+    }
+}
 
-void SynthEngine::configureSequenceLength() {
-    int stepsPerMeasure = getStepsPerMeasure();
-    int totalSteps = std::max(1, sequencerMeasures_ * stepsPerMeasure);
-    static const int patternNotes[] = {60, 62, 64, 65, 67, 69, 71, 72};
+void SynthEngine::startSequencerLanes(const SequencerPattern& pattern) {
+    // Give back what this step does not lock before taking anything, so a
+    // parameter that moved to another lane slot saves the patch value and
+    // not the old lock
+    for (int l = 0; l < kSequencerMaxLanes; ++l) {
+        const SequencerLane& lane = pattern.lanes[l];
+        SequencerLaneState& state = sequencerLanes_[l];
+        bool locked = lane.param >= 0 && lane.isSet(sequencerStep_);
+        if (state.param >= 0 && (!locked || state.param != lane.param || state.part != lane.part)) {
+            writeSequencerParameter(state.param, state.part, state.base);
+            state.param = -1;
+        }
+    }
 
-    if (sequencerActiveNote_ >= 0 && sequencerNoteActive_) {
-        suppressArpCapture_ = true;
-        noteOff(sequencerActiveNote_);
-        suppressArpCapture_ = false;
+    sequencerGlidingLanes_ = 0;
+    int nextStep = (sequencerStep_ + 1 < pattern.stepCount) ? sequencerStep_ + 1 : 0;
+    for (int l = 0; l < kSequencerMaxLanes; ++l) {
+        const SequencerLane& lane = pattern.lanes[l];
+        SequencerLaneState& state = sequencerLanes_[l];
+        if (lane.param < 0 || !lane.isSet(sequencerStep_)) {
+            state.gliding = false;
+            continue;
+        }
+        if (state.param < 0) {
+            state.param = lane.param;
+            state.part = lane.part;
+            state.base = (state.part >= 0) ? getPartParameter(state.part, static_cast<ParamId>(state.param))
+                                           : getParameter(static_cast<ParamId>(state.param));
+        }
+        state.from = lane.values[sequencerStep_];
+        state.gliding = lane.glide && lane.isSet(nextStep);
+        state.to = state.gliding ? lane.values[nextStep] : state.from;
+        sequencerGlidingLanes_ += state.gliding ? 1 : 0;
+        writeSequencerParameter(state.param, state.part, state.from);
     }
+    sequencerNextGlide_ = kSequencerAutomationInterval;
+}
 
-    std::vector<SequencerStep> newSteps(totalSteps);
-    for (int i = 0; i < totalSteps; ++i) {
-        if (i < static_cast<int>(sequencerSteps_.size())) {
-            newSteps[i] = sequencerSteps_[i];
-        } else {
-            newSteps[i] = {patternNotes[i % 8], true};
+void SynthEngine::glideSequencerLanes(float position) {
+    for (const SequencerLaneState& state : sequencerLanes_) {
+        if (state.gliding) {
+            writeSequencerParameter(state.param, state.part, state.from + (state.to - state.from) * position);
+        }
+    }
+}
+
+void SynthEngine::restoreSequencerLanes() {
+    for (SequencerLaneState& state : sequencerLanes_) {
+        if (state.param >= 0) {
+            writeSequencerParameter(state.param, state.part, state.base);
         }
+        state.param = -1;
+        state.gliding = false;
     }
+    sequencerGlidingLanes_ = 0;
+}
 
-    sequencerSteps_.swap(newSteps);
-    sequencerCurrentStep_ = std::min(sequencerCurrentStep_, static_cast<int>(sequencerSteps_.size()) - 1);
-    sequencerSampleCounter_ = 0.0f;
-    sequencerActiveNote_ = -1;
-    sequencerNoteActive_ = false;
+void SynthEngine::updateSequencerLaneBase(int param, int part, float value) {
+    // A knob moved while its parameter is locked: the lock ends on the
+    // knob's value rather than the one it had before
+    part = sequencerLanePart(param, part);
+    for (SequencerLaneState& state : sequencerLanes_) {
+        if (state.param == param && state.part == part) {
+            state.base = value;
+        }
+    }
 }
 
-int SynthEngine::getStepsPerMeasure() const {
-    switch (sequencerStepLength_) {
-        case SequencerStepLength::Eighth:
-            return 8;
-        case SequencerStepLength::Quarter:
-            return 4;
-        case SequencerStepLength::Half:
-            return 2;
-        case SequencerStepLength::Whole:
-            return 1;
+// Lanes are part of the loop, so they leave a frozen loop alone
+void SynthEngine::writeSequencerParameter(int param, int part, float value) {
+    if (part >= 0) {
+        applyPartParameter(part, static_cast<ParamId>(param), value);
+    } else {
+        applyParameter(static_cast<ParamId>(param), value);
     }
-    return 4;
 }
 
-float SynthEngine::processDelay(float input, float sampleRate) {
+float SynthEngine::processDelay(float input) {
     if (!delayEnabled_ || delayBuffer_.empty()) {
         return input;
     }
 
-    size_t delaySamples = static_cast<size_t>(delayTime_ * sampleRate);
+    size_t delaySamples = static_cast<size_t>(delayTime_ * sampleRate_);
     delaySamples = std::max<size_t>(1, std::min(delaySamples, delayBufferSize_ - 1));
 
     size_t readIndex = (delayWriteIndex_ + delayBufferSize_ - delaySamples) % delayBufferSize_;
@@ -714,10 +2231,11 @@ float SynthEngine::processDelay(float input, float sampleRate) {
         delayWriteIndex_ = 0;
     }
 
-    return input * (1.0f - delayMix_) + delayed * delayMix_;
+    float mix = std::max(0.0f, std::min(1.0f, delayMix_ + delayMixMod_));
+    return input * (1.0f - mix) + delayed * mix;
 }
 
-float SynthEngine::processChorus(float input, float sampleRate) {
+float SynthEngine::processChorus(float input) {
     if (!chorusEnabled_ || chorusBuffer_.empty()) {
         return input;
     }
@@ -726,11 +2244,11 @@ float SynthEngine::processChorus(float input, float sampleRate) {
     float mod2 = std::sin(2.0f * kPI * chorusPhase2_);
 
     float baseDelayMs = 12.0f;
-    float depthMs = 8.0f * chorusDepth_;
+    float depthMs = 8.0f * std::max(0.0f, std::min(1.0f, chorusDepth_ + chorusDepthMod_));
 
     auto readChorus = [&](float mod) {
         float delayMs = baseDelayMs + depthMs * mod;
-        float delaySamples = delayMs * sampleRate / 1000.0f;
+        float delaySamples = delayMs * samplesPerMs_;
         delaySamples = std::max(1.0f, std::min(delaySamples, static_cast<float>(chorusBufferSize_ - 1)));
 
         float readPos = static_cast<float>(chorusWriteIndex_) - delaySamples;
@@ -755,15 +2273,15 @@ float SynthEngine::processChorus(float input, float sampleRate) {
         chorusWriteIndex_ = 0;
     }
 
-    chorusPhase1_ += chorusRate_ / sampleRate;
-    chorusPhase2_ += chorusRate_ / sampleRate;
+    chorusPhase1_ += chorusRate_ * invSampleRate_;
+    chorusPhase2_ += chorusRate_ * invSampleRate_;
     if (chorusPhase1_ >= 1.0f) chorusPhase1_ -= 1.0f;
     if (chorusPhase2_ >= 1.0f) chorusPhase2_ -= 1.0f;
 
     return input * (1.0f - chorusMix_) + wet * chorusMix_;
 }
 
-float SynthEngine::processReverb(float input, float sampleRate) {
+float SynthEngine::processReverb(float input) {
     if (!reverbEnabled_ || reverbCombs_.empty() || reverbAllpasses_.empty()) {
         return input;
     }
@@ -772,8 +2290,12 @@ float SynthEngine::processReverb(float input, float sampleRate) {
     float damp = 0.2f + 0.75f * reverbDamping_;
     float feedback = 0.7f * sizeScale;
 
+    size_t combCount = reverbActiveCombs_ ? reverbActiveCombs_ : reverbCombs_.size();
+    size_t allpassCount = reverbActiveAllpasses_ ? reverbActiveAllpasses_ : reverbAllpasses_.size();
+
     float combSum = 0.0f;
-    for (auto& comb : reverbCombs_) {
+    for (size_t i = 0; i < combCount; ++i) {
+        auto& comb = reverbCombs_[i];
         float delayed = comb.buffer[comb.index];
         comb.filterStore = delayed * (1.0f - damp) + comb.filterStore * damp;
         comb.buffer[comb.index] = input + comb.filterStore * feedback;
@@ -786,9 +2308,10 @@ float SynthEngine::processReverb(float input, float sampleRate) {
         combSum += delayed;
     }
 
-    float wet = combSum / static_cast<float>(reverbCombs_.size());
+    float wet = combSum / static_cast<float>(combCount);
 
-    for (auto& allpass : reverbAllpasses_) {
+    for (size_t i = 0; i < allpassCount; ++i) {
+        auto& allpass = reverbAllpasses_[i];
         float bufOut = allpass.buffer[allpass.index];
         float y = -wet + bufOut;
         allpass.buffer[allpass.index] = wet + bufOut * 0.5f;
@@ -801,7 +2324,8 @@ float SynthEngine::processReverb(float input, float sampleRate) {
         wet = y;
     }
 
-    return input * (1.0f - reverbMix_) + wet * reverbMix_;
+    float mix = std::max(0.0f, std::min(1.0f, reverbMix_ + reverbMixMod_));
+    return input * (1.0f - mix) + wet * mix;
 }
 
 void SynthEngine::initializeEffects(float sampleRate) {
@@ -835,17 +2359,21 @@ void SynthEngine::initializeEffects(float sampleRate) {
 
 
 Voice* SynthEngine::findFreeVoice() {
+    // Only the voices the current quality tier allows
+    Voice* first = voices_.data();
+    Voice* last = first + voiceLimit_;
+
     // First priority: completely idle voices
-    for (auto& voice : voices_) {
-        if (voice.getMidiNote() == -1 && !voice.isProducingAudio()) {
-            return &voice;
+    for (Voice* voice = first; voice != last; ++voice) {
+        if (voice->getMidiNote() == -1 && !voice->isProducingAudio()) {
+            return voice;
         }
     }
     
     // Second priority: released voices that are mostly faded
-    for (auto& voice : voices_) {
-        if (!voice.isKeyHeld() && voice.getAmpLevel() < 0.05f) {
-            return &voice;
+    for (Voice* voice = first; voice != last; ++voice) {
+        if (!voice->isKeyHeld() && voice->getAmpLevel() < 0.05f) {
+            return voice;
         }
     }
     
@@ -854,25 +2382,25 @@ Voice* SynthEngine::findFreeVoice() {
     float minLevel = 1.0f;
     
     // First try to find a released voice to steal
-    for (auto& voice : voices_) {
-        if (!voice.isKeyHeld()) {
-            float lvl = voice.getAmpLevel();
+    for (Voice* voice = first; voice != last; ++voice) {
+        if (!voice->isKeyHeld()) {
+            float lvl = voice->getAmpLevel();
             if (lvl < minLevel) {
                 minLevel = lvl;
-                quietest = &voice;
+                quietest = voice;
             }
         }
     }
     
     // If all voices have keys held, steal the overall quietest
     if (!quietest) {
-        quietest = &voices_[0];
+        quietest = first;
         minLevel = quietest->getAmpLevel();
-        for (auto& voice : voices_) {
-            float lvl = voice.getAmpLevel();
+        for (Voice* voice = first; voice != last; ++voice) {
+            float lvl = voice->getAmpLevel();
             if (lvl < minLevel) {
                 minLevel = lvl;
-                quietest = &voice;
+                quietest = voice;
             }
         }
     }
@@ -881,10 +2409,10 @@ Voice* SynthEngine::findFreeVoice() {
 }
 
 
-Voice* SynthEngine::findVoiceForNote(int midiNote) {
+Voice* SynthEngine::findVoiceForNote(int part, int midiNote) {
     for (auto& voice : voices_) {
         // Check if this voice has this note AND the key is still held
-        if (voice.getMidiNote() == midiNote && voice.isKeyHeld()) {
+        if (voice.getPart() == part && voice.getMidiNote() == midiNote && voice.isKeyHeld()) {
             return &voice;
         }
     }
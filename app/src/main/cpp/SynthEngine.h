@@ -1,30 +1,74 @@
 #ifndef NOISYSYNTH_SYNTHENGINE_H
 #define NOISYSYNTH_SYNTHENGINE_H
 
-#include <oboe/Oboe.h>
+#include "AudioBackend.h"
+#include "AudioRing.h"
+#include "ControlRing.h"
+#include "DoubleBuffer.h"
+#include "LoopFreeze.h"
+#include "MidiFile.h"
+#include "Noise.h"
+#include "ModMatrix.h"
+#include "PresetBank.h"
+#include "QualityGovernor.h"
+#include "Random.h"
+#include "Recorder.h"
+#include "RenderTrace.h"
+#include "Resampler.h"
+#include "Sequencer.h"
+#include "SynthParams.h"
+#include "Tuning.h"
+#include "VisualTaps.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <memory>
 #include <cmath>
 #include <algorithm>
 
 constexpr int kMaxVoices = 8;
-constexpr float kSampleRate = 48000.0f;
+constexpr int kMaxParts = 8;                   // multi-timbral parts sharing the voice pool
+constexpr float kSampleRate = 48000.0f;        // internal rate; see SynthEngine::setRenderRateMode
+constexpr int32_t kDefaultMaxBlockSize = 1024;
 constexpr float kPI = 3.14159265358979323846f;
+constexpr uint32_t kControlRingCapacity = 1024;
+
+// Render-ahead mode (see SynthEngine::setRenderAheadEnabled)
+constexpr float kRenderAheadSeconds = 0.3f;          // target depth of the ahead buffer
+constexpr float kRenderAheadIdleSeconds = 2.0f;      // no live note for this long before switching
+constexpr int32_t kRenderAheadChunkFrames = 256;     // frames per render on the ahead thread
+constexpr int32_t kRenderAheadCrossfadeFrames = 256; // ahead -> just-in-time crossfade
+constexpr size_t kRenderAheadCapacity = 32768;       // samples, > 0.3 s at 96 kHz
 
 enum class Waveform {
     SINE = 0,
     SAWTOOTH = 1,
     SQUARE = 2,
-    TRIANGLE = 3
+    TRIANGLE = 3,
+    NOISE = 4,        // white
+    PINK_NOISE = 5
 };
 
-enum class SequencerStepLength {
-    Eighth = 0,
-    Quarter = 1,
-    Half = 2,
-    Whole = 3
+/**
+ * How the engine meets a device that does not run at kSampleRate
+ */
+enum class RenderRateMode : int32_t {
+    Native = 0,     // render at the device rate
+    Internal = 1    // render at kSampleRate and resample to the device rate
 };
 
+/**
+ * Per-part send levels into the shared effects bus
+ */
+enum class PartSend : int32_t {
+    Chorus = 0,
+    Delay = 1,
+    Reverb = 2,
+    Count
+};
+constexpr int kPartSendCount = static_cast<int>(PartSend::Count);
+
 /**
  * ADSR Envelope Generator
  */
@@ -42,11 +86,14 @@ public:
         , releaseStartLevel_(0.0f)
     {}
 
-    // Minimum times chosen to avoid zipper/clicks even at very short notes
-    void setAttack(float attack)  { attack_  = std::max(0.0001f, attack); }   // >= 0.1 ms
-    void setDecay(float decay)    { decay_   = std::max(0.0001f, decay); }
+    void prepare(float sampleRate) { dt_ = 1.0f / sampleRate; }
+
+    // Minimum times chosen to avoid zipper/clicks even at very short notes.
+    // The reciprocals keep divisions out of process().
+    void setAttack(float attack)  { attack_  = std::max(0.0001f, attack);  invAttack_ = 1.0f / attack_; }   // >= 0.1 ms
+    void setDecay(float decay)    { decay_   = std::max(0.0001f, decay);   invDecay_ = 1.0f / decay_; }
     void setSustain(float sustain){ sustain_ = std::max(0.0f, std::min(1.0f, sustain)); }
-    void setRelease(float release){ release_ = std::max(0.005f,  release); }  // >= 5 ms
+    void setRelease(float release){ release_ = std::max(0.005f,  release); invRelease_ = 1.0f / release_; }  // >= 5 ms
 
     void noteOn() {
         // Start a new attack from the CURRENT level to keep continuity
@@ -55,6 +102,13 @@ public:
         time_ = 0.0f;
     }
 
+    // Straight to idle, with no release
+    void reset() {
+        phase_ = Phase::IDLE;
+        level_ = 0.0f;
+        time_ = 0.0f;
+    }
+
     void noteOff() {
         if (phase_ != Phase::IDLE && phase_ != Phase::RELEASE) {
             // Release starts from the current level for smooth decay
@@ -64,9 +118,8 @@ public:
         }
     }
 
-    float process(float sampleRate) {
-        float dt = 1.0f / sampleRate;
-        time_ += dt;
+    float process() {
+        time_ += dt_;
         
         // Add a safety timeout - if we've been in any phase too long, force to idle
         const float MAX_PHASE_TIME = 10.0f; // 10 seconds max per phase
@@ -80,7 +133,7 @@ public:
         switch (phase_) {
             case Phase::ATTACK:
             {
-                float t = (attack_ > 0.0f) ? (time_ / attack_) : 1.0f;
+                float t = time_ * invAttack_;
                 t = std::max(0.0f, std::min(1.0f, t));
                 level_ = attackStartLevel_ + (1.0f - attackStartLevel_) * t;
                 if (time_ >= attack_) {
@@ -93,7 +146,7 @@ public:
 
             case Phase::DECAY:
             {
-                float t = (decay_ > 0.0f) ? (time_ / decay_) : 1.0f;
+                float t = time_ * invDecay_;
                 t = std::max(0.0f, std::min(1.0f, t));
                 // Exponential-ish decay from 1.0 down to sustain_
                 level_ = 1.0f - (1.0f - sustain_) * t;
@@ -110,7 +163,7 @@ public:
 
             case Phase::RELEASE:
             {
-                float t = (release_ > 0.0f) ? (time_ / release_) : 1.0f;
+                float t = time_ * invRelease_;
                 t = std::max(0.0f, std::min(1.0f, t));
                 // Smooth decay from the level at noteOff down to 0
                 level_ = releaseStartLevel_ * (1.0f - t);
@@ -151,6 +204,10 @@ private:
     float decay_;
     float sustain_;
     float release_;
+    float invAttack_ = 1.0f / 0.01f;
+    float invDecay_ = 1.0f / 0.1f;
+    float invRelease_ = 1.0f / 0.3f;
+    float dt_ = 1.0f / kSampleRate;
 
     Phase phase_;
     float level_;
@@ -176,30 +233,47 @@ public:
     void setResonance(float resonance) { 
         resonance_ = std::max(0.0f, std::min(1.0f, resonance)); 
     }
+
+    void prepare(float sampleRate) {
+        piOverSampleRate_ = kPI / sampleRate;
+        coefficientCountdown_ = 0;
+    }
+
+    // Recompute coefficients only every `interval` samples (1 = every sample)
+    void setCoefficientInterval(int interval) {
+        coefficientInterval_ = std::max(1, interval);
+    }
     
-    float process(float input, float sampleRate, float modulation = 0.0f) {
-        // Map cutoff (0-1) to frequency (20Hz - 12kHz) with exponential scaling
-        float minFreq = 20.0f;
-        float maxFreq = 12000.0f;
-        
-        // Apply modulation to cutoff
-        float modulatedCutoff = std::max(0.0f, std::min(1.0f, cutoff_ + modulation));
-        
-        // Exponential mapping for more musical control
-        float freq = minFreq * std::pow(maxFreq / minFreq, modulatedCutoff);
-        
-        // Calculate filter coefficient
-        float f = 2.0f * std::sin(kPI * freq / sampleRate);
-        f = std::min(f, 0.99f); // Clamp for stability
-        
-        // Map resonance to Q (quality factor) exponentially
-        constexpr float qMin = 0.707f;
-        constexpr float qMax = 12.0f;
-        float q = qMin * std::pow(qMax / qMin, resonance_);
-        
-        // For SVF, damping = 1/Q
-        float damp = 1.0f / q;
-        damp = std::max(0.05f, std::min(1.4f, damp));
+    float process(float input, float modulation = 0.0f, float resonanceMod = 0.0f) {
+        if (--coefficientCountdown_ <= 0) {
+            coefficientCountdown_ = coefficientInterval_;
+
+            // Map cutoff (0-1) to frequency (20Hz - 12kHz) with exponential scaling
+            float minFreq = 20.0f;
+            float maxFreq = 12000.0f;
+
+            // Apply modulation to cutoff
+            float modulatedCutoff = std::max(0.0f, std::min(1.0f, cutoff_ + modulation));
+
+            // Exponential mapping for more musical control
+            float freq = minFreq * std::pow(maxFreq / minFreq, modulatedCutoff);
+
+            // Calculate filter coefficient
+            f_ = 2.0f * std::sin(freq * piOverSampleRate_);
+            f_ = std::min(f_, 0.99f); // Clamp for stability
+
+            // Map resonance to Q (quality factor) exponentially
+            constexpr float qMin = 0.707f;
+            constexpr float qMax = 12.0f;
+            float resonance = std::max(0.0f, std::min(1.0f, resonance_ + resonanceMod));
+            float q = qMin * std::pow(qMax / qMin, resonance);
+
+            // For SVF, damping = 1/Q
+            damp_ = 1.0f / q;
+            damp_ = std::max(0.05f, std::min(1.4f, damp_));
+        }
+        float f = f_;
+        float damp = damp_;
         
         // CRITICAL FIX: Flush denormal numbers to zero
         // Denormals cause massive CPU spikes and crackling/distortion
@@ -248,32 +322,195 @@ private:
     float lowpass_;
     float bandpass_;
     float highpass_;
+    float f_ = 0.0f;
+    float damp_ = 1.0f;
+    float piOverSampleRate_ = kPI / kSampleRate;
+    int coefficientInterval_ = 1;
+    int coefficientCountdown_ = 0;
+};
+
+enum class LfoShape {
+    SINE = 0,
+    TRIANGLE = 1,
+    SAW = 2,
+    SQUARE = 3,
+    SAMPLE_AND_HOLD = 4
+};
+
+constexpr int kNumLfos = 4;
+constexpr int kControlRateInterval = 32;   // samples between LFO evaluations
+
+// Cycle length in beats for each tempo-sync division (index 0 = free running)
+// off, 1/32, 1/16T, 1/16, 1/8T, 1/8, 1/4T, 1/4, 1/2, 1 bar, 2 bars, 4 bars
+constexpr float kLfoSyncBeats[] = {
+    0.0f, 0.125f, 1.0f / 6.0f, 0.25f, 1.0f / 3.0f, 0.5f, 2.0f / 3.0f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f
 };
+constexpr int kLfoSyncDivisions = sizeof(kLfoSyncBeats) / sizeof(kLfoSyncBeats[0]);
 
 /**
- * LFO (Low Frequency Oscillator)
+ * Settings of one LFO slot, shared by its global instance and all per-voice instances
+ */
+struct LfoSettings {
+    LfoShape shape = LfoShape::SINE;
+    float rate = 2.0f;       // Hz when free running
+    int syncDivision = 0;    // index into kLfoSyncBeats, 0 = free
+    bool perVoice = false;   // per-voice instances restart on every note
+
+    float cycleHz(float tempoBpm) const {
+        if (syncDivision <= 0) {
+            return rate;
+        }
+        return (tempoBpm / 60.0f) / kLfoSyncBeats[syncDivision];
+    }
+};
+
+/**
+ * Control-rate LFO (Low Frequency Oscillator)
+ *
+ * The shape is only evaluated once every kControlRateInterval samples;
+ * in between, next() walks a linear ramp towards the following value.
+ * Square and sample-and-hold jump straight to the new value instead.
  */
 class LFO {
 public:
-    LFO() : phase_(0.0f), rate_(2.0f), amount_(0.0f) {}
-    
-    void setRate(float rate) { rate_ = std::max(0.1f, rate); }
-    void setAmount(float amount) { amount_ = std::max(0.0f, std::min(1.0f, amount)); }
-    
-    float process(float sampleRate) {
-        float output = std::sin(2.0f * kPI * phase_);
-        phase_ += rate_ / sampleRate;
+    explicit LFO(uint32_t seed = 0x9E3779B9u) : random_(seed) {}
+
+    void seed(uint32_t seed) { random_.setSeed(seed); }
+
+    void prepare(float sampleRate) { tickSeconds_ = kControlRateInterval / sampleRate; }
+
+    void reset() {
+        phase_ = 0.0f;
+        value_ = 0.0f;
+        step_ = 0.0f;
+        held_ = random_.nextBipolar();
+    }
+
+    // Advance one control interval; cycleHz comes from LfoSettings::cycleHz
+    void controlTick(LfoShape shape, float cycleHz) {
+        phase_ += cycleHz * tickSeconds_;
         if (phase_ >= 1.0f) {
-            phase_ -= 1.0f;
+            phase_ -= std::floor(phase_);
+            held_ = random_.nextBipolar();
+        }
+
+        float target = evaluate(shape);
+        if (shape == LfoShape::SQUARE || shape == LfoShape::SAMPLE_AND_HOLD) {
+            value_ = target;
+            step_ = 0.0f;
+        } else {
+            step_ = (target - value_) * (1.0f / kControlRateInterval);
         }
-        // Return bipolar output scaled by amount (-amount to +amount)
-        return output * amount_ * 0.5f; // Scale down for filter modulation
     }
-    
+
+    // Bipolar value for the current sample, -1..1
+    float next() {
+        float value = value_;
+        value_ += step_;
+        return value;
+    }
+
 private:
-    float phase_;
-    float rate_;
-    float amount_;
+    float evaluate(LfoShape shape) const {
+        switch (shape) {
+            case LfoShape::SINE:
+                return std::sin(2.0f * kPI * phase_);
+            case LfoShape::TRIANGLE:
+                return (phase_ < 0.5f) ? (4.0f * phase_ - 1.0f) : (3.0f - 4.0f * phase_);
+            case LfoShape::SAW:
+                return 2.0f * phase_ - 1.0f;
+            case LfoShape::SQUARE:
+                return (phase_ < 0.5f) ? 1.0f : -1.0f;
+            case LfoShape::SAMPLE_AND_HOLD:
+                return held_;
+        }
+        return 0.0f;
+    }
+
+    float phase_ = 0.0f;
+    float value_ = 0.0f;
+    float step_ = 0.0f;
+    float held_ = 0.0f;
+    float tickSeconds_ = kControlRateInterval / kSampleRate;
+    Random random_;
+};
+
+/**
+ * LFO values for one sample, as seen by the voices
+ */
+struct LfoFrame {
+    float globalValues[kNumLfos];
+    uint32_t perVoiceMask;   // bit n set: LFO n+1 runs per voice
+    float lfo1Amount;        // depth of the fixed LFO 1 -> cutoff path
+};
+
+/**
+ * Engine-wide pitch state handed to the voices once per control tick
+ */
+struct PitchControl {
+    float bendRatio;   // frequency ratio of the current pitch bend
+    float glideCoeff;  // fraction of the remaining glide covered per tick, 1 = none
+};
+
+constexpr float kGlideSnapOctaves = 0.0001f; // about 0.1 cent
+
+/**
+ * Per-note expression lanes (MPE style), addressed by MIDI note
+ */
+enum class NoteExpression : int32_t {
+    PitchBend = 0,   // semitones, -48..48
+    Pressure = 1,    // 0..1
+    Timbre = 2,      // 0..1
+    Count
+};
+constexpr int kNoteExpressionCount = static_cast<int>(NoteExpression::Count);
+constexpr float kExpressionSmoothing = 0.35f; // per control tick, about 2 ms at 48 kHz
+
+/**
+ * One expression lane of a voice. Updates only move the target; the lane
+ * follows it with a one-pole step per control tick and a linear ramp per
+ * sample, so touch jitter never reaches the audio as zipper noise.
+ */
+struct ExpressionLane {
+    float target = 0.0f;
+    float smoothed = 0.0f;   // value at the next control tick
+    float value = 0.0f;      // per-sample ramp position
+    float step = 0.0f;
+
+    void reset(float initial) {
+        target = smoothed = value = initial;
+        step = 0.0f;
+    }
+
+    void controlTick() {
+        smoothed += (target - smoothed) * kExpressionSmoothing;
+        step = (smoothed - value) * (1.0f / kControlRateInterval);
+    }
+
+    float next() {
+        float current = value;
+        value += step;
+        return current;
+    }
+};
+
+/**
+ * The part of a patch a voice takes over at note on. Each multi-timbral
+ * part has one; part 0's is the engine's own patch.
+ */
+struct PartPatch {
+    Waveform waveform = Waveform::SAWTOOTH;
+    float filterCutoff = 0.5f;
+    float filterResonance = 0.3f;
+    float attack = 0.01f;
+    float decay = 0.1f;
+    float sustain = 0.7f;
+    float release = 0.3f;
+    float filterAttack = 0.01f;
+    float filterDecay = 0.2f;
+    float filterSustain = 0.5f;
+    float filterRelease = 0.3f;
+    float filterEnvAmount = 0.5f;
 };
 
 /**
@@ -285,10 +522,27 @@ public:
               waveform_(Waveform::SAWTOOTH), clickSuppression_(0.0f), clickSuppressionSamples_(0),
               stopFadeoutSamples_(48) {}
     
-    void noteOn(int midiNote, Waveform waveform) {
+    // glideFromNote >= 0 starts the pitch at that note and glides to midiNote
+    void noteOn(int midiNote, Waveform waveform, float velocity, const TuningTable& tuning,
+                int glideFromNote = -1) {
+        midiNote = std::max(0, std::min(kTuningTableSize - 1, midiNote));
         midiNote_ = midiNote;
-        frequency_ = midiNoteToFrequency(midiNote);
+        noteFrequency_ = tuning.frequency[midiNote];
+        targetPitch_ = tuning.pitch[midiNote];
+        if (glideFromNote >= 0 && glideFromNote < kTuningTableSize && glideFromNote != midiNote) {
+            pitch_ = tuning.pitch[glideFromNote];
+            frequency_ = tuning.frequency[glideFromNote] * bendRatio_;
+        } else {
+            pitch_ = targetPitch_;
+            frequency_ = noteFrequency_ * bendRatio_;
+        }
+        frequencyStep_ = 0.0f;
+        expression_[static_cast<int>(NoteExpression::PitchBend)].reset(0.0f);
+        expression_[static_cast<int>(NoteExpression::Pressure)].reset(0.0f);
+        expression_[static_cast<int>(NoteExpression::Timbre)].reset(0.5f);
         waveform_ = waveform;
+        velocity_ = std::max(0.0f, std::min(1.0f, velocity));
+        keyTrack_ = (midiNote - 60) / 60.0f;
         active_ = true;
         
         // ALWAYS reset the envelopes on noteOn
@@ -305,6 +559,11 @@ public:
         
         // Reset the fadeout counter when starting a new note
         stopFadeoutSamples_ = 48;
+
+        // Per-voice LFOs restart with the note
+        for (auto& lfo : lfos_) {
+            lfo.reset();
+        }
         
         lastMidiNote_ = midiNote;
         wasRecentlyActive_ = true;
@@ -316,8 +575,100 @@ public:
         ampEnvelope_.noteOff();
         filterEnvelope_.noteOff();
     }
+
+    // Stop dead, without release or fade-out; for when the voice's sound
+    // is already accounted for, as in a frozen loop
+    void silence() {
+        active_ = false;
+        midiNote_ = -1;
+        ampEnvelope_.reset();
+        filterEnvelope_.reset();
+        stopFadeoutSamples_ = 0;
+        clickSuppressionSamples_ = 0;
+        wasRecentlyActive_ = false;
+    }
+
+    // Envelopes, filter and env amount; the waveform only changes at note on
+    void applyPatch(const PartPatch& patch) {
+        ampEnvelope_.setAttack(patch.attack);
+        ampEnvelope_.setDecay(patch.decay);
+        ampEnvelope_.setSustain(patch.sustain);
+        ampEnvelope_.setRelease(patch.release);
+        filterEnvelope_.setAttack(patch.filterAttack);
+        filterEnvelope_.setDecay(patch.filterDecay);
+        filterEnvelope_.setSustain(patch.filterSustain);
+        filterEnvelope_.setRelease(patch.filterRelease);
+        setFilterEnvelopeAmount(patch.filterEnvAmount);
+        filter_.setCutoff(patch.filterCutoff);
+        filter_.setResonance(patch.filterResonance);
+    }
+
+    // Multi-timbral part this voice was last started for
+    void setPart(int part) { part_ = part; }
+    int getPart() const { return part_; }
     
-    float process(float sampleRate, float lfoValue) {
+    // Cache everything that depends on the sample rate; not on the audio thread
+    void prepare(float sampleRate) {
+        invSampleRate_ = 1.0f / sampleRate;
+        ampEnvelope_.prepare(sampleRate);
+        filterEnvelope_.prepare(sampleRate);
+        filter_.prepare(sampleRate);
+        for (auto& lfo : lfos_) {
+            lfo.prepare(sampleRate);
+        }
+    }
+
+    // Per-voice LFOs and the noise oscillator
+    void seedRandom(uint32_t seed) {
+        for (int i = 0; i < kNumLfos; ++i) {
+            lfos_[i].seed(seed * 0x9E3779B9u + static_cast<uint32_t>(i));
+        }
+        noise_.seed(seed * 0x85EBCA6Bu + 0x27D4EB2Fu);
+    }
+
+    /**
+     * Control-rate step: per-voice LFOs, glide and pitch bend. The frequency
+     * for the next kControlRateInterval samples becomes a linear ramp, so
+     * the sample loop never evaluates exp2.
+     */
+    void controlTick(const LfoSettings* settings, uint32_t perVoiceMask, float tempoBpm,
+                     const PitchControl& pitch) {
+        for (int i = 0; i < kNumLfos; ++i) {
+            if (perVoiceMask & (1u << i)) {
+                lfos_[i].controlTick(settings[i].shape, settings[i].cycleHz(tempoBpm));
+            }
+        }
+
+        for (auto& lane : expression_) {
+            lane.controlTick();
+        }
+
+        float target;
+        float noteBend = expression_[static_cast<int>(NoteExpression::PitchBend)].smoothed * (1.0f / 12.0f);
+        if (pitch_ != targetPitch_ || noteBend != 0.0f) {
+            pitch_ += (targetPitch_ - pitch_) * pitch.glideCoeff;
+            if (std::fabs(targetPitch_ - pitch_) < kGlideSnapOctaves) {
+                pitch_ = targetPitch_;
+            }
+            // Only while gliding or bending this note
+            target = std::exp2(pitch_ + noteBend) * pitch.bendRatio;
+        } else {
+            target = noteFrequency_ * pitch.bendRatio;
+        }
+        frequencyStep_ = (target - frequency_) * (1.0f / kControlRateInterval);
+        bendRatio_ = pitch.bendRatio;
+    }
+
+    void setExpression(NoteExpression lane, float value) {
+        expression_[static_cast<int>(lane)].target = value;
+    }
+
+    /**
+     * Render one sample. VoiceModMask selects which mod matrix destinations
+     * are compiled in; with a mask of 0 this is exactly the plain voice path.
+     */
+    template <uint32_t VoiceModMask>
+    float processKernel(const LfoFrame& lfoFrame, const ModRouting& routing) {
         // Check if envelopes are done
         bool envelopesActive = ampEnvelope_.isActive() || filterEnvelope_.isActive();
         
@@ -339,11 +690,45 @@ public:
             stopFadeoutSamples_ = 48; // 1ms fade-out
         }
         
+        // Get envelope values
+        float ampEnvValue = ampEnvelope_.process();
+        float filterEnvValue = filterEnvelope_.process();
+
+        // LFO values: per-voice instances where enabled, else the global ones
+        float lfo[kNumLfos];
+        for (int l = 0; l < kNumLfos; ++l) {
+            lfo[l] = (lfoFrame.perVoiceMask & (1u << l)) ? lfos_[l].next() : lfoFrame.globalValues[l];
+        }
+        float lfoValue = lfo[0] * lfoFrame.lfo1Amount * 0.5f; // Scale down for filter modulation
+
+        // Modulation sources, only gathered when something is routed
+        float sources[kModSourceCount] = {};
+        if constexpr (VoiceModMask != 0) {
+            sources[static_cast<int>(ModSource::Lfo)] = lfo[0];
+            sources[static_cast<int>(ModSource::Lfo2)] = lfo[1];
+            sources[static_cast<int>(ModSource::Lfo3)] = lfo[2];
+            sources[static_cast<int>(ModSource::Lfo4)] = lfo[3];
+            sources[static_cast<int>(ModSource::AmpEnvelope)] = ampEnvValue;
+            sources[static_cast<int>(ModSource::FilterEnvelope)] = filterEnvValue;
+            sources[static_cast<int>(ModSource::Velocity)] = velocity_;
+            sources[static_cast<int>(ModSource::KeyTrack)] = keyTrack_;
+            // Pressure and timbre ramps only advance when something reads them
+            sources[static_cast<int>(ModSource::Pressure)] =
+                expression_[static_cast<int>(NoteExpression::Pressure)].next();
+            sources[static_cast<int>(ModSource::Timbre)] =
+                expression_[static_cast<int>(NoteExpression::Timbre)].next();
+        }
+        
         // Generate waveform
         float sample = generateWaveform();
         
-        // Advance phase
-        phase_ += frequency_ / sampleRate;
+        // Advance phase along the control-rate frequency ramp
+        float frequency = frequency_;
+        frequency_ += frequencyStep_;
+        if constexpr ((VoiceModMask & kModPitchBit) != 0) {
+            frequency *= std::exp2(routing.evaluate(ModDestination::Pitch, sources));
+        }
+        phase_ += frequency * invSampleRate_;
         if (phase_ >= 1.0f) {
             phase_ -= 1.0f;
         }
@@ -361,18 +746,24 @@ public:
             sample *= fadeout;
         }
         
-        // Get envelope values
-        float ampEnvValue = ampEnvelope_.process(sampleRate);
-        float filterEnvValue = filterEnvelope_.process(sampleRate);
-        
         // Combine LFO and filter envelope for filter modulation
         float filterMod = (filterEnvValue * filterEnvAmount_) + lfoValue;
+        if constexpr ((VoiceModMask & kModCutoffBit) != 0) {
+            filterMod += routing.evaluate(ModDestination::Cutoff, sources);
+        }
+        float resonanceMod = 0.0f;
+        if constexpr ((VoiceModMask & kModResonanceBit) != 0) {
+            resonanceMod = routing.evaluate(ModDestination::Resonance, sources);
+        }
         
         // Apply filter with modulation
-        sample = filter_.process(sample, sampleRate, filterMod);
+        sample = filter_.process(sample, filterMod, resonanceMod);
         
         // Apply amplitude envelope
         sample *= ampEnvValue;
+        if constexpr ((VoiceModMask & kModAmplitudeBit) != 0) {
+            sample *= std::max(0.0f, 1.0f + routing.evaluate(ModDestination::Amplitude, sources));
+        }
         
         return sample;
     }
@@ -432,25 +823,39 @@ private:
                 
             case Waveform::TRIANGLE:
                 return (t < 0.5f) ? (4.0f * t - 1.0f) : (3.0f - 4.0f * t);
+
+            case Waveform::NOISE:
+                return noise_.next(false);
+
+            case Waveform::PINK_NOISE:
+                return noise_.next(true);
                 
             default:
                 return 0.0f;
         }
     }
     
-    static float midiNoteToFrequency(int midiNote) {
-        return 440.0f * std::pow(2.0f, (midiNote - 69) / 12.0f);
-    }
-    
     float phase_;
-    float frequency_;
+    float frequency_;            // current frequency including bend and glide
+    float frequencyStep_ = 0.0f; // per-sample ramp towards the next control tick
+    float noteFrequency_ = 0.0f; // tuning table frequency of midiNote_
+    float pitch_ = 0.0f;         // log2(Hz) while gliding, before bend
+    float targetPitch_ = 0.0f;
+    float bendRatio_ = 1.0f;
+    float invSampleRate_ = 1.0f / kSampleRate;
     bool active_;
     int midiNote_;
+    int part_ = 0;
     Waveform waveform_;
     Envelope ampEnvelope_;
     Envelope filterEnvelope_;
     Filter filter_;
     float filterEnvAmount_ = 0.5f; // Default filter envelope amount
+    float velocity_ = 1.0f;
+    float keyTrack_ = 0.0f;
+    LFO lfos_[kNumLfos];
+    NoiseSource noise_;
+    ExpressionLane expression_[kNoteExpressionCount];
     
     // Click suppression
     int lastMidiNote_ = -1;
@@ -461,21 +866,57 @@ private:
 };
 
 /**
- * Main synthesizer engine using Oboe for audio output
+ * Main synthesizer engine. Audio output goes through an AudioBackend
+ * (Oboe on Android).
  */
-class SynthEngine : public oboe::AudioStreamDataCallback {
+class SynthEngine : public AudioCallback {
 public:
-    SynthEngine();
+    // startAudio = false builds an offline engine: no stream is opened and
+    // audio is pulled with render() instead
+    explicit SynthEngine(bool startAudio = true);
+    // Plays through backend; nullptr is the same as startAudio = false
+    explicit SynthEngine(std::unique_ptr<AudioBackend> backend);
     ~SynthEngine();
+
+    /**
+     * Cache every rate-dependent constant and size effect buffers for
+     * sampleRate. Allocates, so never on the audio thread; call it while
+     * nothing is rendering. Engines start prepared for kSampleRate, and a
+     * backend calls it again through onPrepare() whenever the device
+     * (re)negotiates its rate. Safe to repeat.
+     */
+    void prepare(float sampleRate, int32_t maxBlockSize);
+    float getSampleRate() const { return sampleRate_; }
     
-    // Audio callback
-    oboe::DataCallbackResult onAudioReady(
-        oboe::AudioStream *audioStream,
-        void *audioData,
-        int32_t numFrames) override;
+    // Audio callback. onPrepare() picks the render rate from the device
+    // rate and the RenderRateMode.
+    void onPrepare(float sampleRate, int32_t maxFramesPerBuffer) override;
+    void onAudioReady(float* output, int32_t numFrames) override;
+
+    /**
+     * Render at the device's native rate, or at kSampleRate followed by the
+     * polyphase resampler. Applies at the next onPrepare(); for the engine's
+     * own backend the stream is stopped (waiting for the last callback),
+     * re-prepared and restarted if it was running. Control thread only.
+     */
+    void setRenderRateMode(RenderRateMode mode);
+    RenderRateMode getRenderRateMode() const { return renderRateMode_; }
+    int32_t getDeviceSampleRate() const { return deviceSampleRate_.load(std::memory_order_relaxed); }
+    bool isResampling() const { return resampling_.load(std::memory_order_relaxed); }
+    // 0 when not resampling
+    double getResamplerLatencySeconds() const { return resamplerLatency_.load(std::memory_order_relaxed); }
+    // Smoothed resampler time as a fraction of the callback period
+    float getResamplerLoad() const { return resamplerLoad_.load(std::memory_order_relaxed); }
+
+    AudioBackend* getAudioBackend() const { return backend_.get(); }
+
+    // Renders numFrames of mono output at the prepared rate. Called by
+    // onAudioReady when live, or directly by an offline renderer. Blocks
+    // longer than the prepared maximum are split.
+    void render(float* output, int32_t numFrames);
     
     // Control methods
-    void noteOn(int midiNote);
+    void noteOn(int midiNote, float velocity = 1.0f);
     void noteOff(int midiNote);
     void setWaveform(int waveform);
     void setFilterCutoff(float cutoff);
@@ -491,6 +932,46 @@ public:
     void setFilterEnvelopeAmount(float amount);
     void setLFORate(float rate);
     void setLFOAmount(float amount);
+    // LFO slots are 0-based here; slot 0 is the LFO above
+    void setLfoRate(int lfo, float rate);
+    void setLfoShape(int lfo, int shape);
+    void setLfoSync(int lfo, int division);
+    void setLfoPerVoice(int lfo, bool perVoice);
+    void setGlideTime(float seconds);
+    void setPitchBendRange(float semitones);
+    // -1..1, scaled by the pitch bend range; applied at the next control tick
+    void setPitchBend(float bend);
+    // Per-note expression for the held voices playing midiNote; ignored if none
+    void setNoteExpression(int midiNote, NoteExpression lane, float value);
+
+    /**
+     * Multi-timbral parts. Each part has its own PartPatch, key range, MIDI
+     * channel, level and effect sends, but all parts take voices from the
+     * one pool and play into the one chorus -> delay -> reverb bus. Part 0
+     * is always on; it is the patch the plain setters, setParameter() and
+     * presets edit. noteOn()/noteOff() play every enabled part whose key
+     * range holds the note, so parts layer and split; partNoteOn() plays a
+     * single part, the way a sequencer track would.
+     *
+     * These change the voice pool and the mix, so call them from the
+     * rendering thread only; the UI sends them through the control ring.
+     */
+    void setPartEnabled(int part, bool enabled);
+    bool isPartEnabled(int part) const;
+    void setPartKeyRange(int part, int lowNote, int highNote);
+    // MIDI file channel (0-15) the part answers to, -1 = all
+    void setPartMidiChannel(int part, int channel);
+    void setPartLevel(int part, float level);
+    // 0..1. The rest of the part's dry signal skips that effect; what earlier
+    // effects return always passes through the later ones.
+    void setPartSend(int part, PartSend send, float level);
+    // Only the per-voice parameters (Waveform .. FilterEnvAmount) exist per part
+    void setPartParameter(int part, ParamId id, float value);
+    float getPartParameter(int part, ParamId id) const;
+    void setPartPatch(int part, const SynthParams& params);
+    bool applyPartPreset(int part, int index);
+    void partNoteOn(int part, int midiNote, float velocity = 1.0f);
+    void partNoteOff(int part, int midiNote);
      void setDelayEnabled(bool enabled);
     void setDelayTime(float time);
     void setDelayFeedback(float feedback);
@@ -510,25 +991,206 @@ public:
     void setArpeggiatorGate(float gate);
     void setArpeggiatorSubdivision(int subdivision);
 
+    /**
+     * Step sequencer (see Sequencer.h): kSequencerMaxTracks tracks of chord
+     * steps with velocity and gate, kSequencerMaxPatterns patterns, looped
+     * one at a time or chained into a song. The setters edit a control
+     * thread copy and publish it whole; the audio thread switches to it at
+     * the start of its next block, so playback never sees half an edit and
+     * nothing is allocated. Call them from one thread at a time.
+     *
+     * Steps fire on their exact sample. A new selected pattern or song
+     * takes over when the playing pattern ends.
+     */
     void setSequencerEnabled(bool enabled);
+    // kSequencerMinTempo..kSequencerMaxTempo BPM; also the tempo synced LFOs
+    // follow. Picked up at the next block.
     void setSequencerTempo(float bpm);
+    // These three edit track 0 of the selected pattern
     void setSequencerStepLength(int stepLength);
     void setSequencerMeasures(int measures);
     void setSequencerStep(int index, int midiNote, bool active);
 
+    void setSequencerPatternLength(int pattern, int steps, int stepLength);
+    // noteCount 0 makes the step a rest. velocity 0..1, gate 0..1 of the step.
+    void setSequencerChordStep(int pattern, int track, int step, const int* notes, int noteCount,
+                               float velocity, float gate);
+    void clearSequencerPattern(int pattern);
+    void copySequencerPattern(int from, int to);
+    // part -1 plays the track like noteOn(), through every matching part
+    void setSequencerTrack(int track, int part, bool muted);
+    void selectSequencerPattern(int pattern);
+    // Slot i plays patterns[i] repeats[i] times; the song loops
+    void setSequencerSong(const int* patterns, const int* repeats, int length);
+    void setSequencerSongMode(bool enabled);
+
+    /*
+     * Automation lanes (SequencerLane): per-step parameter locks, applied
+     * through setParameter() or setPartParameter() when their step starts,
+     * and glides between them every kSequencerAutomationInterval samples.
+     * part -1 automates the patch setParameter() edits. A parameter leaves
+     * its lock for the value it had before, or for the last value the
+     * control ring gave it meanwhile.
+     */
+    // param -1 frees the lane. Returns false if another lane of the pattern has the parameter.
+    bool setSequencerLane(int pattern, int lane, int param, int part, bool glide);
+    // Uses the parameter's lane, taking a free one if it has none. Returns false if none is free.
+    bool setSequencerParameterLock(int pattern, int step, ParamId id, int part, float value);
+    void clearSequencerParameterLock(int pattern, int step, ParamId id, int part);
+    // Locks the parameter on the step playing now; for recording knob moves
+    bool recordSequencerParameter(ParamId id, int part, float value);
+
+    // The control thread's copy, including edits not yet picked up
+    const SequencerBank& getSequencerBank() const { return *sequencerEdit_; }
+
+    // Reseeds every random source of this engine (random arpeggio, LFO
+    // sample and hold), so a render can be repeated exactly. Every engine
+    // starts from the same fixed seeds.
+    void setRandomSeed(uint32_t seed);
+
+    // Parameter snapshot access by ParamId. The live patch belongs to the
+    // rendering thread (the app's writes arrive through the control ring),
+    // so read it from there too, never from the UI while audio runs.
+    void setParameter(ParamId id, float value);
+    float getParameter(ParamId id) const;
+    void applyParams(const float* values, int count);
+    SynthParams getParams() const;
+
+    // Preset bank (memory-mapped, see PresetBank.h)
+    bool loadPresetBank(const char* path);
+    bool applyPreset(int index);
+    // Preset values with defaults for parameters the bank predates. The UI
+    // sends them through the control ring rather than calling applyPreset().
+    bool getPresetParams(int index, SynthParams& params) const;
+    const PresetBank& getPresetBank() const { return presetBank_; }
+
+    // Batched control path: the UI writes ControlEvents into this ring
+    // (exposed to Kotlin as a direct ByteBuffer) and commits them in one go.
+    // They are applied at the start of the next audio callback.
+    ControlRing& getControlRing() { return controlRing_; }
+    bool commitControlEvents(uint32_t writeIndex);
+
+    // Render-ahead mode. When enabled and only the sequencer, arpeggiator or a
+    // MIDI file has been playing for a while with no UI input, a background
+    // thread renders up to kRenderAheadSeconds ahead and the audio callback
+    // just copies. Any committed control event switches back to rendering in
+    // the callback; the timeline then skips forward by the buffered audio.
+    void setRenderAheadEnabled(bool enabled);
+    bool isRenderingAhead() const {
+        return renderMode_.load(std::memory_order_relaxed) == static_cast<int>(RenderMode::Ahead);
+    }
+    uint32_t getRenderAheadUnderruns() const { return renderAheadUnderruns_.load(std::memory_order_relaxed); }
+
+    // Loop freeze (see LoopFreeze.h): while the sequencer loops and nothing
+    // that shapes the voices changes, replay one loop's dry voice mix from
+    // a cache instead of running the voices. Effects stay live. The first
+    // enable allocates the cache, so call it from the control thread.
+    void setLoopFreezeEnabled(bool enabled);
+    LoopFreezeState getLoopFreezeState() const {
+        return static_cast<LoopFreezeState>(loopFreezeState_.load(std::memory_order_relaxed));
+    }
+
+    // Visualization taps (see VisualTaps.h): scope, meter and spectrum
+    // frames for the UI. Enabling creates them the first time and starts
+    // their analysis thread, so call it from the control thread.
+    void setVisualTapsEnabled(bool enabled);
+    // Null until first enabled, then kept for the lifetime of the engine
+    VisualTaps* getVisualTaps() { return visualTaps_.get(); }
+
+    // Streaming recorder (see Recorder.h): writes what the device plays to a
+    // WAV file from a background thread. Start and stop block on file I/O;
+    // call all of these from the control thread.
+    bool startRecording(const std::string& path, WavSampleFormat format = WavSampleFormat::Float32);
+    bool stopRecording();
+    bool isRecording() const { return recorderEnabled_.load(std::memory_order_relaxed); }
+    RecorderStats getRecorderStats() const;
+
+    // Adaptive quality (see QualityGovernor.h). Readable from any thread.
+    void setQualityGovernorEnabled(bool enabled) { governorEnabled_.store(enabled, std::memory_order_relaxed); }
+    QualityTier getQualityTier() const {
+        return static_cast<QualityTier>(qualityTier_.load(std::memory_order_relaxed));
+    }
+    float getRenderLoad() const { return renderLoad_.load(std::memory_order_relaxed); }
+    float getPeakRenderLoad() const { return peakRenderLoad_.load(std::memory_order_relaxed); }
+
+    // Standard MIDI File playback. Loading parses into whichever of the two
+    // preallocated sequences the audio thread is not reading, then hands it
+    // over at the next callback. Events are played at exact sample offsets.
+    bool loadMidiFile(const char* path);
+    void startMidiPlayback(bool loop);
+    void stopMidiPlayback();
+    bool isMidiPlaying() const { return midiPlaying_.load(std::memory_order_relaxed); }
+
+    // Tuning. The table is rebuilt on the calling thread into the copy the
+    // audio thread is not reading and handed over at the next callback, the
+    // same way as MIDI files. Sounding notes keep their pitch; new notes use
+    // the new table. Each call returns false while a previous one has not
+    // been picked up yet.
+    bool loadScalaTuning(const char* sclPath, const char* kbmPath);
+    bool setTuningReference(float referenceHz);
+    bool resetTuning();
 
 private:
+    enum class RenderMode : int { JustInTime = 0, Ahead = 1 };
+
+    void renderForStream(float* output, int32_t numFrames);
+    void recordOutput(const float* output, int32_t numFrames);
+    void renderBlock(float* output, int32_t numFrames);
+    bool canRenderAhead() const;
+    void startRenderingAhead();
+    void finishHandover(float* output, int32_t numFrames);
+    void renderAheadLoop();
+    void stopRenderAheadThread();
+    void updateQualityGovernor(double renderSeconds, int32_t numFrames);
+    void applyQualityTier(QualityTier tier);
+
     Voice* findFreeVoice();
-    Voice* findVoiceForNote(int midiNote);
+    Voice* findVoiceForNote(int part, int midiNote);
 
-    float processDelay(float input, float sampleRate);
-    float processChorus(float input, float sampleRate);
-    float processReverb(float input, float sampleRate);
+    // Bit n set: part n; channel -1 matches every part
+    uint32_t routeNote(int midiNote, int channel) const;
+    void noteOnRouted(int midiNote, float velocity, int channel);
+    void noteOffRouted(int midiNote, int channel);
+    void startPartVoice(int part, int midiNote, float velocity);
+    void releaseNote(int midiNote, uint32_t parts);
+    void updatePartMixing();
+    float mixPartSend(PartSend send, float effectMix, const float* partSums, float* dryGains) const;
+
+    float processDelay(float input);
+    float processChorus(float input);
+    float processReverb(float input);
     void initializeEffects(float sampleRate);
-    void processArpeggiator(float sampleRate, int32_t numFrames);  // FIXED: Now takes numFrames
-    void processSequencer(float sampleRate, int32_t numFrames);     // FIXED: Now takes numFrames
-    void configureSequenceLength();
-    int getStepsPerMeasure() const;
+    void processControlEvents();
+    void processTuningUpdate();
+    bool publishTuning();
+    void processMidiTransport();
+    int32_t processMidiEvents(int32_t frame, int32_t numFrames);
+    void releaseMidiNotes();
+    void renderFrames(float* output, int32_t start, int32_t end);
+    void processControlTick();
+    template <uint32_t VoiceModMask>
+    void renderFramesKernel(float* output, int32_t start, int32_t end);
+    using RenderKernel = void (SynthEngine::*)(float*, int32_t, int32_t);
+    static const RenderKernel kRenderKernels[kVoiceModKernelCount];
+    void processArpeggiator(int32_t numFrames);  // FIXED: Now takes numFrames
+    void processSequencerTransport();
+    int32_t processSequencerEvents(int32_t frame, int32_t numFrames);
+    void startSequencerStep(const SequencerBank& bank);
+    void advanceSequencerStep(const SequencerBank& bank);
+    void releaseSequencerTrack(int track);
+    void releaseSequencerNotes();
+    void publishSequencer();
+    SequencerPattern* editSequencerPattern(int pattern);
+    int findSequencerLane(const SequencerPattern& pattern, int param, int part) const;
+    void startSequencerLanes(const SequencerPattern& pattern);
+    void glideSequencerLanes(float position);
+    void restoreSequencerLanes();
+    void updateSequencerLaneBase(int param, int part, float value);
+    void writeSequencerParameter(int param, int part, float value);
+    void applyParameter(ParamId id, float value);
+    void applyPartParameter(int part, ParamId id, float value);
+    void processLoopFreeze();
+    void invalidateLoopFreeze() { loopFreezeInvalid_.store(true, std::memory_order_release); }
 
     struct CombFilter {
         std::vector<float> buffer;
@@ -541,21 +1203,63 @@ private:
         size_t index = 0;
     };
     
-    std::shared_ptr<oboe::AudioStream> stream_;
+    std::unique_ptr<AudioBackend> backend_;
+    // Set by prepare(); read on the audio thread instead of dividing per sample
+    float sampleRate_ = kSampleRate;
+    float invSampleRate_ = 1.0f / kSampleRate;
+    float samplesPerMs_ = kSampleRate / 1000.0f;
+    int32_t maxBlockSize_ = kDefaultMaxBlockSize;
+
+    // Device rate handling (see setRenderRateMode). The resampler and its
+    // scratch belong to the audio thread between prepares.
+    std::mutex prepareLock_;
+    RenderRateMode renderRateMode_ = RenderRateMode::Native;   // written under prepareLock_
+    int32_t deviceMaxFrames_ = kDefaultMaxBlockSize;           // prepareLock_
+    std::atomic<int32_t> deviceSampleRate_{static_cast<int32_t>(kSampleRate)};
+    PolyphaseResampler resampler_;
+    std::vector<float> resamplerInput_;
+    bool resamplerActive_ = false;
+    std::atomic<bool> resampling_{false};
+    std::atomic<double> resamplerLatency_{0.0};
+    std::atomic<float> resamplerLoad_{0.0f};
+    float resamplerLoadSmoothed_ = 0.0f;
     std::vector<Voice> voices_;
-    Waveform currentWaveform_;
-    float filterCutoff_;
-    float filterResonance_;
-    float attack_;
-    float decay_;
-    float sustain_;
-    float release_;
-    float filterAttack_;
-    float filterDecay_;
-    float filterSustain_;
-    float filterRelease_;
-    float filterEnvAmount_;
-    LFO lfo_;
+
+    struct Part {
+        PartPatch patch;
+        bool enabled = false;
+        int lowNote = 0;
+        int highNote = 127;
+        int midiChannel = -1;
+        float level = 1.0f;
+        float sends[kPartSendCount] = {1.0f, 1.0f, 1.0f};
+        int glideFromNote = -1;
+    };
+    Part parts_[kMaxParts];
+    uint8_t noteParts_[128] = {};  // parts each sounding note was started on
+    static_assert(kMaxParts <= 8, "noteParts_ holds one bit per part");
+    int partCount_ = 1;            // highest enabled part + 1
+    // Off while part 0 plays alone at unity level and full sends; the
+    // render loop then skips the per-part sums
+    bool partMixing_ = false;
+    // LFO slot settings, their global instances and the fixed LFO 1 -> cutoff depth
+    LfoSettings lfoSettings_[kNumLfos];
+    LFO globalLfos_[kNumLfos] = {LFO(0x12345678u), LFO(0x2545F491u), LFO(0x6C078965u), LFO(0x5851F42Du)};
+    uint32_t perVoiceLfoMask_ = 0;
+    float lfoAmount_ = 0.0f;
+    int controlCountdown_ = 0;
+    // Pitch bend and glide; ratio and coefficient are only recomputed on change
+    float pitchBend_ = 0.0f;
+    float pitchBendRange_ = 2.0f;
+    float glideTime_ = 0.0f;
+    PitchControl pitchControl_ = {1.0f, 1.0f};
+    float pitchControlBend_ = 0.0f;
+    float pitchControlGlideTime_ = 0.0f;
+    ModMatrix modMatrix_;
+    // Offsets from global mod matrix destinations, refreshed per frame
+    float delayMixMod_ = 0.0f;
+    float chorusDepthMod_ = 0.0f;
+    float reverbMixMod_ = 0.0f;
     bool delayEnabled_;
     float delayTime_;
     float delayFeedback_;
@@ -584,26 +1288,118 @@ private:
     float arpeggiatorRateBpm_ = 120.0f;
     float arpeggiatorGate_ = 0.5f;
     float arpeggiatorStepMultiplier_ = 1.0f;
+    int arpeggiatorSubdivision_ = 1;
     std::vector<int> heldNotes_;
     float arpSampleCounter_ = 0.0f;
     int arpIndex_ = 0;
     int currentArpNote_ = -1;
     bool arpNoteActive_ = false;
     bool arpStepStarted_ = false;
+    Random random_;
 
-    bool sequencerEnabled_ = false;
-    float sequencerTempoBpm_ = 120.0f;
-    SequencerStepLength sequencerStepLength_ = SequencerStepLength::Eighth;
+    std::atomic<bool> sequencerEnabled_{false};
+    std::atomic<float> sequencerTempo_{120.0f};   // control side, see setSequencerTempo()
+    float sequencerTempoBpm_ = 120.0f;            // audio thread, read at block start
+
+    // Control side: the copy being edited, and measures for the legacy setters
+    std::unique_ptr<SequencerBank> sequencerEdit_;
     int sequencerMeasures_ = 4;
-    struct SequencerStep { int midiNote; bool active; };
-    std::vector<SequencerStep> sequencerSteps_;
-    float sequencerSampleCounter_ = 0.0f;
-    int sequencerCurrentStep_ = 0;
-    int sequencerActiveNote_ = -1;
-    bool sequencerNoteActive_ = false;
+
+    // Audio side: the published copy and where playback is in it
+    DoubleBuffer<SequencerBank> sequencerBank_;
+    struct SequencerSounding {
+        uint8_t notes[kSequencerMaxChordNotes];
+        int noteCount = 0;
+        int part = -1;
+        float gate = 0.0f;
+    };
+    SequencerSounding sequencerSounding_[kSequencerMaxTracks];
+    bool sequencerRunning_ = false;
     bool sequencerStepStarted_ = false;
+    int sequencerPattern_ = 0;
+    int sequencerStep_ = 0;
+    int sequencerSongSlot_ = 0;
+    int sequencerRepeat_ = 0;
+    double sequencerPosition_ = 0.0;   // samples into the current step at the block start
+    std::atomic<int32_t> sequencerPlayhead_{-1};   // pattern * kSequencerMaxSteps + step, -1 = stopped
+
+    // Parameters the lanes hold, by lane slot, and what they go back to
+    struct SequencerLaneState {
+        int param = -1;
+        int part = -1;
+        float base = 0.0f;
+        float from = 0.0f;
+        float to = 0.0f;
+        bool gliding = false;
+    };
+    SequencerLaneState sequencerLanes_[kSequencerMaxLanes];
+    int sequencerGlidingLanes_ = 0;
+    double sequencerNextGlide_ = 0.0;  // position in the step of the next glide point
+
+    LoopFreeze loopFreeze_;                         // audio thread, after allocate()
+    std::atomic<bool> loopFreezeEnabled_{false};
+    std::atomic<bool> loopFreezeInvalid_{false};    // something the cached loop depends on changed
+    std::atomic<int> loopFreezeState_{0};           // LoopFreezeState, for the UI
+
+    std::unique_ptr<VisualTaps> visualTaps_;        // created before visualTapsEnabled_ is first set
+    std::atomic<bool> visualTapsEnabled_{false};
+    bool visualTapping_ = false;                    // audio thread: taps on for this block
+    std::vector<float> tapVoices_ = std::vector<float>(kDefaultMaxBlockSize);    // VisualTap::Voices, this block
+    std::vector<float> tapEffects_ = std::vector<float>(kDefaultMaxBlockSize);   // VisualTap::Effects
+
+    std::unique_ptr<Recorder> recorder_;            // created before recorderEnabled_ is first set
+    std::atomic<bool> recorderEnabled_{false};
+
+    TraceStages traceStages_;                       // rendering thread; empty without NOISYSYNTH_TRACE
+
     bool suppressArpCapture_ = false;
 
+    PresetBank presetBank_;
+    ControlRing controlRing_{kControlRingCapacity};
+
+    enum class MidiCommand : int { None = 0, Start, StartLooping, Stop };
+    MidiSequence midiSequences_[2];
+    std::atomic<int> midiLoadedSequence_{-1};   // written by loader
+    std::atomic<int> midiPlayingSequence_{-1};  // acknowledged by audio thread
+    std::atomic<int> midiCommand_{0};
+    std::atomic<bool> midiPlaying_{false};
+    bool midiLooping_ = false;
+    size_t midiNextEvent_ = 0;
+    int64_t midiPosition_ = 0;                  // samples since playback start
+    uint16_t midiNotesOn_[128] = {};            // bit per channel
+
+    // Loader-side tuning sources and the two table copies
+    ScalaScale tuningScale_;
+    KeyboardMapping tuningMapping_;
+    TuningTable tuningTables_[2];
+    std::atomic<int> tuningLoadedTable_{0};   // written by loader
+    std::atomic<int> tuningActiveTable_{0};   // acknowledged by audio thread
+
+    // Render-ahead state. The engine is owned by the audio callback in
+    // JustInTime mode and by the ahead thread in Ahead mode; renderThreadBusy_
+    // tells the callback when the ahead thread has let go of it.
+    std::atomic<int> renderMode_{static_cast<int>(RenderMode::JustInTime)};
+    std::atomic<bool> renderAheadEnabled_{false};
+    std::atomic<bool> renderThreadBusy_{false};
+    std::atomic<bool> renderThreadRunning_{false};
+    std::atomic<bool> liveInput_{false};
+    std::atomic<uint32_t> renderAheadUnderruns_{0};
+    std::thread renderThread_;
+    AudioRing renderAheadRing_{kRenderAheadCapacity};
+    std::vector<float> renderAheadScratch_ = std::vector<float>(kRenderAheadChunkFrames);
+    int64_t idleFrames_ = 0;                     // callback frames since the last live note
+    bool handoverPending_ = false;               // switched back, ahead thread not yet idle
+
+    // Adaptive quality; governor_ and the applied settings belong to the audio thread
+    QualityGovernor governor_;
+    std::atomic<bool> governorEnabled_{true};
+    std::atomic<int> qualityTier_{static_cast<int>(QualityTier::Full)};
+    std::atomic<float> renderLoad_{0.0f};
+    std::atomic<float> peakRenderLoad_{0.0f};
+    int voiceLimit_ = kMaxVoices;
+    size_t reverbActiveCombs_ = 0;       // 0 = all
+    size_t reverbActiveAllpasses_ = 0;   // 0 = all
+
     // Output safety
     float outputGain_ = 0.55f;
     // Polyphony gain smoothing
@@ -0,0 +1,218 @@
+#ifndef NOISYSYNTH_SYNTHPARAMS_H
+#define NOISYSYNTH_SYNTHPARAMS_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Patch parameter identifiers
+ *
+ * Every sound parameter the engine exposes has a stable numeric ID. The IDs
+ * are stored in preset banks, so only ever APPEND new entries before Count;
+ * never reorder or remove existing ones.
+ */
+enum class ParamId : int32_t {
+    Waveform = 0,
+    FilterCutoff,
+    FilterResonance,
+    Attack,
+    Decay,
+    Sustain,
+    Release,
+    FilterAttack,
+    FilterDecay,
+    FilterSustain,
+    FilterRelease,
+    FilterEnvAmount,
+    LfoRate,
+    LfoAmount,
+    DelayEnabled,
+    DelayTime,
+    DelayFeedback,
+    DelayMix,
+    ChorusEnabled,
+    ChorusRate,
+    ChorusDepth,
+    ChorusMix,
+    ReverbEnabled,
+    ReverbSize,
+    ReverbDamping,
+    ReverbMix,
+    ArpEnabled,
+    ArpPattern,
+    ArpRate,
+    ArpGate,
+    ArpSubdivision,
+    ModRoute1Source,
+    ModRoute1Destination,
+    ModRoute1Amount,
+    ModRoute2Source,
+    ModRoute2Destination,
+    ModRoute2Amount,
+    ModRoute3Source,
+    ModRoute3Destination,
+    ModRoute3Amount,
+    ModRoute4Source,
+    ModRoute4Destination,
+    ModRoute4Amount,
+    ModRoute5Source,
+    ModRoute5Destination,
+    ModRoute5Amount,
+    ModRoute6Source,
+    ModRoute6Destination,
+    ModRoute6Amount,
+    ModRoute7Source,
+    ModRoute7Destination,
+    ModRoute7Amount,
+    ModRoute8Source,
+    ModRoute8Destination,
+    ModRoute8Amount,
+    Lfo1Shape,
+    Lfo1Sync,
+    Lfo1PerVoice,
+    Lfo2Rate,
+    Lfo2Shape,
+    Lfo2Sync,
+    Lfo2PerVoice,
+    Lfo3Rate,
+    Lfo3Shape,
+    Lfo3Sync,
+    Lfo3PerVoice,
+    Lfo4Rate,
+    Lfo4Shape,
+    Lfo4Sync,
+    Lfo4PerVoice,
+    GlideTime,
+    PitchBendRange,
+    Count
+};
+
+constexpr int kParamCount = static_cast<int>(ParamId::Count);
+
+// Modulation routes are stored as consecutive (source, destination, amount) triples
+constexpr int kModRouteParamStride = 3;
+constexpr ParamId kFirstModRouteParam = ParamId::ModRoute1Source;
+
+// LFOs 2-4 are stored as consecutive (rate, shape, sync, perVoice) groups
+constexpr int kLfoParamStride = 4;
+constexpr ParamId kFirstExtraLfoParam = ParamId::Lfo2Rate;
+
+struct ParamInfo {
+    const char* name;
+    float minValue;
+    float maxValue;
+    float defaultValue;
+};
+
+// Indexed by ParamId. Names are used by the text patch format of the CLI tools.
+inline constexpr ParamInfo kParamInfo[kParamCount] = {
+    {"waveform",          0.0f,   5.0f,   1.0f},
+    {"filterCutoff",      0.0f,   1.0f,   0.5f},
+    {"filterResonance",   0.0f,   1.0f,   0.3f},
+    {"attack",            0.0001f, 10.0f, 0.01f},
+    {"decay",             0.0001f, 10.0f, 0.1f},
+    {"sustain",           0.0f,   1.0f,   0.7f},
+    {"release",           0.005f, 10.0f,  0.3f},
+    {"filterAttack",      0.0001f, 10.0f, 0.01f},
+    {"filterDecay",       0.0001f, 10.0f, 0.2f},
+    {"filterSustain",     0.0f,   1.0f,   0.5f},
+    {"filterRelease",     0.005f, 10.0f,  0.3f},
+    {"filterEnvAmount",   0.0f,   1.0f,   0.5f},
+    {"lfoRate",           0.1f,   20.0f,  2.0f},
+    {"lfoAmount",         0.0f,   1.0f,   0.0f},
+    {"delayEnabled",      0.0f,   1.0f,   0.0f},
+    {"delayTime",         0.0f,   2.0f,   0.35f},
+    {"delayFeedback",     0.0f,   0.99f,  0.4f},
+    {"delayMix",          0.0f,   1.0f,   0.3f},
+    {"chorusEnabled",     0.0f,   1.0f,   0.0f},
+    {"chorusRate",        0.0f,   10.0f,  0.25f},
+    {"chorusDepth",       0.0f,   1.0f,   0.3f},
+    {"chorusMix",         0.0f,   1.0f,   0.25f},
+    {"reverbEnabled",     0.0f,   1.0f,   0.0f},
+    {"reverbSize",        0.0f,   1.0f,   0.6f},
+    {"reverbDamping",     0.0f,   1.0f,   0.35f},
+    {"reverbMix",         0.0f,   1.0f,   0.4f},
+    {"arpEnabled",        0.0f,   1.0f,   0.0f},
+    {"arpPattern",        0.0f,   3.0f,   0.0f},
+    {"arpRate",           20.0f,  300.0f, 120.0f},
+    {"arpGate",           0.05f,  1.0f,   0.5f},
+    {"arpSubdivision",    0.0f,   3.0f,   1.0f},
+    {"mod1Source",        0.0f,   10.0f,   0.0f},
+    {"mod1Destination",   0.0f,   7.0f,   0.0f},
+    {"mod1Amount",       -1.0f,   1.0f,   0.0f},
+    {"mod2Source",        0.0f,   10.0f,   0.0f},
+    {"mod2Destination",   0.0f,   7.0f,   0.0f},
+    {"mod2Amount",       -1.0f,   1.0f,   0.0f},
+    {"mod3Source",        0.0f,   10.0f,   0.0f},
+    {"mod3Destination",   0.0f,   7.0f,   0.0f},
+    {"mod3Amount",       -1.0f,   1.0f,   0.0f},
+    {"mod4Source",        0.0f,   10.0f,   0.0f},
+    {"mod4Destination",   0.0f,   7.0f,   0.0f},
+    {"mod4Amount",       -1.0f,   1.0f,   0.0f},
+    {"mod5Source",        0.0f,   10.0f,   0.0f},
+    {"mod5Destination",   0.0f,   7.0f,   0.0f},
+    {"mod5Amount",       -1.0f,   1.0f,   0.0f},
+    {"mod6Source",        0.0f,   10.0f,   0.0f},
+    {"mod6Destination",   0.0f,   7.0f,   0.0f},
+    {"mod6Amount",       -1.0f,   1.0f,   0.0f},
+    {"mod7Source",        0.0f,   10.0f,   0.0f},
+    {"mod7Destination",   0.0f,   7.0f,   0.0f},
+    {"mod7Amount",       -1.0f,   1.0f,   0.0f},
+    {"mod8Source",        0.0f,   10.0f,   0.0f},
+    {"mod8Destination",   0.0f,   7.0f,   0.0f},
+    {"mod8Amount",       -1.0f,   1.0f,   0.0f},
+    {"lfo1Shape",         0.0f,   4.0f,   0.0f},
+    {"lfo1Sync",          0.0f,   11.0f,  0.0f},
+    {"lfo1PerVoice",      0.0f,   1.0f,   0.0f},
+    {"lfo2Rate",          0.1f,   20.0f,  2.0f},
+    {"lfo2Shape",         0.0f,   4.0f,   0.0f},
+    {"lfo2Sync",          0.0f,   11.0f,  0.0f},
+    {"lfo2PerVoice",      0.0f,   1.0f,   0.0f},
+    {"lfo3Rate",          0.1f,   20.0f,  2.0f},
+    {"lfo3Shape",         0.0f,   4.0f,   0.0f},
+    {"lfo3Sync",          0.0f,   11.0f,  0.0f},
+    {"lfo3PerVoice",      0.0f,   1.0f,   0.0f},
+    {"lfo4Rate",          0.1f,   20.0f,  2.0f},
+    {"lfo4Shape",         0.0f,   4.0f,   0.0f},
+    {"lfo4Sync",          0.0f,   11.0f,  0.0f},
+    {"lfo4PerVoice",      0.0f,   1.0f,   0.0f},
+    {"glideTime",         0.0f,   5.0f,   0.0f},
+    {"pitchBendRange",    0.0f,   24.0f,  2.0f},
+};
+
+static_assert(kParamInfo[kParamCount - 1].name != nullptr, "kParamInfo is missing entries");
+
+inline const ParamInfo& getParamInfo(ParamId id) {
+    return kParamInfo[static_cast<int>(id)];
+}
+
+// Returns -1 if no parameter has this name
+inline int findParamByName(const char* name) {
+    for (int i = 0; i < kParamCount; ++i) {
+        if (std::strcmp(kParamInfo[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Flat snapshot of every patch parameter, indexed by ParamId.
+ * This is also the exact on-disk payload of a preset bank record.
+ */
+struct SynthParams {
+    float values[kParamCount];
+
+    SynthParams() { reset(); }
+
+    void reset() {
+        for (int i = 0; i < kParamCount; ++i) {
+            values[i] = kParamInfo[i].defaultValue;
+        }
+    }
+
+    float get(ParamId id) const { return values[static_cast<int>(id)]; }
+    void set(ParamId id, float value) { values[static_cast<int>(id)] = value; }
+};
+
+#endif // NOISYSYNTH_SYNTHPARAMS_H
@@ -0,0 +1,58 @@
+#ifndef NOISYSYNTH_TRIPLEBUFFER_H
+#define NOISYSYNTH_TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Three copies of a value for a writer that must never wait (the audio
+ * thread) and a reader that only wants the newest one (a UI frame).
+ *
+ * The writer fills back(), and publish() swaps it with the middle copy.
+ * The reader's acquire() swaps the middle copy with its own front copy,
+ * but only if something was published since it last looked. Neither side
+ * ever touches the copy the other one holds, so a frame the reader is
+ * drawing stays intact until its next acquire(), however far ahead the
+ * writer gets. Frames the reader does not come round for are overwritten.
+ *
+ * The copies sit back to back in frames(), so the whole block can be
+ * handed out as one buffer and a copy addressed by its index.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side: the copy being filled
+    T& back() { return frames_[back_]; }
+
+    // Writer side: hand back() over as the newest copy
+    void publish() {
+        back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader side: switch to the newest copy, if any. Returns the index of the reader's copy.
+    int acquire() {
+        if (middle_.load(std::memory_order_relaxed) & kFresh) {
+            front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        }
+        return front_;
+    }
+
+    const T* frames() const { return frames_; }
+    T* frames() { return frames_; }
+    static constexpr size_t kCopies = 3;
+
+private:
+    static constexpr int kFresh = 4;
+    static constexpr int kIndexMask = 3;
+
+    T frames_[kCopies] = {};
+    alignas(64) std::atomic<int> middle_{1};
+    int back_ = 0;    // writer
+    int front_ = 2;   // reader
+};
+
+#endif // NOISYSYNTH_TRIPLEBUFFER_H
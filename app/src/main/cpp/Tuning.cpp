@@ -0,0 +1,244 @@
+#include "Tuning.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+bool readTextFile(const char* path, std::string& text) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    text.clear();
+    char chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, read);
+    }
+    std::fclose(file);
+    return true;
+}
+
+/**
+ * Iterates the lines of a Scala file, skipping '!' comments.
+ * Returned lines have no line terminator and no leading whitespace.
+ */
+class ScalaLineReader {
+public:
+    ScalaLineReader(const char* text, size_t size) : text_(text), size_(size) {}
+
+    bool next(std::string& line) {
+        while (pos_ < size_) {
+            size_t end = pos_;
+            while (end < size_ && text_[end] != '\n') {
+                end++;
+            }
+            size_t start = pos_;
+            pos_ = end + 1;
+
+            while (start < end && (text_[start] == ' ' || text_[start] == '\t')) {
+                start++;
+            }
+            while (end > start && (text_[end - 1] == '\r' || text_[end - 1] == ' ' || text_[end - 1] == '\t')) {
+                end--;
+            }
+            if (start < end && text_[start] == '!') {
+                continue;
+            }
+            line.assign(text_ + start, end - start);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const char* text_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+bool parseInt(const std::string& line, int& value) {
+    char* end;
+    long parsed = std::strtol(line.c_str(), &end, 10);
+    if (end == line.c_str()) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// A pitch line is either cents (contains a '.') or a ratio "n/d" or "n"
+bool parsePitch(const std::string& line, double& cents) {
+    const char* text = line.c_str();
+    size_t length = std::strcspn(text, " \t");
+    if (std::memchr(text, '.', length) != nullptr) {
+        char* end;
+        cents = std::strtod(text, &end);
+        return end != text;
+    }
+
+    char* end;
+    long numerator = std::strtol(text, &end, 10);
+    if (end == text || numerator <= 0) {
+        return false;
+    }
+    long denominator = 1;
+    if (*end == '/') {
+        const char* start = end + 1;
+        denominator = std::strtol(start, &end, 10);
+        if (end == start || denominator <= 0) {
+            return false;
+        }
+    }
+    cents = 1200.0 * std::log2(static_cast<double>(numerator) / denominator);
+    return true;
+}
+
+int floorDiv(int a, int b) {
+    int q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Cents of a key relative to the middle note; false if the key is unmapped
+bool keyCents(const ScalaScale& scale, const KeyboardMapping& mapping, int key, double& cents) {
+    int offset = key - mapping.middleNote;
+    if (mapping.size <= 0) {
+        cents = scale.centsAt(offset);
+        return true;
+    }
+
+    int octave = floorDiv(offset, mapping.size);
+    int index = offset - octave * mapping.size;
+    int degree = (index < static_cast<int>(mapping.mapping.size())) ? mapping.mapping[index] : -1;
+    if (degree < 0) {
+        return false;
+    }
+    double octaveCents = (mapping.octaveDegree > 0) ? scale.centsAt(mapping.octaveDegree) : scale.periodCents();
+    cents = octave * octaveCents + scale.centsAt(degree);
+    return true;
+}
+
+} // namespace
+
+void TuningTable::setEqualTemperament(float referenceHz) {
+    for (int note = 0; note < kTuningTableSize; ++note) {
+        double hz = referenceHz * std::exp2((note - 69) / 12.0);
+        frequency[note] = static_cast<float>(hz);
+        pitch[note] = static_cast<float>(std::log2(hz));
+    }
+}
+
+bool ScalaScale::loadFile(const char* path) {
+    std::string text;
+    return readTextFile(path, text) && loadFromMemory(text.data(), text.size());
+}
+
+bool ScalaScale::loadFromMemory(const char* text, size_t size) {
+    ScalaLineReader reader(text, size);
+    std::string description;
+    std::string line;
+    int count = 0;
+
+    if (!reader.next(description) || !reader.next(line) || !parseInt(line, count) || count < 0
+        || count > kMaxScaleNotes) {
+        return false;
+    }
+
+    std::vector<double> cents;
+    cents.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        double value;
+        if (!reader.next(line) || !parsePitch(line, value)) {
+            return false;
+        }
+        cents.push_back(value);
+    }
+    if (count > 0 && cents.back() <= 0.0) {
+        return false; // the period must go up, or the scale never repeats
+    }
+
+    description_ = description;
+    cents_ = std::move(cents);
+    return true;
+}
+
+double ScalaScale::centsAt(int degree) const {
+    int count = size();
+    if (count == 0) {
+        return degree * 100.0;
+    }
+    int period = floorDiv(degree, count);
+    int index = degree - period * count;
+    return period * periodCents() + ((index == 0) ? 0.0 : cents_[index - 1]);
+}
+
+bool KeyboardMapping::loadFile(const char* path) {
+    std::string text;
+    return readTextFile(path, text) && loadFromMemory(text.data(), text.size());
+}
+
+bool KeyboardMapping::loadFromMemory(const char* text, size_t length) {
+    ScalaLineReader reader(text, length);
+    std::string line;
+    int header[5];
+    for (int& value : header) {
+        if (!reader.next(line) || !parseInt(line, value)) {
+            return false;
+        }
+    }
+    double frequency;
+    if (!reader.next(line) || (frequency = std::strtod(line.c_str(), nullptr)) <= 0.0) {
+        return false;
+    }
+    int octave;
+    if (!reader.next(line) || !parseInt(line, octave)) {
+        return false;
+    }
+    if (header[0] < 0 || header[0] > kMaxScaleNotes || header[1] < 0 || header[2] >= kTuningTableSize || header[1] > header[2]
+        || header[4] < 0 || header[4] >= kTuningTableSize) {
+        return false;
+    }
+
+    std::vector<int> degrees;
+    degrees.reserve(header[0]);
+    // Missing trailing entries are allowed and mean unmapped
+    while (static_cast<int>(degrees.size()) < header[0] && reader.next(line)) {
+        int degree;
+        if (line.empty() || line[0] == 'x' || line[0] == 'X' || !parseInt(line, degree) || degree < 0) {
+            degree = -1;
+        }
+        degrees.push_back(degree);
+    }
+
+    size = header[0];
+    firstNote = header[1];
+    lastNote = header[2];
+    middleNote = header[3];
+    referenceNote = header[4];
+    referenceFrequency = frequency;
+    octaveDegree = octave;
+    mapping = std::move(degrees);
+    return true;
+}
+
+bool buildTuningTable(const ScalaScale& scale, const KeyboardMapping& mapping, TuningTable& table) {
+    double referenceCents;
+    if (!keyCents(scale, mapping, mapping.referenceNote, referenceCents)) {
+        return false;
+    }
+
+    for (int note = 0; note < kTuningTableSize; ++note) {
+        double cents;
+        bool mapped = note >= mapping.firstNote && note <= mapping.lastNote
+            && keyCents(scale, mapping, note, cents);
+        if (!mapped) {
+            cents = referenceCents + (note - mapping.referenceNote) * 100.0;
+        }
+        double hz = mapping.referenceFrequency * std::exp2((cents - referenceCents) / 1200.0);
+        table.frequency[note] = static_cast<float>(hz);
+        table.pitch[note] = static_cast<float>(std::log2(hz));
+    }
+    return true;
+}
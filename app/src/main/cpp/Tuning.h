@@ -0,0 +1,77 @@
+#ifndef NOISYSYNTH_TUNING_H
+#define NOISYSYNTH_TUNING_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+constexpr int kTuningTableSize = 128;
+constexpr float kDefaultReferenceHz = 440.0f;
+// Most notes a .scl or .kbm may declare. The archive's largest scales have a
+// few thousand; a bigger count is a broken or hostile file.
+constexpr int kMaxScaleNotes = 8192;
+
+/**
+ * Frequency of every MIDI note, precomputed so note on is a table lookup.
+ * pitch[] holds the same values as log2(Hz), which is the domain glide
+ * interpolates in.
+ */
+struct TuningTable {
+    float frequency[kTuningTableSize];
+    float pitch[kTuningTableSize];
+
+    TuningTable() { setEqualTemperament(kDefaultReferenceHz); }
+
+    // 12-TET with A4 (note 69) at referenceHz
+    void setEqualTemperament(float referenceHz);
+};
+
+/**
+ * Scala scale (.scl): a list of pitches in cents above the unison. The last
+ * degree is the period the scale repeats at (usually 2/1 = 1200 cents).
+ */
+class ScalaScale {
+public:
+    bool loadFile(const char* path);
+    bool loadFromMemory(const char* text, size_t size);
+
+    const std::string& getDescription() const { return description_; }
+    int size() const { return static_cast<int>(cents_.size()); }
+
+    // Degree 0 is the unison; degrees beyond size() continue into the next period
+    double centsAt(int degree) const;
+    double periodCents() const { return cents_.empty() ? 1200.0 : cents_.back(); }
+
+private:
+    std::string description_;
+    std::vector<double> cents_;
+};
+
+/**
+ * Scala keyboard mapping (.kbm): which key plays which scale degree and
+ * which key sounds at the reference frequency. The default mapping is the
+ * linear one, middle C on degree 0 and A4 at 440 Hz.
+ */
+struct KeyboardMapping {
+    int size = 0;                  // 0 = linear, every key is the next degree
+    int firstNote = 0;
+    int lastNote = kTuningTableSize - 1;
+    int middleNote = 60;           // key of degree 0
+    int referenceNote = 69;
+    double referenceFrequency = kDefaultReferenceHz;
+    int octaveDegree = 0;          // 0 = the scale's own period
+    std::vector<int> mapping;      // degree per key of the pattern, -1 = unmapped
+
+    bool loadFile(const char* path);
+    bool loadFromMemory(const char* text, size_t length);
+};
+
+/**
+ * Fill table from a scale and mapping. Keys outside the mapped range and
+ * unmapped keys keep their 12-TET frequency relative to the reference.
+ * Meant for a non-audio thread. Returns false if the reference key itself
+ * is unmapped.
+ */
+bool buildTuningTable(const ScalaScale& scale, const KeyboardMapping& mapping, TuningTable& table);
+
+#endif // NOISYSYNTH_TUNING_H
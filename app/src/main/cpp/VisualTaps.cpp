@@ -0,0 +1,165 @@
+#include "VisualTaps.h"
+#include "Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// About one hop at 48 kHz, so a spectrum frame is rarely more than a hop old
+constexpr auto kAnalysisInterval = std::chrono::milliseconds(8);
+constexpr float kTwoPi = 6.28318530717958647692f;
+
+} // namespace
+
+VisualTaps::VisualTaps()
+    : history_(kSpectrumSize, 0.0f),
+      readScratch_(kSpectrumHop),
+      window_(kSpectrumSize),
+      real_(kSpectrumSize),
+      imag_(kSpectrumSize),
+      cosTable_(kSpectrumSize / 2),
+      sinTable_(kSpectrumSize / 2),
+      bitReverse_(kSpectrumSize) {
+    float windowSum = 0.0f;
+    for (int i = 0; i < kSpectrumSize; ++i) {
+        window_[i] = 0.5f - 0.5f * std::cos(kTwoPi * i / kSpectrumSize);
+        windowSum += window_[i];
+    }
+    // A sine of amplitude 1 peaks at windowSum / 2
+    windowGain_ = 2.0f / windowSum;
+
+    for (int i = 0; i < kSpectrumSize / 2; ++i) {
+        cosTable_[i] = std::cos(kTwoPi * i / kSpectrumSize);
+        sinTable_[i] = -std::sin(kTwoPi * i / kSpectrumSize);
+    }
+    int bits = 0;
+    while ((1 << bits) < kSpectrumSize) {
+        bits++;
+    }
+    for (int i = 0; i < kSpectrumSize; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse_[i] = static_cast<uint16_t>(reversed);
+    }
+}
+
+VisualTaps::~VisualTaps() {
+    stop();
+}
+
+void VisualTaps::start() {
+    if (running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // Whatever is left from the last run would show up as a stale spectrum
+    analysisRing_.discard();
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    historyPos_ = 0;
+    sinceAnalysis_ = 0;
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&VisualTaps::analysisLoop, this);
+}
+
+void VisualTaps::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void VisualTaps::write(const float* const taps[kVisualTapCount], int numFrames) {
+    int offset = 0;
+    while (offset < numFrames) {
+        ScopeFrame& frame = scope_.back();
+        int count = std::min(numFrames - offset, kScopeFrames - scopeFill_);
+        for (int t = 0; t < kVisualTapCount; ++t) {
+            std::memcpy(frame.samples[t] + scopeFill_, taps[t] + offset, sizeof(float) * count);
+        }
+        scopeFill_ += count;
+        offset += count;
+
+        if (scopeFill_ == kScopeFrames) {
+            for (int t = 0; t < kVisualTapCount; ++t) {
+                float energy = simd::peakAndEnergy(frame.samples[t], kScopeFrames, &frame.peak[t]);
+                frame.rms[t] = std::sqrt(energy / kScopeFrames);
+            }
+            frame.sequence = ++scopeSequence_;
+            frame.frameCount = kScopeFrames;
+            frame.sampleRate = sampleRate_.load(std::memory_order_relaxed);
+            frame.tapCount = kVisualTapCount;
+            scope_.publish();
+            scopeFill_ = 0;
+        }
+    }
+
+    // Dropped when the analysis thread is stopped or behind; it only wants the latest anyway
+    const float* output = taps[static_cast<int>(VisualTap::Output)];
+    analysisRing_.write(output, static_cast<size_t>(numFrames));
+}
+
+void VisualTaps::analysisLoop() {
+    while (running_.load(std::memory_order_acquire)) {
+        // Take everything queued; after a stall only the last kSpectrumSize of it matters
+        size_t count;
+        while ((count = analysisRing_.read(readScratch_.data(), readScratch_.size())) > 0) {
+            for (size_t i = 0; i < count; ++i) {
+                history_[historyPos_] = readScratch_[i];
+                historyPos_ = (historyPos_ + 1) & (kSpectrumSize - 1);
+            }
+            sinceAnalysis_ += static_cast<int>(count);
+        }
+        if (sinceAnalysis_ >= kSpectrumHop) {
+            analyse();
+            sinceAnalysis_ = 0;
+        }
+        std::this_thread::sleep_for(kAnalysisInterval);
+    }
+}
+
+void VisualTaps::analyse() {
+    // Oldest sample first, windowed, in bit-reversed order for the in-place FFT
+    for (int i = 0; i < kSpectrumSize; ++i) {
+        float sample = history_[(historyPos_ + i) & (kSpectrumSize - 1)];
+        int j = bitReverse_[i];
+        real_[j] = sample * window_[i];
+        imag_[j] = 0.0f;
+    }
+
+    // Radix-2 decimation in time
+    for (int size = 2; size <= kSpectrumSize; size <<= 1) {
+        int half = size >> 1;
+        int stride = kSpectrumSize / size;
+        for (int start = 0; start < kSpectrumSize; start += size) {
+            for (int k = 0; k < half; ++k) {
+                float wr = cosTable_[k * stride];
+                float wi = sinTable_[k * stride];
+                int a = start + k;
+                int b = a + half;
+                float tr = real_[b] * wr - imag_[b] * wi;
+                float ti = real_[b] * wi + imag_[b] * wr;
+                real_[b] = real_[a] - tr;
+                imag_[b] = imag_[a] - ti;
+                real_[a] += tr;
+                imag_[a] += ti;
+            }
+        }
+    }
+
+    SpectrumFrame& frame = spectrum_.back();
+    float sampleRate = sampleRate_.load(std::memory_order_relaxed);
+    for (int bin = 0; bin < kSpectrumBins; ++bin) {
+        float magnitude = std::sqrt(real_[bin] * real_[bin] + imag_[bin] * imag_[bin]) * windowGain_;
+        frame.magnitudeDb[bin] = (magnitude > 0.0f)
+            ? std::max(kSpectrumFloorDb, 20.0f * std::log10(magnitude))
+            : kSpectrumFloorDb;
+    }
+    frame.sequence = ++spectrumSequence_;
+    frame.binCount = kSpectrumBins;
+    frame.sampleRate = sampleRate;
+    frame.binHz = sampleRate / kSpectrumSize;
+    spectrum_.publish();
+}
@@ -0,0 +1,135 @@
+#ifndef NOISYSYNTH_VISUALTAPS_H
+#define NOISYSYNTH_VISUALTAPS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "AudioRing.h"
+#include "TripleBuffer.h"
+
+// Where in the signal chain a tap listens. Must match VisualTap in SynthParam.kt.
+enum class VisualTap : int32_t {
+    Voices = 0,    // the dry voice mix, before any effect
+    Effects = 1,   // after chorus, delay and reverb, before the master gain and limiter
+    Output = 2,    // what goes to the device
+    Count
+};
+constexpr int kVisualTapCount = static_cast<int>(VisualTap::Count);
+
+constexpr int kScopeFrames = 512;                    // samples per tap per scope frame
+constexpr int kSpectrumSize = 2048;                  // FFT length
+constexpr int kSpectrumBins = kSpectrumSize / 2;
+constexpr int kSpectrumHop = kSpectrumSize / 4;      // new samples between analyses
+constexpr float kSpectrumFloorDb = -120.0f;
+
+/*
+ * Frame layouts shared with Kotlin, which reads them straight out of a
+ * direct ByteBuffer in native byte order. The offsets are mirrored in
+ * SynthParam.kt; append only.
+ */
+struct ScopeFrame {
+    uint32_t sequence;                             // frames published so far, this one included
+    uint32_t frameCount;                           // kScopeFrames
+    float sampleRate;
+    uint32_t tapCount;                             // kVisualTapCount
+    float peak[kVisualTapCount];                   // largest |sample| in this frame
+    float rms[kVisualTapCount];
+    float samples[kVisualTapCount][kScopeFrames];
+};
+static_assert(offsetof(ScopeFrame, peak) == 16, "mirrored in SynthParam.kt");
+static_assert(offsetof(ScopeFrame, rms) == 28, "mirrored in SynthParam.kt");
+static_assert(offsetof(ScopeFrame, samples) == 40, "mirrored in SynthParam.kt");
+static_assert(sizeof(ScopeFrame) == 6184, "mirrored in SynthParam.kt");
+
+struct SpectrumFrame {
+    uint32_t sequence;
+    uint32_t binCount;                             // kSpectrumBins
+    float sampleRate;
+    float binHz;                                   // width of one bin
+    float magnitudeDb[kSpectrumBins];              // output tap; 0 dB is a full-scale sine
+};
+static_assert(offsetof(SpectrumFrame, magnitudeDb) == 16, "mirrored in SynthParam.kt");
+static_assert(sizeof(SpectrumFrame) == 4112, "mirrored in SynthParam.kt");
+
+/**
+ * Scope, meter and spectrum data for the UI, which takes the newest frame
+ * whenever it draws instead of asking the audio thread for anything.
+ *
+ * The audio thread hands every block of the three taps to write(). It
+ * copies them into the scope frame being filled and, each kScopeFrames
+ * samples, adds peak and RMS per tap and publishes the frame through a
+ * TripleBuffer. The output tap also goes into a ring for the analysis
+ * thread, which every kSpectrumHop samples runs a Hann-windowed FFT over
+ * the last kSpectrumSize and publishes the magnitudes the same way. When
+ * the analysis thread falls behind, it skips ahead; the audio thread never
+ * waits for it.
+ *
+ * Everything is allocated in the constructor, and write() neither
+ * allocates nor locks. start() and stop() run the analysis thread and
+ * block, so they belong on a control thread; acquire*() is for the one
+ * thread that reads the frames.
+ */
+class VisualTaps {
+public:
+    VisualTaps();
+    ~VisualTaps();
+
+    VisualTaps(const VisualTaps&) = delete;
+    VisualTaps& operator=(const VisualTaps&) = delete;
+
+    void start();
+    void stop();
+
+    // Before the stream starts, or from prepare()
+    void setSampleRate(float sampleRate) { sampleRate_.store(sampleRate, std::memory_order_relaxed); }
+
+    // Audio thread: one block of every tap, indexed by VisualTap
+    void write(const float* const taps[kVisualTapCount], int numFrames);
+
+    // Reader side: index of the newest frame in scopeFrames() / spectrumFrames()
+    int acquireScope() { return scope_.acquire(); }
+    int acquireSpectrum() { return spectrum_.acquire(); }
+
+    // Three frames back to back each; stable for the lifetime of this object
+    ScopeFrame* scopeFrames() { return scope_.frames(); }
+    SpectrumFrame* spectrumFrames() { return spectrum_.frames(); }
+    static constexpr size_t kScopeBytes = sizeof(ScopeFrame) * TripleBuffer<ScopeFrame>::kCopies;
+    static constexpr size_t kSpectrumBytes = sizeof(SpectrumFrame) * TripleBuffer<SpectrumFrame>::kCopies;
+
+private:
+    void analysisLoop();
+    void analyse();
+
+    TripleBuffer<ScopeFrame> scope_;
+    TripleBuffer<SpectrumFrame> spectrum_;
+    std::atomic<float> sampleRate_{48000.0f};
+
+    // Audio thread
+    int scopeFill_ = 0;
+    uint32_t scopeSequence_ = 0;
+
+    // Output tap, audio thread to analysis thread
+    AudioRing analysisRing_{kSpectrumSize * 4};
+
+    // Analysis thread
+    std::vector<float> history_;       // the last kSpectrumSize samples, circular
+    int historyPos_ = 0;
+    int sinceAnalysis_ = 0;
+    std::vector<float> readScratch_;
+    std::vector<float> window_;
+    float windowGain_ = 1.0f;          // dB reference: a full-scale sine's peak bin
+    std::vector<float> real_;
+    std::vector<float> imag_;
+    std::vector<float> cosTable_;
+    std::vector<float> sinTable_;
+    std::vector<uint16_t> bitReverse_;
+    uint32_t spectrumSequence_ = 0;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+};
+
+#endif // NOISYSYNTH_VISUALTAPS_H
@@ -0,0 +1,147 @@
+#include "WavWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t kWaveFormatPcm = 1;
+constexpr uint16_t kWaveFormatIeeeFloat = 3;
+constexpr uint32_t kHeaderSize = 44;           // RIFF, fmt and data chunk headers
+constexpr uint32_t kJunkChunkHeader = 8;
+constexpr int kConvertFrames = 1024;           // PCM conversion batch, on the stack
+
+void putU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+} // namespace
+
+bool WavWriter::open(const char* path, int32_t sampleRate, int32_t channelCount,
+                     WavSampleFormat format, uint32_t dataAlignment) {
+    close();
+    if (sampleRate <= 0 || channelCount <= 0 || (dataAlignment & (dataAlignment - 1)) != 0) {
+        return false;
+    }
+    file_ = std::fopen(path, "wb");
+    if (!file_) {
+        return false;
+    }
+    sampleRate_ = sampleRate;
+    channelCount_ = channelCount;
+    format_ = format;
+    framesWritten_ = 0;
+    headerSize_ = kHeaderSize;
+    if (dataAlignment > kHeaderSize) {
+        headerSize_ = dataAlignment;
+    } else if (dataAlignment > 0) {
+        // The JUNK chunk needs room for its own header
+        headerSize_ = (kHeaderSize + kJunkChunkHeader + dataAlignment - 1) & ~(dataAlignment - 1);
+    }
+    if (!writeHeader()) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+uint32_t WavWriter::getFrameBytes() const {
+    size_t sampleBytes = (format_ == WavSampleFormat::Pcm16) ? sizeof(int16_t) : sizeof(float);
+    return static_cast<uint32_t>(channelCount_ * sampleBytes);
+}
+
+bool WavWriter::write(const float* samples, int32_t frames) {
+    if (!file_ || frames <= 0) {
+        return file_ != nullptr;
+    }
+    if ((framesWritten_ + frames) * getFrameBytes() > 0xFFFFFFFFu - headerSize_) {
+        return false; // RIFF sizes are 32-bit
+    }
+    size_t count = static_cast<size_t>(frames) * channelCount_;
+    if (format_ == WavSampleFormat::Float32) {
+        // Sample data is little-endian IEEE float, which is the in-memory
+        // layout on every target this builds for
+        if (std::fwrite(samples, sizeof(float), count, file_) != count) {
+            return false;
+        }
+    } else {
+        int16_t converted[kConvertFrames];
+        for (size_t done = 0; done < count;) {
+            size_t batch = std::min<size_t>(count - done, kConvertFrames);
+            for (size_t i = 0; i < batch; ++i) {
+                float sample = std::max(-1.0f, std::min(1.0f, samples[done + i]));
+                converted[i] = static_cast<int16_t>(std::lrint(sample * 32767.0f));
+            }
+            if (std::fwrite(converted, sizeof(int16_t), batch, file_) != batch) {
+                return false;
+            }
+            done += batch;
+        }
+    }
+    framesWritten_ += frames;
+    return true;
+}
+
+bool WavWriter::close() {
+    if (!file_) {
+        return true;
+    }
+    bool ok = std::fseek(file_, 0, SEEK_SET) == 0 && writeHeader();
+    ok = (std::fclose(file_) == 0) && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+bool WavWriter::writeHeader() {
+    bool pcm = format_ == WavSampleFormat::Pcm16;
+    uint32_t blockAlign = getFrameBytes();
+    uint32_t dataBytes = static_cast<uint32_t>(framesWritten_ * blockAlign);
+
+    uint8_t header[kHeaderSize];
+    std::memcpy(header, "RIFF", 4);
+    putU32(header + 4, headerSize_ - 8 + dataBytes);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    putU32(header + 16, 16);
+    putU16(header + 20, pcm ? kWaveFormatPcm : kWaveFormatIeeeFloat);
+    putU16(header + 22, static_cast<uint16_t>(channelCount_));
+    putU32(header + 24, static_cast<uint32_t>(sampleRate_));
+    putU32(header + 28, static_cast<uint32_t>(sampleRate_) * blockAlign);
+    putU16(header + 32, static_cast<uint16_t>(blockAlign));
+    putU16(header + 34, pcm ? 16 : 32);
+    if (std::fwrite(header, 1, 36, file_) != 36) {
+        return false;
+    }
+
+    // Padding up to the data alignment; readers skip unknown chunks
+    if (headerSize_ > kHeaderSize) {
+        uint32_t junkBytes = headerSize_ - kHeaderSize - kJunkChunkHeader;
+        uint8_t junk[kJunkChunkHeader];
+        std::memcpy(junk, "JUNK", 4);
+        putU32(junk + 4, junkBytes);
+        if (std::fwrite(junk, 1, kJunkChunkHeader, file_) != kJunkChunkHeader) {
+            return false;
+        }
+        static const uint8_t zeros[256] = {};
+        for (uint32_t left = junkBytes; left > 0;) {
+            uint32_t n = std::min<uint32_t>(left, sizeof(zeros));
+            if (std::fwrite(zeros, 1, n, file_) != n) {
+                return false;
+            }
+            left -= n;
+        }
+    }
+
+    uint8_t data[8];
+    std::memcpy(data, "data", 4);
+    putU32(data + 4, dataBytes);
+    return std::fwrite(data, 1, 8, file_) == 8
+        && std::fseek(file_, 0, SEEK_END) == 0;
+}
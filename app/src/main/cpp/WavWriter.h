@@ -0,0 +1,50 @@
+#ifndef NOISYSYNTH_WAVWRITER_H
+#define NOISYSYNTH_WAVWRITER_H
+
+#include <cstdint>
+#include <cstdio>
+
+enum class WavSampleFormat : int32_t {
+    Float32 = 0,   // IEEE float, exactly what the engine renders
+    Pcm16 = 1      // half the size; clipped to -1..1 and rounded
+};
+
+/**
+ * Streams float samples to a WAV file. Sizes in the header are patched in
+ * close(), so a file that was never closed has a valid format but zero length.
+ *
+ * With a dataAlignment (a power of two, e.g. the page size), a JUNK chunk
+ * pads the header so the samples start on that boundary. Writes that are
+ * a multiple of it then land on aligned file offsets.
+ */
+class WavWriter {
+public:
+    WavWriter() = default;
+    ~WavWriter() { close(); }
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    bool open(const char* path, int32_t sampleRate, int32_t channelCount,
+              WavSampleFormat format = WavSampleFormat::Float32, uint32_t dataAlignment = 0);
+    // samples holds frames * channelCount interleaved floats
+    bool write(const float* samples, int32_t frames);
+    bool close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    uint64_t getFramesWritten() const { return framesWritten_; }
+    // Bytes per frame in the file
+    uint32_t getFrameBytes() const;
+
+private:
+    bool writeHeader();
+
+    FILE* file_ = nullptr;
+    int32_t sampleRate_ = 0;
+    int32_t channelCount_ = 0;
+    WavSampleFormat format_ = WavSampleFormat::Float32;
+    uint32_t headerSize_ = 0;
+    uint64_t framesWritten_ = 0;
+};
+
+#endif // NOISYSYNTH_WAVWRITER_H
@@ -0,0 +1,586 @@
+/**
+ * noisysynth-cli - host-side tools for NoisySynth engine data
+ *
+ * Usage:
+ *   noisysynth-cli bank build <out.nspb> <patches.txt>...
+ *   noisysynth-cli bank list <bank.nspb>
+ *   noisysynth-cli bank find <bank.nspb> <name>
+ *   noisysynth-cli bank tag <bank.nspb> <tag>
+ *   noisysynth-cli tuning <scale.scl> [mapping.kbm]
+ *   noisysynth-cli render <song.mid> <out.wav> <seconds> [--rate hz] [--trace out.json]
+ *   noisysynth-cli simulate <song.mid> [--seconds s] [--rate hz] [--frames n[:max]]
+ *                           [--buffers n] [--jitter-ms ms] [--drift-ppm ppm]
+ *                           [--seed n] [--realtime] [--render-rate native|internal]
+ *                           [--trace out.json]
+ *   noisysynth-cli rate-bench <song.mid> [--rate hz] [--seconds s] [--frames n]
+ *   noisysynth-cli batch <bank.nspb> <out-dir> <song.mid>... [--threads n] [--seconds s]
+ *                        [--rate hz] [--tag tag]
+ *
+ * Patch text format (any number of presets per file):
+ *
+ *   [Warm Pad]
+ *   tags = pad, warm
+ *   filterCutoff = 0.35
+ *   attack = 0.8
+ *
+ * Parameter names are the ones in kParamInfo (SynthParams.h); anything not
+ * listed keeps its default value.
+ *
+ * --trace writes per-stage render timings as Chrome trace JSON; it needs a
+ * build configured with -DNOISYSYNTH_TRACE=ON.
+ */
+#include "../BatchRender.h"
+#include "../PresetBank.h"
+#include "../RenderTrace.h"
+#include "../SoftwareAudioBackends.h"
+#include "../SynthEngine.h"
+#include "../Tuning.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> splitTags(const std::string& text) {
+    std::vector<std::string> tags;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == std::string::npos) {
+            comma = text.size();
+        }
+        std::string tag = trim(text.substr(start, comma - start));
+        if (!tag.empty()) {
+            tags.push_back(tag);
+        }
+        start = comma + 1;
+    }
+    return tags;
+}
+
+bool readPatchFile(const char* path, PresetBankWriter& writer) {
+    std::ifstream in(path);
+    if (!in) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    std::string name;
+    std::vector<std::string> tags;
+    SynthParams params;
+    bool ok = true;
+    int lineNumber = 0;
+
+    auto flush = [&]() {
+        if (!name.empty() && !writer.addPreset(name, tags, params)) {
+            std::fprintf(stderr, "%s: duplicate preset name '%s'\n", path, name.c_str());
+            ok = false;
+        }
+        name.clear();
+        tags.clear();
+        params.reset();
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line.front() == '[' && line.back() == ']') {
+            flush();
+            name = trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos || name.empty()) {
+            std::fprintf(stderr, "%s:%d: expected 'key = value' inside a [preset]\n", path, lineNumber);
+            ok = false;
+            continue;
+        }
+
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+        if (key == "tags") {
+            tags = splitTags(value);
+            continue;
+        }
+
+        int id = findParamByName(key.c_str());
+        if (id < 0) {
+            std::fprintf(stderr, "%s:%d: unknown parameter '%s'\n", path, lineNumber, key.c_str());
+            ok = false;
+            continue;
+        }
+        const ParamInfo& info = kParamInfo[id];
+        float v = std::strtof(value.c_str(), nullptr);
+        params.values[id] = std::max(info.minValue, std::min(info.maxValue, v));
+    }
+    flush();
+    return ok;
+}
+
+int bankBuild(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: noisysynth-cli bank build <out.nspb> <patches.txt>...\n");
+        return 2;
+    }
+    PresetBankWriter writer;
+    for (int i = 1; i < argc; ++i) {
+        if (!readPatchFile(argv[i], writer)) {
+            return 1;
+        }
+    }
+    if (!writer.write(argv[0])) {
+        std::fprintf(stderr, "%s: write failed\n", argv[0]);
+        return 1;
+    }
+    std::printf("Wrote %zu presets to %s\n", writer.size(), argv[0]);
+    return 0;
+}
+
+bool openBank(const char* path, PresetBank& bank) {
+    if (!bank.open(path)) {
+        std::fprintf(stderr, "%s: not a valid preset bank\n", path);
+        return false;
+    }
+    return true;
+}
+
+void printPreset(const PresetBank& bank, uint32_t index) {
+    std::printf("%5u  %s\n", index, bank.nameAt(index).c_str());
+}
+
+int bankCommand(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: noisysynth-cli bank <build|list|find|tag> ...\n");
+        return 2;
+    }
+    std::string command = argv[0];
+    if (command == "build") {
+        return bankBuild(argc - 1, argv + 1);
+    }
+
+    PresetBank bank;
+    if (!openBank(argv[1], bank)) {
+        return 1;
+    }
+
+    if (command == "list") {
+        for (uint32_t position = 0; position < bank.size(); ++position) {
+            printPreset(bank, bank.sortedIndex(position));
+        }
+        return 0;
+    }
+    if (command == "find" && argc >= 3) {
+        int index = bank.find(argv[2]);
+        if (index < 0) {
+            std::fprintf(stderr, "'%s' not found\n", argv[2]);
+            return 1;
+        }
+        const float* values = bank.valuesAt(static_cast<uint32_t>(index));
+        printPreset(bank, static_cast<uint32_t>(index));
+        uint32_t count = std::min<uint32_t>(bank.paramCount(), kParamCount);
+        for (uint32_t i = 0; i < count; ++i) {
+            std::printf("       %-16s = %g\n", kParamInfo[i].name, values[i]);
+        }
+        return 0;
+    }
+    if (command == "tag" && argc >= 3) {
+        std::vector<uint32_t> matches(bank.findByTag(argv[2], nullptr, 0));
+        bank.findByTag(argv[2], matches.data(), static_cast<uint32_t>(matches.size()));
+        for (uint32_t index : matches) {
+            printPreset(bank, index);
+        }
+        return 0;
+    }
+
+    std::fprintf(stderr, "unknown bank command '%s'\n", command.c_str());
+    return 2;
+}
+
+// Print the 128-note table the engine would build from a Scala scale
+int tuningCommand(int argc, char** argv) {
+    if (argc < 1 || argc > 2) {
+        std::fprintf(stderr, "usage: noisysynth-cli tuning <scale.scl> [mapping.kbm]\n");
+        return 2;
+    }
+    ScalaScale scale;
+    if (!scale.loadFile(argv[0])) {
+        std::fprintf(stderr, "%s: not a valid Scala scale\n", argv[0]);
+        return 1;
+    }
+    KeyboardMapping mapping;
+    if (argc == 2 && !mapping.loadFile(argv[1])) {
+        std::fprintf(stderr, "%s: not a valid keyboard mapping\n", argv[1]);
+        return 1;
+    }
+    TuningTable table;
+    if (!buildTuningTable(scale, mapping, table)) {
+        std::fprintf(stderr, "reference key %d is unmapped\n", mapping.referenceNote);
+        return 1;
+    }
+
+    std::printf("# %s (%d degrees)\n", scale.getDescription().c_str(), scale.size());
+    for (int note = 0; note < kTuningTableSize; ++note) {
+        std::printf("%3d  %10.4f Hz\n", note, table.frequency[note]);
+    }
+    return 0;
+}
+
+} // namespace
+
+// Engine with the song loaded and playing, for a backend to pull from
+bool startSong(SynthEngine& engine, const char* path) {
+    if (!engine.loadMidiFile(path)) {
+        std::fprintf(stderr, "%s: not a playable MIDI file\n", path);
+        return false;
+    }
+    engine.startMidiPlayback(false);
+    return true;
+}
+
+// Checked before rendering, so a long run is not wasted on a build without tracing
+bool checkTracePath(const std::string& tracePath) {
+    if (!tracePath.empty() && !traceCompiledIn()) {
+        std::fprintf(stderr, "--trace needs a build with -DNOISYSYNTH_TRACE=ON\n");
+        return false;
+    }
+    return true;
+}
+
+bool writeTrace(const std::string& tracePath) {
+    if (tracePath.empty()) {
+        return true;
+    }
+    if (!traceWriteChromeJson(tracePath.c_str())) {
+        std::fprintf(stderr, "%s: cannot write trace\n", tracePath.c_str());
+        return false;
+    }
+    std::printf("Wrote render trace to %s\n", tracePath.c_str());
+    return true;
+}
+
+int renderCommand(int argc, char** argv) {
+    if (argc < 3 || argc % 2 == 0) {
+        std::fprintf(stderr, "usage: noisysynth-cli render <song.mid> <out.wav> <seconds> [--rate hz] [--trace out.json]\n");
+        return 2;
+    }
+    AudioBackendConfig config;
+    double seconds = std::atof(argv[2]);
+    std::string tracePath;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--rate") {
+            config.sampleRate = std::atoi(argv[i + 1]);
+        } else if (option == "--trace") {
+            tracePath = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "unknown option '%s'\n", option.c_str());
+            return 2;
+        }
+    }
+    if (!checkTracePath(tracePath)) {
+        return 2;
+    }
+
+    SynthEngine engine(false);
+    if (!startSong(engine, argv[0])) {
+        return 1;
+    }
+    WavFileAudioBackend backend(argv[1], seconds);
+    if (!backend.open(config, &engine) || !backend.start()) {
+        return 1;
+    }
+    backend.waitUntilFinished();
+    backend.close();
+    std::printf("Wrote %llu frames to %s\n",
+                static_cast<unsigned long long>(backend.getFramesWritten()), argv[1]);
+    return writeTrace(tracePath) ? 0 : 1;
+}
+
+int simulateCommand(int argc, char** argv) {
+    if (argc < 1) {
+        std::fprintf(stderr, "usage: noisysynth-cli simulate <song.mid> [--seconds s] [--rate hz]"
+                             " [--frames n[:max]] [--buffers n] [--jitter-ms ms] [--drift-ppm ppm]"
+                             " [--seed n] [--realtime] [--render-rate native|internal] [--trace out.json]\n");
+        return 2;
+    }
+    AudioBackendConfig config;
+    SimulatedDeviceConfig device;
+    RenderRateMode renderRate = RenderRateMode::Native;
+    std::string tracePath;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--realtime") {
+            device.realTime = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s needs a value\n", option.c_str());
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (option == "--seconds") {
+            device.durationSeconds = std::atof(value);
+        } else if (option == "--rate") {
+            config.sampleRate = std::atoi(value);
+        } else if (option == "--frames") {
+            char* end;
+            device.minFramesPerCallback = static_cast<int32_t>(std::strtol(value, &end, 10));
+            device.maxFramesPerCallback = (*end == ':') ? std::atoi(end + 1) : device.minFramesPerCallback;
+        } else if (option == "--buffers") {
+            device.bufferCount = std::atoi(value);
+        } else if (option == "--jitter-ms") {
+            device.jitterSeconds = std::atof(value) / 1000.0;
+        } else if (option == "--drift-ppm") {
+            device.clockRatio = 1.0 + std::atof(value) / 1e6;
+        } else if (option == "--seed") {
+            device.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (option == "--render-rate") {
+            renderRate = (std::string(value) == "internal") ? RenderRateMode::Internal : RenderRateMode::Native;
+        } else if (option == "--trace") {
+            tracePath = value;
+        } else {
+            std::fprintf(stderr, "unknown option '%s'\n", option.c_str());
+            return 2;
+        }
+    }
+
+    if (!checkTracePath(tracePath)) {
+        return 2;
+    }
+
+    SynthEngine engine(false);
+    engine.setRenderRateMode(renderRate);
+    if (!startSong(engine, argv[0])) {
+        return 1;
+    }
+    SimulatedAudioBackend backend(device);
+    if (!backend.open(config, &engine) || !backend.start()) {
+        return 1;
+    }
+    backend.waitUntilFinished();
+    backend.close();
+
+    const SimulatedDeviceStats& stats = backend.getStats();
+    std::printf("callbacks        %llu\n", static_cast<unsigned long long>(stats.callbacks));
+    std::printf("frames           %llu\n", static_cast<unsigned long long>(stats.frames));
+    std::printf("late callbacks   %llu\n", static_cast<unsigned long long>(stats.lateCallbacks));
+    std::printf("callback mean    %.1f us\n", stats.meanCallbackSeconds * 1e6);
+    std::printf("callback max     %.1f us\n", stats.maxCallbackSeconds * 1e6);
+    std::printf("max load         %.1f %%\n", stats.maxLoad * 100.0);
+    std::printf("output latency   %.2f ms\n", stats.outputLatencySeconds * 1e3);
+    std::printf("real-time factor %.1fx\n", stats.realTimeFactor);
+    bool traced = writeTrace(tracePath);
+    return (stats.lateCallbacks == 0 && traced) ? 0 : 1;
+}
+
+// Same song and device through both RenderRateModes
+int rateBenchCommand(int argc, char** argv) {
+    if (argc < 1 || argc % 2 == 0) {
+        std::fprintf(stderr, "usage: noisysynth-cli rate-bench <song.mid> [--rate hz] [--seconds s] [--frames n]\n");
+        return 2;
+    }
+    AudioBackendConfig config;
+    config.sampleRate = 44100;
+    SimulatedDeviceConfig device;
+    device.durationSeconds = 30.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--rate") {
+            config.sampleRate = std::atoi(argv[i + 1]);
+        } else if (option == "--seconds") {
+            device.durationSeconds = std::atof(argv[i + 1]);
+        } else if (option == "--frames") {
+            config.framesPerBuffer = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "unknown option '%s'\n", option.c_str());
+            return 2;
+        }
+    }
+
+    std::printf("device %d Hz, %.0f s\n\n", config.sampleRate, device.durationSeconds);
+    std::printf("%-9s %9s %12s %12s %12s %10s\n",
+                "mode", "render Hz", "mean us", "max us", "resampler", "speed");
+    for (RenderRateMode mode : {RenderRateMode::Native, RenderRateMode::Internal}) {
+        SynthEngine engine(false);
+        engine.setRenderRateMode(mode);
+        if (!startSong(engine, argv[0])) {
+            return 1;
+        }
+        SimulatedAudioBackend backend(device);
+        if (!backend.open(config, &engine) || !backend.start()) {
+            return 1;
+        }
+        backend.waitUntilFinished();
+        const SimulatedDeviceStats& stats = backend.getStats();
+
+        char resampler[32] = "-";
+        if (engine.isResampling()) {
+            std::snprintf(resampler, sizeof(resampler), "%.2f ms %.1f%%",
+                          engine.getResamplerLatencySeconds() * 1e3, engine.getResamplerLoad() * 100.0f);
+        }
+        std::printf("%-9s %9.0f %12.1f %12.1f %12s %9.1fx\n",
+                    mode == RenderRateMode::Native ? "native" : "internal", engine.getSampleRate(),
+                    stats.meanCallbackSeconds * 1e6, stats.maxCallbackSeconds * 1e6, resampler,
+                    stats.realTimeFactor);
+        backend.close();
+    }
+    return 0;
+}
+
+// File name part: letters and digits kept, everything else becomes '_'
+std::string fileStem(const std::string& text) {
+    std::string stem = text.substr(text.find_last_of('/') + 1);
+    size_t dot = stem.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) {
+        stem.resize(dot);
+    }
+    for (char& c : stem) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-') {
+            c = '_';
+        }
+    }
+    return stem;
+}
+
+// Every preset (or every preset with a tag) playing every song, on all cores
+int batchCommand(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: noisysynth-cli batch <bank.nspb> <out-dir> <song.mid>..."
+                             " [--threads n] [--seconds s] [--rate hz] [--tag tag]\n");
+        return 2;
+    }
+    PresetBank bank;
+    if (!openBank(argv[0], bank)) {
+        return 1;
+    }
+    std::string outDir = argv[1];
+
+    std::vector<std::string> songs;
+    int threadCount = 0;
+    double seconds = 0.0;
+    int32_t sampleRate = static_cast<int32_t>(kSampleRate);
+    const char* tag = nullptr;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            songs.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (arg == "--threads") {
+            threadCount = std::atoi(value);
+        } else if (arg == "--seconds") {
+            seconds = std::atof(value);
+        } else if (arg == "--rate") {
+            sampleRate = std::atoi(value);
+        } else if (arg == "--tag") {
+            tag = value;
+        } else {
+            std::fprintf(stderr, "unknown option '%s'\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    std::vector<uint32_t> presets;
+    if (tag) {
+        presets.resize(bank.findByTag(tag, nullptr, 0));
+        bank.findByTag(tag, presets.data(), static_cast<uint32_t>(presets.size()));
+    } else {
+        for (uint32_t index = 0; index < bank.size(); ++index) {
+            presets.push_back(index);
+        }
+    }
+
+    std::vector<BatchJob> jobs;
+    jobs.reserve(presets.size() * songs.size());
+    uint32_t paramCount = std::min<uint32_t>(bank.paramCount(), kParamCount);
+    for (uint32_t preset : presets) {
+        std::string presetStem = std::to_string(preset) + "-" + fileStem(bank.nameAt(preset));
+        for (const std::string& song : songs) {
+            BatchJob job;
+            job.midiPath = song;
+            job.outputPath = outDir + "/" + presetStem + "-" + fileStem(song) + ".wav";
+            std::copy_n(bank.valuesAt(preset), paramCount, job.params.values);
+            job.sampleRate = sampleRate;
+            job.seconds = seconds;
+            jobs.push_back(job);
+        }
+    }
+    if (jobs.empty()) {
+        std::fprintf(stderr, "nothing to render\n");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchResult> results = renderBatch(jobs, threadCount);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    int workers = 0;
+    double audioSeconds = 0.0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!results[i].ok) {
+            std::fprintf(stderr, "failed: %s\n", jobs[i].outputPath.c_str());
+            failed++;
+        }
+        workers = std::max(workers, results[i].worker + 1);
+        audioSeconds += static_cast<double>(results[i].frames) / sampleRate;
+    }
+    std::printf("jobs             %zu (%d failed)\n", jobs.size(), failed);
+    std::printf("threads          %d\n", workers);
+    std::printf("wall time        %.2f s\n", wallSeconds);
+    std::printf("audio rendered   %.1f s\n", audioSeconds);
+    std::printf("real-time factor %.1fx\n", audioSeconds / wallSeconds);
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: noisysynth-cli <bank|tuning|render|simulate|rate-bench|batch> ...\n");
+        return 2;
+    }
+    std::string group = argv[1];
+    if (group == "bank") {
+        return bankCommand(argc - 2, argv + 2);
+    }
+    if (group == "tuning") {
+        return tuningCommand(argc - 2, argv + 2);
+    }
+    if (group == "render") {
+        return renderCommand(argc - 2, argv + 2);
+    }
+    if (group == "simulate") {
+        return simulateCommand(argc - 2, argv + 2);
+    }
+    if (group == "rate-bench") {
+        return rateBenchCommand(argc - 2, argv + 2);
+    }
+    if (group == "batch") {
+        return batchCommand(argc - 2, argv + 2);
+    }
+    std::fprintf(stderr, "unknown command '%s'\n", group.c_str());
+    return 2;
+}
@@ -1,6 +1,7 @@
 #include <jni.h>
 #include "SynthEngine.h"
 #include <android/log.h>
+#include <vector>
 
 #define LOG_TAG "NoisySynth-JNI"
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
@@ -20,269 +21,526 @@ Java_com_example_noisysynth_SynthEngine_destroy(JNIEnv *env, jobject thiz, jlong
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1noteOn(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint midi_note) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerEnabled(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->noteOn(static_cast<int>(midi_note));
+    engine->setSequencerEnabled(static_cast<bool>(enabled));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1noteOff(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint midi_note) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerTempo(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat bpm) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->noteOff(static_cast<int>(midi_note));
+    engine->setSequencerTempo(static_cast<float>(bpm));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setWaveform(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint waveform) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerStepLength(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint step_length) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setWaveform(static_cast<int>(waveform));
+    engine->setSequencerStepLength(static_cast<int>(step_length));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setFilterCutoff(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat cutoff) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerMeasures(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint measures) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setFilterCutoff(static_cast<float>(cutoff));
+    engine->setSequencerMeasures(static_cast<int>(measures));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setFilterResonance(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat resonance) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerStep(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint index, jint midi_note, jboolean active) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setFilterResonance(static_cast<float>(resonance));
+    engine->setSequencerStep(static_cast<int>(index), static_cast<int>(midi_note), static_cast<bool>(active));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setAttack(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat attack) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerPatternLength(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern, jint steps, jint step_length) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setAttack(static_cast<float>(attack));
+    engine->setSequencerPatternLength(static_cast<int>(pattern), static_cast<int>(steps), static_cast<int>(step_length));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setDecay(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat decay) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerChordStep(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern, jint track, jint step,
+    jintArray notes, jfloat velocity, jfloat gate) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setDecay(static_cast<float>(decay));
+    jint chord[kSequencerMaxChordNotes] = {};
+    jsize count = std::min<jsize>(env->GetArrayLength(notes), kSequencerMaxChordNotes);
+    env->GetIntArrayRegion(notes, 0, count, chord);
+    int values[kSequencerMaxChordNotes];
+    for (jsize i = 0; i < count; ++i) {
+        values[i] = static_cast<int>(chord[i]);
+    }
+    engine->setSequencerChordStep(static_cast<int>(pattern), static_cast<int>(track), static_cast<int>(step),
+                                  values, static_cast<int>(count), static_cast<float>(velocity), static_cast<float>(gate));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setSustain(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat sustain) {
+Java_com_example_noisysynth_SynthEngine_native_1clearSequencerPattern(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setSustain(static_cast<float>(sustain));
+    engine->clearSequencerPattern(static_cast<int>(pattern));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setRelease(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat release) {
+Java_com_example_noisysynth_SynthEngine_native_1copySequencerPattern(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint from, jint to) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setRelease(static_cast<float>(release));
+    engine->copySequencerPattern(static_cast<int>(from), static_cast<int>(to));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setFilterAttack(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat attack) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerTrack(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint track, jint part, jboolean muted) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setFilterAttack(static_cast<float>(attack));
+    engine->setSequencerTrack(static_cast<int>(track), static_cast<int>(part), static_cast<bool>(muted));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setFilterDecay(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat decay) {
+Java_com_example_noisysynth_SynthEngine_native_1selectSequencerPattern(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setFilterDecay(static_cast<float>(decay));
+    engine->selectSequencerPattern(static_cast<int>(pattern));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setFilterSustain(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat sustain) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerSong(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jintArray patterns, jintArray repeats) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setFilterSustain(static_cast<float>(sustain));
+    jsize length = std::min<jsize>(std::min(env->GetArrayLength(patterns), env->GetArrayLength(repeats)),
+                                   kSequencerMaxSongSlots);
+    jint patternValues[kSequencerMaxSongSlots];
+    jint repeatValues[kSequencerMaxSongSlots];
+    env->GetIntArrayRegion(patterns, 0, length, patternValues);
+    env->GetIntArrayRegion(repeats, 0, length, repeatValues);
+    int slots[kSequencerMaxSongSlots];
+    int counts[kSequencerMaxSongSlots];
+    for (jsize i = 0; i < length; ++i) {
+        slots[i] = static_cast<int>(patternValues[i]);
+        counts[i] = static_cast<int>(repeatValues[i]);
+    }
+    engine->setSequencerSong(slots, counts, static_cast<int>(length));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setFilterRelease(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat release) {
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerSongMode(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setFilterRelease(static_cast<float>(release));
+    engine->setSequencerSongMode(static_cast<bool>(enabled));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setFilterEnvelopeAmount(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat amount) {
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerLane(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern, jint lane, jint param, jint part, jboolean glide) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setFilterEnvelopeAmount(static_cast<float>(amount));
+    return engine->setSequencerLane(static_cast<int>(pattern), static_cast<int>(lane), static_cast<int>(param),
+                                    static_cast<int>(part), static_cast<bool>(glide)) ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setLFORate(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat rate) {
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1setSequencerParameterLock(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern, jint step, jint id, jint part, jfloat value) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setLFORate(static_cast<float>(rate));
+    if (id < 0 || id >= kParamCount) {
+        return JNI_FALSE;
+    }
+    return engine->setSequencerParameterLock(static_cast<int>(pattern), static_cast<int>(step), static_cast<ParamId>(id),
+                                             static_cast<int>(part), static_cast<float>(value)) ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setLFOAmount(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat amount) {
+Java_com_example_noisysynth_SynthEngine_native_1clearSequencerParameterLock(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern, jint step, jint id, jint part) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setLFOAmount(static_cast<float>(amount));
+    if (id >= 0 && id < kParamCount) {
+        engine->clearSequencerParameterLock(static_cast<int>(pattern), static_cast<int>(step), static_cast<ParamId>(id),
+                                            static_cast<int>(part));
+    }
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setDelayEnabled(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1recordSequencerParameter(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint id, jint part, jfloat value) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setDelayEnabled(static_cast<bool>(enabled));
+    if (id < 0 || id >= kParamCount) {
+        return JNI_FALSE;
+    }
+    return engine->recordSequencerParameter(static_cast<ParamId>(id), static_cast<int>(part),
+                                            static_cast<float>(value)) ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setDelayTime(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat time) {
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1loadPresetBank(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jstring path) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setDelayTime(static_cast<float>(time));
+    const char *pathChars = env->GetStringUTFChars(path, nullptr);
+    bool loaded = engine->loadPresetBank(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+    return loaded ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setDelayFeedback(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat feedback) {
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getPresetCount(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setDelayFeedback(static_cast<float>(feedback));
+    return static_cast<jint>(engine->getPresetBank().size());
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setDelayMix(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat mix) {
+JNIEXPORT jstring JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getPresetName(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint index) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setDelayMix(static_cast<float>(mix));
+    return env->NewStringUTF(engine->getPresetBank().nameAt(static_cast<uint32_t>(index)).c_str());
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setChorusEnabled(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getSortedPresetIndex(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint position) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setChorusEnabled(static_cast<bool>(enabled));
+    return static_cast<jint>(engine->getPresetBank().sortedIndex(static_cast<uint32_t>(position)));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setChorusRate(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat rate) {
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1findPreset(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jstring name) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setChorusRate(static_cast<float>(rate));
+    const char *nameChars = env->GetStringUTFChars(name, nullptr);
+    int index = engine->getPresetBank().find(nameChars);
+    env->ReleaseStringUTFChars(name, nameChars);
+    return static_cast<jint>(index);
+}
+
+JNIEXPORT jintArray JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1findPresetsByTag(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jstring tag) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    const char *tagChars = env->GetStringUTFChars(tag, nullptr);
+    const PresetBank &bank = engine->getPresetBank();
+    std::vector<uint32_t> matches(bank.findByTag(tagChars, nullptr, 0));
+    bank.findByTag(tagChars, matches.data(), static_cast<uint32_t>(matches.size()));
+    env->ReleaseStringUTFChars(tag, tagChars);
+
+    jintArray result = env->NewIntArray(static_cast<jint>(matches.size()));
+    if (result && !matches.empty()) {
+        env->SetIntArrayRegion(result, 0, static_cast<jint>(matches.size()),
+                               reinterpret_cast<const jint *>(matches.data()));
+    }
+    return result;
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getPresetValues(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint index) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    SynthParams params;
+    if (!engine->getPresetParams(static_cast<int>(index), params)) {
+        return nullptr;
+    }
+    jfloatArray result = env->NewFloatArray(kParamCount);
+    if (result) {
+        env->SetFloatArrayRegion(result, 0, kParamCount, params.values);
+    }
+    return result;
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getControlBuffer(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    ControlRing &ring = engine->getControlRing();
+    return env->NewDirectByteBuffer(ring.data(), static_cast<jlong>(ring.byteSize()));
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1commitControlEvents(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint write_index) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->commitControlEvents(static_cast<uint32_t>(write_index)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1loadMidiFile(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jstring path) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    const char *pathChars = env->GetStringUTFChars(path, nullptr);
+    bool loaded = engine->loadMidiFile(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+    return loaded ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setChorusDepth(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat depth) {
+Java_com_example_noisysynth_SynthEngine_native_1startMidiPlayback(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jboolean loop) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setChorusDepth(static_cast<float>(depth));
+    engine->startMidiPlayback(static_cast<bool>(loop));
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setChorusMix(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat mix) {
+Java_com_example_noisysynth_SynthEngine_native_1stopMidiPlayback(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setChorusMix(static_cast<float>(mix));
+    engine->stopMidiPlayback();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1isMidiPlaying(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->isMidiPlaying() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1loadScalaTuning(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jstring scl_path, jstring kbm_path) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    const char *sclChars = env->GetStringUTFChars(scl_path, nullptr);
+    const char *kbmChars = kbm_path ? env->GetStringUTFChars(kbm_path, nullptr) : nullptr;
+    bool loaded = engine->loadScalaTuning(sclChars, kbmChars);
+    if (kbmChars) {
+        env->ReleaseStringUTFChars(kbm_path, kbmChars);
+    }
+    env->ReleaseStringUTFChars(scl_path, sclChars);
+    return loaded ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1setTuningReference(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat reference_hz) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->setTuningReference(static_cast<float>(reference_hz)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1resetTuning(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->resetTuning() ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setReverbEnabled(
+Java_com_example_noisysynth_SynthEngine_native_1setRenderAheadEnabled(
     JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setReverbEnabled(static_cast<bool>(enabled));
+    engine->setRenderAheadEnabled(static_cast<bool>(enabled));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setReverbSize(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat size) {
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1isRenderingAhead(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setReverbSize(static_cast<float>(size));
+    return engine->isRenderingAhead() ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setReverbDamping(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat damping) {
+Java_com_example_noisysynth_SynthEngine_native_1setLoopFreezeEnabled(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setReverbDamping(static_cast<float>(damping));
+    engine->setLoopFreezeEnabled(static_cast<bool>(enabled));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setReverbMix(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat mix) {
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getLoopFreezeState(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setReverbMix(static_cast<float>(mix));
+    return static_cast<jint>(engine->getLoopFreezeState());
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setArpeggiatorEnabled(
+Java_com_example_noisysynth_SynthEngine_native_1setVisualTapsEnabled(
     JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setArpeggiatorEnabled(static_cast<bool>(enabled));
+    engine->setVisualTapsEnabled(static_cast<bool>(enabled));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setArpeggiatorPattern(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint pattern) {
+// Null until the taps were first enabled
+JNIEXPORT jobject JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getScopeBuffer(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setArpeggiatorPattern(static_cast<int>(pattern));
+    VisualTaps *taps = engine->getVisualTaps();
+    if (!taps) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(taps->scopeFrames(), static_cast<jlong>(VisualTaps::kScopeBytes));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setArpeggiatorRate(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat bpm) {
+JNIEXPORT jobject JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getSpectrumBuffer(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setArpeggiatorRate(static_cast<float>(bpm));
+    VisualTaps *taps = engine->getVisualTaps();
+    if (!taps) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(taps->spectrumFrames(), static_cast<jlong>(VisualTaps::kSpectrumBytes));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setArpeggiatorGate(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat gate) {
+// Index of the newest frame in the buffer, or -1 before the taps exist
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1acquireScopeFrame(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setArpeggiatorGate(static_cast<float>(gate));
+    VisualTaps *taps = engine->getVisualTaps();
+    return taps ? taps->acquireScope() : -1;
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setArpeggiatorSubdivision(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint subdivision) {
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1acquireSpectrumFrame(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    VisualTaps *taps = engine->getVisualTaps();
+    return taps ? taps->acquireSpectrum() : -1;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1startRecording(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jstring path, jint format) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    if (format < 0 || format > static_cast<jint>(WavSampleFormat::Pcm16)) {
+        return JNI_FALSE;
+    }
+    const char *pathChars = env->GetStringUTFChars(path, nullptr);
+    bool started = engine->startRecording(pathChars, static_cast<WavSampleFormat>(format));
+    env->ReleaseStringUTFChars(path, pathChars);
+    return started ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1stopRecording(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->stopRecording() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1isRecording(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->isRecording() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getRecordedFrames(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return static_cast<jlong>(engine->getRecorderStats().framesWritten);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getRecordingDroppedBlocks(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return static_cast<jint>(engine->getRecorderStats().droppedBlocks);
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getRecordingLatencyMs(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->getRecorderStats().latencyMs;
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getRecordingMaxLatencyMs(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setArpeggiatorSubdivision(static_cast<int>(subdivision));
+    return engine->getRecorderStats().maxLatencyMs;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1hasRecordingFailed(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return engine->getRecorderStats().writeFailed ? JNI_TRUE : JNI_FALSE;
+}
+
+// Process-wide, like the trace buffers themselves
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1writeRenderTrace(
+    JNIEnv *env, jobject thiz, jstring path) {
+    const char *pathChars = env->GetStringUTFChars(path, nullptr);
+    bool written = traceWriteChromeJson(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+    return written ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setSequencerEnabled(
+Java_com_example_noisysynth_SynthEngine_native_1clearRenderTrace(
+    JNIEnv *env, jobject thiz) {
+    traceClear();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1isRenderTraceAvailable(
+    JNIEnv *env, jobject thiz) {
+    return traceCompiledIn() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1setQualityGovernorEnabled(
     JNIEnv *env, jobject thiz, jlong engine_handle, jboolean enabled) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setSequencerEnabled(static_cast<bool>(enabled));
+    engine->setQualityGovernorEnabled(static_cast<bool>(enabled));
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setSequencerTempo(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jfloat bpm) {
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getQualityTier(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setSequencerTempo(static_cast<float>(bpm));
+    return static_cast<jint>(engine->getQualityTier());
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setSequencerStepLength(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint step_length) {
+JNIEXPORT jfloat JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getRenderLoad(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setSequencerStepLength(static_cast<int>(step_length));
+    return static_cast<jfloat>(engine->getRenderLoad());
 }
 
-JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setSequencerMeasures(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint measures) {
+JNIEXPORT jfloat JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getPeakRenderLoad(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setSequencerMeasures(static_cast<int>(measures));
+    return static_cast<jfloat>(engine->getPeakRenderLoad());
 }
 
 JNIEXPORT void JNICALL
-Java_com_example_noisysynth_SynthEngine_native_1setSequencerStep(
-    JNIEnv *env, jobject thiz, jlong engine_handle, jint index, jint midi_note, jboolean active) {
+Java_com_example_noisysynth_SynthEngine_native_1setRenderRateMode(
+    JNIEnv *env, jobject thiz, jlong engine_handle, jint mode) {
     auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
-    engine->setSequencerStep(static_cast<int>(index), static_cast<int>(midi_note), static_cast<bool>(active));
+    engine->setRenderRateMode(mode == static_cast<jint>(RenderRateMode::Internal)
+                              ? RenderRateMode::Internal : RenderRateMode::Native);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getDeviceSampleRate(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return static_cast<jint>(engine->getDeviceSampleRate());
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getRenderSampleRate(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return static_cast<jint>(engine->getSampleRate());
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getResamplerLatency(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return static_cast<jfloat>(engine->getResamplerLatencySeconds());
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_example_noisysynth_SynthEngine_native_1getResamplerLoad(
+    JNIEnv *env, jobject thiz, jlong engine_handle) {
+    auto *engine = reinterpret_cast<SynthEngine *>(engine_handle);
+    return static_cast<jfloat>(engine->getResamplerLoad());
 }
 
 } // extern "C"
@@ -0,0 +1,114 @@
+#ifndef NOISYSYNTH_TESTMIDI_H
+#define NOISYSYNTH_TESTMIDI_H
+
+#include "SynthEngine.h"
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/*
+ * Shared by the host tests: a minimal Standard MIDI File writer, the songs
+ * the tests play through it, and helpers that act as the control thread.
+ * Songs are deterministic, so a golden render of one stays valid as long
+ * as the song does.
+ */
+
+// Writes one event into the engine's control ring, as the UI would
+inline void push(SynthEngine& engine, ControlEventType type, int32_t id, float value, int32_t arg = 0) {
+    ControlEvent event{static_cast<int32_t>(type), id, value, arg};
+    engine.getControlRing().push(event);
+}
+
+// One of 1000 evenly spaced values across the parameter's range
+inline float randomInRange(Random& random, const ParamInfo& info) {
+    float t = static_cast<float>(random.nextInt(1000)) / 999.0f;
+    return info.minValue + t * (info.maxValue - info.minValue);
+}
+
+inline bool writeFile(const std::string& path, const void* data, size_t size) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(data, 1, size, file) == size;
+    return std::fclose(file) == 0 && ok;
+}
+
+class MidiTrack {
+public:
+    void event(uint32_t delta, std::initializer_list<uint8_t> bytes) {
+        uint8_t buffer[4];
+        int length = 0;
+        buffer[length++] = delta & 0x7F;
+        while (delta >>= 7) {
+            buffer[length++] = 0x80 | (delta & 0x7F);
+        }
+        while (length > 0) {
+            bytes_.push_back(buffer[--length]);
+        }
+        bytes_.insert(bytes_.end(), bytes);
+    }
+
+    // Type 0 file, 480 ticks per quarter at the default 120 BPM
+    bool write(const std::string& path) {
+        event(0, {0xFF, 0x2F, 0x00});
+        std::vector<uint8_t> file = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xE0,
+                                     'M', 'T', 'r', 'k'};
+        uint32_t size = static_cast<uint32_t>(bytes_.size());
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            file.push_back(static_cast<uint8_t>(size >> shift));
+        }
+        file.insert(file.end(), bytes_.begin(), bytes_.end());
+        return writeFile(path, file.data(), file.size());
+    }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+// A three-note chord per beat, split across channels 0 and 1. MidiFile
+// keeps only note on/off, so songs use nothing else.
+inline void chordSong(MidiTrack& track, int beats) {
+    for (int beat = 0; beat < beats; ++beat) {
+        uint8_t root = static_cast<uint8_t>(48 + (beat * 5) % 24);
+        track.event(beat > 0 ? 120 : 0, {0x90, root, 100});
+        track.event(0, {0x90, static_cast<uint8_t>(root + 4), 90});
+        track.event(0, {0x91, static_cast<uint8_t>(root + 7), 80});
+        track.event(360, {0x80, root, 0});
+        track.event(0, {0x80, static_cast<uint8_t>(root + 4), 0});
+        track.event(0, {0x81, static_cast<uint8_t>(root + 7), 0});
+    }
+}
+
+// Overlapping sixteenths, so glide and retriggering have work to do
+inline void melodySong(MidiTrack& track) {
+    const uint8_t notes[] = {60, 62, 64, 67, 69, 67, 64, 62, 72, 71, 69, 67, 65, 64, 62, 60};
+    uint8_t previous = 0;
+    for (int i = 0; i < 20; ++i) {
+        uint8_t note = notes[i % 16];
+        track.event(previous ? 100 : 0, {0x90, note, static_cast<uint8_t>(70 + (i * 7) % 50)});
+        if (previous) {
+            track.event(20, {0x80, previous, 0});
+        }
+        previous = note;
+    }
+    track.event(120, {0x80, previous, 0});
+}
+
+// Ten-note clusters across the keyboard: more notes than voices
+inline void clusterSong(MidiTrack& track) {
+    for (int hit = 0; hit < 4; ++hit) {
+        for (int i = 0; i < 10; ++i) {
+            track.event(0, {0x90, static_cast<uint8_t>(24 + hit * 3 + i * 8), static_cast<uint8_t>(40 + i * 8)});
+        }
+        for (int i = 0; i < 10; ++i) {
+            track.event(i == 0 ? 360 : 0, {0x80, static_cast<uint8_t>(24 + hit * 3 + i * 8), 0});
+        }
+        track.event(120, {0x90, static_cast<uint8_t>(96 - hit * 5), 127});
+        track.event(240, {0x80, static_cast<uint8_t>(96 - hit * 5), 0});
+    }
+}
+
+#endif // NOISYSYNTH_TESTMIDI_H
@@ -0,0 +1,473 @@
+/*
+ * Renders a fixed corpus of patches and MIDI songs offline and checks
+ * that neither the sound nor the speed changed.
+ *
+ * Sound: each render is compared with tests/golden/render_golden.txt. A
+ * matching hash of the float output is a bit-exact pass. Otherwise the
+ * level and brightness of every 4096-frame window must stay within
+ * --tolerance-db of the golden ones, which absorbs the rounding a
+ * different compiler or FMA contraction brings; --exact fails on any
+ * difference. Every case is rendered several times and must hash the
+ * same each time.
+ *
+ * Speed: the best of those renders, in thread CPU time, is compared with
+ * the baseline file (render_baseline.txt in the working directory, so one
+ * per build tree). Cases more than --perf-tolerance percent slower are
+ * marked; the run fails when the whole corpus is, since one short case
+ * alone is too noisy to judge. A missing baseline is recorded, not
+ * compared.
+ *
+ * Usage: render_regression_test [--golden path] [--baseline path]
+ *            [--tolerance-db db] [--perf-tolerance percent] [--exact]
+ *            [--update-golden] [--update-baseline] [case]
+ */
+#include "SynthEngine.h"
+#include "TestMidi.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#ifndef NOISYSYNTH_GOLDEN_FILE
+#define NOISYSYNTH_GOLDEN_FILE "tests/golden/render_golden.txt"
+#endif
+
+namespace {
+
+constexpr int32_t kCaseSampleRate = 48000;
+constexpr int32_t kBlockFrames = 512;
+constexpr double kCaseSeconds = 3.0;
+constexpr int kWindowFrames = 4096;
+constexpr int kRepeats = 5;
+constexpr uint32_t kSeed = 1;
+
+struct Options {
+    std::string goldenPath = NOISYSYNTH_GOLDEN_FILE;
+    std::string baselinePath = "render_baseline.txt";
+    double toleranceDb = 0.1;
+    double perfTolerance = 25.0;   // percent slower than the baseline
+    bool exact = false;
+    bool updateGolden = false;
+    bool updateBaseline = false;
+    const char* only = nullptr;
+};
+
+// ---- Songs (TestMidi.h) ----
+
+struct Song {
+    const char* name;
+    void (*write)(MidiTrack&);
+};
+
+const Song kSongs[] = {
+    {"chords", [](MidiTrack& track) { chordSong(track, 5); }},
+    {"melody", melodySong},
+    {"clusters", clusterSong},
+};
+
+// ---- Corpus ----
+
+struct Setting {
+    ParamId id;
+    float value;
+};
+
+struct Case {
+    const char* name;
+    int song;                       // index into kSongs
+    std::vector<Setting> settings;  // on top of the default patch
+};
+
+const std::vector<Case>& corpus() {
+    static const std::vector<Case> cases = {
+        {"init-chords", 0, {}},
+        {"sine", 1, {{ParamId::Waveform, 0.0f}}},
+        {"saw-resonant", 0, {{ParamId::Waveform, 1.0f}, {ParamId::FilterResonance, 0.9f},
+                             {ParamId::FilterEnvAmount, 0.9f}, {ParamId::FilterCutoff, 0.2f}}},
+        {"square", 1, {{ParamId::Waveform, 2.0f}, {ParamId::FilterCutoff, 0.8f}}},
+        {"triangle", 1, {{ParamId::Waveform, 3.0f}}},
+        {"noise", 2, {{ParamId::Waveform, 4.0f}, {ParamId::FilterCutoff, 0.4f}}},
+        {"pink-noise", 2, {{ParamId::Waveform, 5.0f}}},
+        {"envelopes", 2, {{ParamId::Attack, 0.002f}, {ParamId::Decay, 0.05f}, {ParamId::Sustain, 0.2f},
+                          {ParamId::Release, 1.5f}, {ParamId::FilterAttack, 0.3f},
+                          {ParamId::FilterRelease, 1.0f}}},
+        {"lfo-mod", 0, {{ParamId::LfoAmount, 0.6f}, {ParamId::LfoRate, 5.0f},
+                        {ParamId::ModRoute1Source, 6.0f}, {ParamId::ModRoute1Destination, 1.0f},
+                        {ParamId::ModRoute1Amount, 0.02f}, {ParamId::ModRoute2Source, 4.0f},
+                        {ParamId::ModRoute2Destination, 2.0f}, {ParamId::ModRoute2Amount, 0.3f},
+                        {ParamId::Lfo2Shape, 2.0f}, {ParamId::Lfo2PerVoice, 1.0f}}},
+        {"glide", 1, {{ParamId::Waveform, 1.0f}, {ParamId::GlideTime, 0.08f}}},
+        {"delay", 1, {{ParamId::DelayEnabled, 1.0f}, {ParamId::DelayTime, 0.25f},
+                      {ParamId::DelayFeedback, 0.7f}}},
+        {"chorus", 0, {{ParamId::ChorusEnabled, 1.0f}, {ParamId::ChorusDepth, 0.8f},
+                       {ParamId::ChorusMix, 0.5f}}},
+        {"reverb", 2, {{ParamId::ReverbEnabled, 1.0f}, {ParamId::ReverbSize, 0.9f}}},
+        {"all-effects", 0, {{ParamId::DelayEnabled, 1.0f}, {ParamId::ChorusEnabled, 1.0f},
+                            {ParamId::ReverbEnabled, 1.0f}}},
+        {"arpeggiator", 0, {{ParamId::ArpEnabled, 1.0f}, {ParamId::ArpRate, 180.0f},
+                            {ParamId::ArpPattern, 2.0f}}},
+    };
+    return cases;
+}
+
+// ---- Rendering and fingerprints ----
+
+struct Render {
+    uint64_t hash = 0;
+    std::vector<float> windows;   // level, brightness per window
+    double cpuSeconds = 0.0;
+};
+
+double threadCpuSeconds() {
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+bool renderCase(const Case& testCase, const std::string& midiPath, Render& render) {
+    SynthParams params;
+    for (const Setting& setting : testCase.settings) {
+        params.set(setting.id, setting.value);
+    }
+    const int64_t totalFrames = static_cast<int64_t>(kCaseSeconds * kCaseSampleRate);
+    std::vector<float> output(static_cast<size_t>(totalFrames));
+
+    SynthEngine engine(false);
+    engine.prepare(static_cast<float>(kCaseSampleRate), kBlockFrames);
+    engine.setRandomSeed(kSeed);
+    engine.applyParams(params.values, kParamCount);
+    if (!engine.loadMidiFile(midiPath.c_str())) {
+        return false;
+    }
+    engine.startMidiPlayback(false);
+    double start = threadCpuSeconds();
+    for (int64_t frame = 0; frame < totalFrames; frame += kBlockFrames) {
+        int32_t frames = static_cast<int32_t>(std::min<int64_t>(kBlockFrames, totalFrames - frame));
+        engine.render(output.data() + frame, frames);
+    }
+    render.cpuSeconds = threadCpuSeconds() - start;
+
+    // FNV-1a over the raw float bits
+    uint64_t hash = 0xCBF29CE484222325ull;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(output.data());
+    for (size_t i = 0; i < output.size() * sizeof(float); ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    render.hash = hash;
+
+    // RMS of the signal and of its first difference, which moves with the
+    // high-frequency content, so a filter change is caught even when the
+    // level stays about the same
+    render.windows.clear();
+    float previous = 0.0f;
+    for (size_t first = 0; first < output.size(); first += kWindowFrames) {
+        size_t end = std::min(output.size(), first + kWindowFrames);
+        double level = 0.0;
+        double brightness = 0.0;
+        for (size_t i = first; i < end; ++i) {
+            double difference = static_cast<double>(output[i]) - previous;
+            level += static_cast<double>(output[i]) * output[i];
+            brightness += difference * difference;
+            previous = output[i];
+        }
+        render.windows.push_back(static_cast<float>(std::sqrt(level / static_cast<double>(end - first))));
+        render.windows.push_back(static_cast<float>(std::sqrt(brightness / static_cast<double>(end - first))));
+    }
+    return true;
+}
+
+// ---- Golden and baseline files ----
+
+struct Golden {
+    uint64_t hash = 0;
+    std::vector<float> windows;
+};
+
+std::map<std::string, Golden> readGoldens(const std::string& path) {
+    std::map<std::string, Golden> goldens;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name;
+        std::string hash;
+        Golden golden;
+        if (!(fields >> name >> hash)) {
+            continue;
+        }
+        golden.hash = std::strtoull(hash.c_str(), nullptr, 16);
+        float value;
+        while (fields >> value) {
+            golden.windows.push_back(value);
+        }
+        goldens[name] = golden;
+    }
+    return goldens;
+}
+
+bool writeGoldens(const std::string& path, const std::vector<std::pair<std::string, Render>>& renders) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "# render_regression_test goldens: case, FNV-1a hash of the float output, then\n"
+                       "# level and brightness of every %d-frame window. %d Hz, %.1f s, seed %u.\n"
+                       "# Regenerate with render_regression_test --update-golden after a deliberate\n"
+                       "# change to the sound.\n",
+                 kWindowFrames, kCaseSampleRate, kCaseSeconds, kSeed);
+    for (const auto& [name, render] : renders) {
+        std::fprintf(file, "%s %016llx", name.c_str(), static_cast<unsigned long long>(render.hash));
+        for (float value : render.windows) {
+            std::fprintf(file, " %.7g", value);
+        }
+        std::fprintf(file, "\n");
+    }
+    return std::fclose(file) == 0;
+}
+
+// Case name -> times real time
+std::map<std::string, double> readBaseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        double speed;
+        if (line.empty() || line[0] == '#' || !(fields >> name >> speed)) {
+            continue;
+        }
+        baseline[name] = speed;
+    }
+    return baseline;
+}
+
+bool writeBaseline(const std::string& path, const std::map<std::string, double>& speeds) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "# render_regression_test throughput, times real time (best of %d, thread CPU time).\n"
+                       "# Only meaningful on the machine and build that wrote it.\n", kRepeats);
+    for (const auto& [name, speed] : speeds) {
+        std::fprintf(file, "%s %.2f\n", name.c_str(), speed);
+    }
+    return std::fclose(file) == 0;
+}
+
+// Largest level or brightness difference in dB; quiet windows count as equal
+double worstDifferenceDb(const std::vector<float>& golden, const std::vector<float>& current, size_t& worstWindow) {
+    constexpr double kFloor = 1e-6;   // -120 dBFS
+    double worst = 0.0;
+    worstWindow = 0;
+    for (size_t i = 0; i < golden.size(); ++i) {
+        double difference = std::fabs(20.0 * std::log10((current[i] + kFloor) / (golden[i] + kFloor)));
+        if (difference > worst) {
+            worst = difference;
+            worstWindow = i / 2;
+        }
+    }
+    return worst;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--exact") == 0) {
+            options.exact = true;
+        } else if (std::strcmp(arg, "--update-golden") == 0) {
+            options.updateGolden = true;
+        } else if (std::strcmp(arg, "--update-baseline") == 0) {
+            options.updateBaseline = true;
+        } else if (std::strcmp(arg, "--golden") == 0 && hasValue) {
+            options.goldenPath = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0 && hasValue) {
+            options.baselinePath = argv[++i];
+        } else if (std::strcmp(arg, "--tolerance-db") == 0 && hasValue) {
+            options.toleranceDb = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--perf-tolerance") == 0 && hasValue) {
+            options.perfTolerance = std::atof(argv[++i]);
+        } else if (arg[0] != '-' && !options.only) {
+            options.only = arg;
+        } else {
+            return false;
+        }
+    }
+    // Goldens are rewritten whole, so they need every case
+    return !(options.updateGolden && options.only);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--golden path] [--baseline path] [--tolerance-db db] "
+                             "[--perf-tolerance percent] [--exact] [--update-golden] [--update-baseline] "
+                             "[case]\n", argv[0]);
+        return 2;
+    }
+
+    struct Result {
+        const Case* testCase = nullptr;
+        Render render;
+        double best = 0.0;
+        bool ok = true;
+        bool deterministic = true;
+    };
+    std::vector<Result> results;
+    for (const Case& testCase : corpus()) {
+        if (!options.only || std::strcmp(options.only, testCase.name) == 0) {
+            Result result;
+            result.testCase = &testCase;
+            results.push_back(result);
+        }
+    }
+    if (results.empty()) {
+        std::fprintf(stderr, "no case named %s\n", options.only);
+        return 2;
+    }
+
+    std::vector<std::string> midiPaths;
+    for (const Song& song : kSongs) {
+        MidiTrack track;
+        song.write(track);
+        std::string path = "/tmp/noisysynth-regression-" + std::to_string(getpid()) + "-" + song.name + ".mid";
+        if (!track.write(path)) {
+            std::fprintf(stderr, "cannot write %s\n", path.c_str());
+            return 2;
+        }
+        midiPaths.push_back(path);
+    }
+
+    // Repeats go round the whole corpus rather than one case at a time, so
+    // a slow stretch of the machine lands on every case instead of all the
+    // renders of one
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+        for (Result& result : results) {
+            Render latest;
+            if (!result.ok || !renderCase(*result.testCase, midiPaths[result.testCase->song], latest)) {
+                result.ok = false;
+                continue;
+            }
+            if (repeat == 0) {
+                result.render = latest;
+                result.best = latest.cpuSeconds;
+            }
+            result.deterministic = result.deterministic && latest.hash == result.render.hash;
+            result.best = std::min(result.best, latest.cpuSeconds);
+        }
+    }
+
+    std::map<std::string, Golden> goldens = readGoldens(options.goldenPath);
+    std::map<std::string, double> baseline = readBaseline(options.baselinePath);
+    const bool recordBaseline = options.updateBaseline || baseline.empty();
+    std::map<std::string, double> speeds = baseline;
+    std::vector<std::pair<std::string, Render>> renders;
+
+    // Times real time against the baseline; returns the change in percent
+    auto compareSpeed = [&](const char* name, double speed, char* reference, size_t size) {
+        double change = 0.0;
+        auto previous = baseline.find(name);
+        if (previous == baseline.end()) {
+            std::snprintf(reference, size, "new");
+        } else {
+            change = (speed / previous->second - 1.0) * 100.0;
+            std::snprintf(reference, size, "%.1fx %+.0f%%", previous->second, change);
+        }
+        if (recordBaseline || previous == baseline.end()) {
+            speeds[name] = speed;
+        }
+        return recordBaseline ? 0.0 : change;
+    };
+
+    std::printf("     %-14s %-28s %9s %9s\n", "case", "sound", "speed", "baseline");
+    int failures = 0;
+    double audioSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    for (const Result& result : results) {
+        const char* name = result.testCase->name;
+        if (!result.ok) {
+            std::printf("FAIL %-14s cannot render\n", name);
+            ++failures;
+            continue;
+        }
+        const Render& render = result.render;
+        renders.emplace_back(name, render);
+
+        char sound[64];
+        bool soundOk = result.deterministic;
+        auto golden = goldens.find(name);
+        if (!result.deterministic) {
+            std::snprintf(sound, sizeof(sound), "NOT DETERMINISTIC");
+        } else if (options.updateGolden) {
+            std::snprintf(sound, sizeof(sound), "golden updated");
+        } else if (golden == goldens.end() || golden->second.windows.size() != render.windows.size()) {
+            std::snprintf(sound, sizeof(sound), "NO GOLDEN");
+            soundOk = false;
+        } else if (golden->second.hash == render.hash) {
+            std::snprintf(sound, sizeof(sound), "exact");
+        } else {
+            size_t window;
+            double worst = worstDifferenceDb(golden->second.windows, render.windows, window);
+            bool close = worst <= options.toleranceDb;
+            soundOk = close && !options.exact;
+            std::snprintf(sound, sizeof(sound), "%s %.3f dB @ %.2f s",
+                          soundOk ? "close" : close ? "NOT EXACT" : "DIFFERS", worst,
+                          static_cast<double>(window * kWindowFrames) / kCaseSampleRate);
+        }
+
+        // A single case is too noisy to fail on; the total below decides
+        char reference[32];
+        double change = compareSpeed(name, kCaseSeconds / result.best, reference, sizeof(reference));
+        audioSeconds += kCaseSeconds;
+        cpuSeconds += result.best;
+
+        std::printf("%-4s %-14s %-28s %8.1fx %s%s\n", soundOk ? "ok" : "FAIL", name, sound,
+                    kCaseSeconds / result.best, reference, change < -options.perfTolerance ? " slower" : "");
+        if (!soundOk) {
+            ++failures;
+        }
+    }
+
+    // Only the whole corpus has a comparable total
+    if (!options.only && cpuSeconds > 0.0) {
+        char reference[32];
+        double change = compareSpeed("total", audioSeconds / cpuSeconds, reference, sizeof(reference));
+        bool speedOk = change >= -options.perfTolerance;
+        std::printf("%-4s %-14s %-28s %8.1fx %s%s\n", speedOk ? "ok" : "FAIL", "total", "", audioSeconds / cpuSeconds,
+                    reference, speedOk ? "" : " SLOWER");
+        if (!speedOk) {
+            ++failures;
+        }
+    }
+
+    for (const std::string& path : midiPaths) {
+        unlink(path.c_str());
+    }
+    if (options.updateGolden) {
+        if (failures > 0) {
+            std::fprintf(stderr, "goldens not written: the render itself failed\n");
+        } else if (!writeGoldens(options.goldenPath, renders)) {
+            std::fprintf(stderr, "cannot write %s\n", options.goldenPath.c_str());
+            return 2;
+        }
+    }
+    if (speeds != baseline && !writeBaseline(options.baselinePath, speeds)) {
+        std::fprintf(stderr, "cannot write %s\n", options.baselinePath.c_str());
+        return 2;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,425 @@
+/*
+ * Drives the offline renderer through stress scenarios with the real-time
+ * safety checker (RtCheck.h) linked in. Any allocation, lock or blocking
+ * call made inside SynthEngine::render() fails the scenario.
+ *
+ * Usage: rt_safety_test [scenario]   (no argument runs them all)
+ */
+#include "BatchRender.h"
+#include "RtCheck.h"
+#include "SynthEngine.h"
+#include "TestMidi.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr int32_t kBlockFrames = 256;
+
+std::string tempPath(const char* name) {
+    return "/tmp/noisysynth-rtcheck-" + std::to_string(getpid()) + "-" + name;
+}
+
+// 16 beats of chordSong() on channels 0 and 1
+std::string writeTestMidiFile() {
+    MidiTrack track;
+    chordSong(track, 16);
+    std::string path = tempPath("song.mid");
+    return track.write(path) ? path : std::string();
+}
+
+void renderBlocks(SynthEngine& engine, int blocks, int32_t frames = kBlockFrames) {
+    std::vector<float> buffer(static_cast<size_t>(frames));
+    for (int i = 0; i < blocks; ++i) {
+        engine.render(buffer.data(), frames);
+    }
+}
+
+// Every parameter to random in-range values, through the control ring
+void randomizeParameters(SynthEngine& engine, Random& random) {
+    for (int id = 0; id < kParamCount; ++id) {
+        push(engine, ControlEventType::Parameter, id, randomInRange(random, kParamInfo[id]));
+    }
+}
+
+bool notesAndParameters() {
+    SynthEngine engine(false);
+    engine.prepare(48000.0f, kBlockFrames);
+    Random random(1);
+    for (int block = 0; block < 2000; ++block) {
+        if (block % 200 == 0) {
+            randomizeParameters(engine, random);
+        }
+        for (int i = 0; i < 4; ++i) {
+            int note = 36 + random.nextInt(48);
+            bool on = random.nextInt(2) == 0;
+            push(engine, on ? ControlEventType::NoteOn : ControlEventType::NoteOff, note, 0.8f);
+        }
+        push(engine, ControlEventType::PitchBend, 0, random.nextBipolar());
+        push(engine, ControlEventType::NoteExpression, 36 + random.nextInt(48), random.nextBipolar(),
+             random.nextInt(3));
+        renderBlocks(engine, 1);
+    }
+    return true;
+}
+
+bool arpeggiatorSequencerAndEffects() {
+    SynthEngine engine(false);
+    engine.prepare(48000.0f, kBlockFrames);
+    engine.setDelayEnabled(true);
+    engine.setChorusEnabled(true);
+    engine.setReverbEnabled(true);
+    for (int lfo = 0; lfo < kNumLfos; ++lfo) {
+        engine.setLfoPerVoice(lfo, true);
+        engine.setLfoShape(lfo, lfo + 1);
+    }
+    engine.setArpeggiatorEnabled(true);
+    engine.setArpeggiatorRate(600.0f);
+    for (int pattern = 0; pattern < 4; ++pattern) {
+        engine.setArpeggiatorPattern(pattern);
+        for (int note = 48; note < 72; note += 3) {
+            push(engine, ControlEventType::NoteOn, note, 1.0f);
+        }
+        renderBlocks(engine, 300);
+        for (int note = 48; note < 72; note += 3) {
+            push(engine, ControlEventType::NoteOff, note, 0.0f);
+        }
+        renderBlocks(engine, 50);
+    }
+    engine.setArpeggiatorEnabled(false);
+    engine.setSequencerTempo(480.0f);
+    engine.setSequencerEnabled(true);
+    renderBlocks(engine, 500);
+
+    // Multi-track chord patterns edited and chained while they play
+    const int chord[] = {48, 55, 60, 64};
+    for (int step = 0; step < 16; ++step) {
+        engine.setSequencerChordStep(1, step % kSequencerMaxTracks, step, chord, 1 + step % 4,
+                                     0.5f + step / 32.0f, 0.2f + step / 20.0f);
+        engine.setSequencerTrack(step % kSequencerMaxTracks, step % 3 - 1, false);
+        renderBlocks(engine, 20);
+    }
+    // Parameter locks, a glide lane and recorded knob moves
+    for (int step = 0; step < 16; step += 3) {
+        engine.setSequencerParameterLock(1, step, ParamId::FilterCutoff, -1, step / 16.0f);
+        engine.setSequencerParameterLock(1, step + 1, ParamId::DelayMix, -1, 0.8f);
+        engine.setSequencerParameterLock(1, step, ParamId::Release, 2, 0.1f);
+    }
+    engine.setSequencerLane(1, 0, static_cast<int>(ParamId::FilterCutoff), -1, true);
+    for (int i = 0; i < 50; ++i) {
+        engine.recordSequencerParameter(ParamId::ReverbMix, -1, i / 50.0f);
+        renderBlocks(engine, 4);
+    }
+    engine.setSequencerPatternLength(1, 16, 0);
+    const int patterns[] = {0, 1, 1};
+    const int repeats[] = {1, 2, 1};
+    engine.setSequencerSong(patterns, repeats, 3);
+    engine.setSequencerSongMode(true);
+    renderBlocks(engine, 1000);
+    engine.setSequencerEnabled(false);
+    renderBlocks(engine, 50);
+    return true;
+}
+
+bool multiTimbralParts() {
+    SynthEngine engine(false);
+    engine.prepare(48000.0f, kBlockFrames);
+    for (int part = 1; part < kMaxParts; ++part) {
+        engine.setPartEnabled(part, true);
+        engine.setPartKeyRange(part, part * 12, part * 12 + 23);
+        engine.setPartSend(part, PartSend::Reverb, 0.5f);
+    }
+    engine.setReverbEnabled(true);
+    Random random(7);
+    for (int block = 0; block < 1500; ++block) {
+        int part = random.nextInt(kMaxParts);
+        int note = random.nextInt(128);
+        push(engine, random.nextInt(3) ? ControlEventType::PartNoteOn : ControlEventType::PartNoteOff, note, 1.0f, part);
+        push(engine, ControlEventType::PartParameter, static_cast<int32_t>(ParamId::Waveform),
+             static_cast<float>(random.nextInt(6)), part);
+        push(engine, ControlEventType::NoteOn, random.nextInt(128), 0.5f);
+        // Part layout and mixing changes arrive through the ring too
+        int other = 1 + random.nextInt(kMaxParts - 1);
+        switch (random.nextInt(8)) {
+            case 0:
+                push(engine, ControlEventType::PartEnabled, 0, static_cast<float>(random.nextInt(2)), other);
+                break;
+            case 1:
+                push(engine, ControlEventType::PartKeyRange, random.nextInt(64), static_cast<float>(64 + random.nextInt(64)), other);
+                break;
+            case 2:
+                push(engine, ControlEventType::PartMidiChannel, random.nextInt(17) - 1, 0.0f, other);
+                break;
+            case 3:
+                push(engine, ControlEventType::PartLevel, 0, static_cast<float>(random.nextInt(200)) / 100.0f, part);
+                break;
+            case 4:
+                push(engine, ControlEventType::PartSend, random.nextInt(kPartSendCount),
+                     static_cast<float>(random.nextInt(100)) / 100.0f, part);
+                break;
+            default:
+                break;
+        }
+        renderBlocks(engine, 1);
+    }
+    return true;
+}
+
+bool loopFreeze() {
+    SynthEngine engine(false);
+    engine.prepare(48000.0f, kBlockFrames);
+    engine.setLoopFreezeEnabled(true);
+    engine.setPartEnabled(1, true);
+    engine.setPartSend(1, PartSend::Delay, 0.5f);
+    engine.setDelayEnabled(true);
+    engine.setReverbEnabled(true);
+    engine.setSequencerTrack(1, 1, false);
+    const int chord[] = {55, 59, 62};
+    for (int step = 0; step < 8; step += 2) {
+        engine.setSequencerChordStep(0, 1, step, chord, 3, 0.8f, 0.5f);
+    }
+    engine.setSequencerPatternLength(0, 8, 0);
+    engine.setSequencerTempo(480.0f);
+    engine.setSequencerEnabled(true);
+
+    // Capture and replay, with live notes and effect changes on top
+    renderBlocks(engine, 600);
+    if (engine.getLoopFreezeState() != LoopFreezeState::Playing) {
+        std::fprintf(stderr, "loop never froze\n");
+        return false;
+    }
+    for (int block = 0; block < 300; ++block) {
+        push(engine, (block % 8 < 4) ? ControlEventType::NoteOn : ControlEventType::NoteOff, 48 + block % 4, 1.0f);
+        push(engine, ControlEventType::Parameter, static_cast<int32_t>(ParamId::ReverbMix), (block % 10) / 10.0f);
+        renderBlocks(engine, 1);
+    }
+
+    // Edits hand back to the voices; tempo changes and a stop cut it
+    push(engine, ControlEventType::Parameter, static_cast<int32_t>(ParamId::FilterCutoff), 0.3f);
+    renderBlocks(engine, 400);
+    engine.setSequencerParameterLock(0, 3, ParamId::Release, 1, 0.05f);
+    renderBlocks(engine, 400);
+    engine.setSequencerTempo(300.0f);
+    renderBlocks(engine, 200);
+    engine.setSequencerEnabled(false);
+    renderBlocks(engine, 50);
+    engine.setLoopFreezeEnabled(false);
+    renderBlocks(engine, 50);
+    return true;
+}
+
+bool visualTaps() {
+    SynthEngine engine(false);
+    engine.prepare(48000.0f, kBlockFrames);
+    engine.setVisualTapsEnabled(true);
+    engine.setReverbEnabled(true);
+    VisualTaps* taps = engine.getVisualTaps();
+
+    // A reader taking frames the whole time, as the UI does
+    std::atomic<bool> reading{true};
+    uint32_t lastScope = 0;
+    uint32_t lastSpectrum = 0;
+    std::thread reader([&] {
+        while (reading.load()) {
+            lastScope = taps->scopeFrames()[taps->acquireScope()].sequence;
+            lastSpectrum = taps->spectrumFrames()[taps->acquireSpectrum()].sequence;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+
+    // Single bus, then parts mixed separately, with a pause for the analysis thread
+    for (int block = 0; block < 400; ++block) {
+        if (block % 16 == 0) {
+            push(engine, ControlEventType::NoteOn, 48 + (block / 16) % 12, 1.0f);
+        }
+        if (block == 200) {
+            engine.setPartEnabled(1, true);
+            engine.setPartSend(1, PartSend::Reverb, 0.7f);
+        }
+        renderBlocks(engine, 1);
+        if (block % 50 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    engine.setVisualTapsEnabled(false);
+    renderBlocks(engine, 50);
+    engine.setVisualTapsEnabled(true);
+    renderBlocks(engine, 50);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    reading.store(false);
+    reader.join();
+
+    if (lastScope == 0 || lastSpectrum == 0) {
+        std::fprintf(stderr, "taps published no frames (scope %u, spectrum %u)\n", lastScope, lastSpectrum);
+        return false;
+    }
+    return true;
+}
+
+// Device callbacks while recording, at both sample formats
+bool recording() {
+    SynthEngine engine(false);
+    engine.prepare(48000.0f, kBlockFrames);
+    std::vector<float> output(kBlockFrames);
+    bool ok = true;
+    for (WavSampleFormat format : {WavSampleFormat::Float32, WavSampleFormat::Pcm16}) {
+        std::string path = tempPath("recording.wav");
+        if (!engine.startRecording(path, format)) {
+            return false;
+        }
+        const int blocks = 2000;
+        for (int block = 0; block < blocks; ++block) {
+            if (block % 64 == 0) {
+                push(engine, ControlEventType::NoteOn, 48 + (block / 64) % 12, 1.0f);
+            }
+            engine.onAudioReady(output.data(), kBlockFrames);
+        }
+        ok = engine.stopRecording() && ok;
+        RecorderStats stats = engine.getRecorderStats();
+        if (stats.framesWritten + stats.droppedFrames != static_cast<uint64_t>(blocks) * kBlockFrames) {
+            std::fprintf(stderr, "recorded %llu + dropped %llu frames\n",
+                         static_cast<unsigned long long>(stats.framesWritten),
+                         static_cast<unsigned long long>(stats.droppedFrames));
+            ok = false;
+        }
+        unlink(path.c_str());
+    }
+    return ok;
+}
+
+bool midiPlaybackAndTuning() {
+    std::string midiPath = writeTestMidiFile();
+    const char scale[] = "! test.scl\nquarter tones\n 24\n!\n"
+                         "50.0\n100.0\n150.0\n200.0\n250.0\n300.0\n350.0\n400.0\n450.0\n500.0\n550.0\n600.0\n"
+                         "650.0\n700.0\n750.0\n800.0\n850.0\n900.0\n950.0\n1000.0\n1050.0\n1100.0\n1150.0\n2/1\n";
+    std::string sclPath = tempPath("test.scl");
+    if (midiPath.empty() || !writeFile(sclPath, scale, sizeof(scale) - 1)) {
+        std::fprintf(stderr, "cannot write test files\n");
+        return false;
+    }
+
+    SynthEngine engine(false);
+    engine.prepare(48000.0f, kBlockFrames);
+    bool ok = engine.loadMidiFile(midiPath.c_str());
+    engine.startMidiPlayback(true);
+    for (int round = 0; round < 6 && ok; ++round) {
+        renderBlocks(engine, 300);
+        // Control-thread work between callbacks; the audio thread picks it up
+        switch (round % 3) {
+            case 0: ok = engine.loadScalaTuning(sclPath.c_str(), nullptr); break;
+            case 1: ok = engine.setTuningReference(432.0f); break;
+            default: ok = engine.resetTuning() && engine.loadMidiFile(midiPath.c_str()); break;
+        }
+    }
+    renderBlocks(engine, 300);
+    engine.stopMidiPlayback();
+    renderBlocks(engine, 50);
+
+    unlink(midiPath.c_str());
+    unlink(sclPath.c_str());
+    return ok;
+}
+
+bool oddBlockSizes() {
+    SynthEngine engine(false);
+    engine.prepare(44100.0f, 192);
+    Random random(3);
+    std::vector<float> buffer(2048);
+    for (int block = 0; block < 1500; ++block) {
+        if (block % 50 == 0) {
+            push(engine, ControlEventType::NoteOn, 40 + random.nextInt(40), 1.0f);
+        }
+        // Larger than the prepared size, so render() splits them
+        engine.render(buffer.data(), 1 + random.nextInt(static_cast<int>(buffer.size())));
+    }
+    return true;
+}
+
+bool batchRender() {
+    std::string midiPath = writeTestMidiFile();
+    if (midiPath.empty()) {
+        return false;
+    }
+    std::vector<BatchJob> jobs(4);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].midiPath = midiPath;
+        jobs[i].outputPath = tempPath(("batch" + std::to_string(i) + ".wav").c_str());
+        jobs[i].params = SynthParams();
+        jobs[i].params.values[static_cast<int>(ParamId::Waveform)] = static_cast<float>(i);
+        jobs[i].seconds = 3.0;
+    }
+    std::vector<BatchResult> results = renderBatch(jobs, 2, nullptr);
+    bool ok = true;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        ok = ok && results[i].ok;
+        unlink(jobs[i].outputPath.c_str());
+    }
+    unlink(midiPath.c_str());
+    return ok;
+}
+
+// The checker itself: a deliberate allocation inside a render scope must count
+bool checkerTrapsAllocation() {
+    {
+        // Through volatile pointers so the pair is not optimized away
+        void* (*volatile allocate)(size_t) = std::malloc;
+        void (*volatile release)(void*) = std::free;
+        RtRenderScope scope;
+        release(allocate(64));
+    }
+    bool trapped = rtCheckViolationCount() >= 2;
+    rtCheckReset();
+    return trapped;
+}
+
+struct Scenario {
+    const char* name;
+    bool (*run)();
+    bool expectViolations;
+};
+
+const Scenario kScenarios[] = {
+    {"checker", checkerTrapsAllocation, true},
+    {"notes", notesAndParameters, false},
+    {"arp-seq-fx", arpeggiatorSequencerAndEffects, false},
+    {"parts", multiTimbralParts, false},
+    {"loop-freeze", loopFreeze, false},
+    {"visual-taps", visualTaps, false},
+    {"recording", recording, false},
+    {"midi-tuning", midiPlaybackAndTuning, false},
+    {"block-sizes", oddBlockSizes, false},
+    {"batch", batchRender, false},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    rtCheckSetMode(RtCheckMode::Count);
+    int failures = 0;
+    for (const Scenario& scenario : kScenarios) {
+        if (argc > 1 && std::strcmp(argv[1], scenario.name) != 0) {
+            continue;
+        }
+        rtCheckReset();
+        bool ok = scenario.run();
+        uint64_t violations = rtCheckViolationCount();
+        if (!scenario.expectViolations && violations > 0) {
+            std::printf("FAIL %s: %llu violations, first in %s\n", scenario.name,
+                        static_cast<unsigned long long>(violations), rtCheckFirstViolation());
+            ++failures;
+        } else if (!ok) {
+            std::printf("FAIL %s\n", scenario.name);
+            ++failures;
+        } else {
+            std::printf("ok   %s\n", scenario.name);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
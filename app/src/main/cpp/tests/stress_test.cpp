@@ -0,0 +1,328 @@
+/*
+ * Worst-case render timing under randomized event storms.
+ *
+ * Each storm drives the offline renderer with a seeded burst pattern
+ * (voice stealing, parameter floods, sequencer edits mid-playback, every
+ * effect at maximum feedback) and times every block. The report gives
+ * p50 / p99 / p99.9 / max per block in microseconds and as a share of the
+ * block's real-time budget; a storm fails when p99.9 or max passes its
+ * limit. The same seed replays the same events.
+ *
+ * Times are the render thread's CPU time unless --wall is given, so a
+ * busy test machine preempting the run does not count against the engine.
+ * --no-limits only reports: the limits assume an optimized build.
+ *
+ * Usage: stress_test [--seed n] [--blocks n] [--frames n] [--rate hz]
+ *                    [--p999 percent] [--max percent] [--no-limits] [--wall] [storm]
+ */
+#include "SynthEngine.h"
+#include "TestMidi.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+struct Options {
+    uint32_t seed = 1;
+    int blocks = 4000;
+    int32_t frames = 256;
+    float sampleRate = 48000.0f;
+    double p999Limit = 50.0;     // percent of the block budget
+    double maxLimit = 100.0;
+    bool limits = true;
+    bool wallClock = false;
+    const char* storm = nullptr;
+};
+
+// Blocks rendered before timing starts, so first-touch page faults and
+// cold caches do not count as the engine's worst case
+constexpr int kWarmupBlocks = 16;
+
+void pushParameter(SynthEngine& engine, ParamId id, float value) {
+    push(engine, ControlEventType::Parameter, static_cast<int32_t>(id), value);
+}
+
+/*
+ * Storms. setup() runs once after prepare(); step() runs before every
+ * block, playing the control thread: it pushes events and calls the
+ * engine's setters, and none of it is timed.
+ */
+
+// Bursts of more notes than voices in a single block, so every voice is
+// stolen at once, with long releases keeping all of them busy
+void voiceStealSetup(SynthEngine& engine, Random&) {
+    pushParameter(engine, ParamId::Release, kParamInfo[static_cast<int>(ParamId::Release)].maxValue);
+    pushParameter(engine, ParamId::Sustain, 1.0f);
+}
+
+void voiceStealStep(SynthEngine& engine, Random& random, int block) {
+    if (block % 4 == 0) {
+        int burst = kMaxVoices + random.nextInt(kMaxVoices + 1);
+        for (int i = 0; i < burst; ++i) {
+            push(engine, ControlEventType::NoteOn, 24 + random.nextInt(84),
+                 0.1f + 0.9f * static_cast<float>(random.nextInt(100)) / 99.0f);
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        push(engine, ControlEventType::NoteOff, 24 + random.nextInt(84), 0.0f);
+    }
+}
+
+// Every block a flood of random parameter changes over held notes, and the
+// whole patch at once now and then
+void parameterStep(SynthEngine& engine, Random& random, int block) {
+    if (block % 256 == 0) {
+        for (int i = 0; i < kMaxVoices; ++i) {
+            push(engine, ControlEventType::NoteOn, 36 + random.nextInt(48), 1.0f);
+        }
+    }
+    if (block % 64 == 0) {
+        for (int id = 0; id < kParamCount; ++id) {
+            push(engine, ControlEventType::Parameter, id, randomInRange(random, kParamInfo[id]));
+        }
+    }
+    for (int i = 0; i < 32; ++i) {
+        int id = random.nextInt(kParamCount);
+        push(engine, ControlEventType::Parameter, id, randomInRange(random, kParamInfo[id]));
+    }
+    push(engine, ControlEventType::PitchBend, 0, random.nextBipolar());
+    for (int i = 0; i < 4; ++i) {
+        push(engine, ControlEventType::NoteExpression, 36 + random.nextInt(48), random.nextBipolar(),
+             random.nextInt(3));
+    }
+}
+
+// Four tracks of four-note chords on every step at a fast tempo, with the
+// pattern's length, step length and contents edited while it plays
+void sequencerSetup(SynthEngine& engine, Random& random) {
+    for (int pattern = 0; pattern < 4; ++pattern) {
+        engine.setSequencerPatternLength(pattern, 64, 3);
+        for (int track = 0; track < kSequencerMaxTracks; ++track) {
+            for (int step = 0; step < 64; ++step) {
+                int notes[kSequencerMaxChordNotes];
+                for (int& note : notes) {
+                    note = 36 + random.nextInt(48);
+                }
+                engine.setSequencerChordStep(pattern, track, step, notes, kSequencerMaxChordNotes, 1.0f, 0.9f);
+            }
+        }
+    }
+    engine.setSequencerTempo(300.0f);
+    engine.setSequencerEnabled(true);
+}
+
+void sequencerStep(SynthEngine& engine, Random& random, int block) {
+    if (block % 8 != 0) {
+        return;
+    }
+    switch (random.nextInt(7)) {
+        case 0: engine.setSequencerMeasures(1 + random.nextInt(16)); break;
+        case 1: engine.setSequencerStepLength(random.nextInt(4)); break;
+        case 2:
+            engine.setSequencerPatternLength(random.nextInt(4), 1 + random.nextInt(kSequencerMaxSteps),
+                                             random.nextInt(4));
+            break;
+        case 3: engine.selectSequencerPattern(random.nextInt(4)); break;
+        case 4: engine.copySequencerPattern(random.nextInt(4), random.nextInt(4)); break;
+        case 5: engine.setSequencerTempo(60.0f + static_cast<float>(random.nextInt(400))); break;
+        default: {
+            int id = random.nextInt(kParamCount);
+            engine.setSequencerParameterLock(random.nextInt(4), random.nextInt(64), static_cast<ParamId>(id), -1,
+                                             randomInRange(random, kParamInfo[id]));
+            break;
+        }
+    }
+}
+
+// Every effect on at its most expensive and longest-ringing settings, with
+// all parts playing into the sends
+void effectsSetup(SynthEngine& engine, Random&) {
+    const ParamId maxed[] = {ParamId::DelayFeedback, ParamId::DelayMix, ParamId::ChorusDepth, ParamId::ChorusMix,
+                             ParamId::ReverbSize, ParamId::ReverbMix, ParamId::Release};
+    for (ParamId id : maxed) {
+        pushParameter(engine, id, kParamInfo[static_cast<int>(id)].maxValue);
+    }
+    pushParameter(engine, ParamId::ReverbDamping, kParamInfo[static_cast<int>(ParamId::ReverbDamping)].minValue);
+    engine.setDelayEnabled(true);
+    engine.setChorusEnabled(true);
+    engine.setReverbEnabled(true);
+    for (int part = 1; part < kMaxParts; ++part) {
+        engine.setPartEnabled(part, true);
+        for (int send = 0; send < static_cast<int>(PartSend::Count); ++send) {
+            engine.setPartSend(part, static_cast<PartSend>(send), 1.0f);
+        }
+    }
+}
+
+void effectsStep(SynthEngine& engine, Random& random, int block) {
+    if (block % 16 == 0) {
+        for (int i = 0; i < kMaxVoices; ++i) {
+            push(engine, ControlEventType::PartNoteOn, 24 + random.nextInt(84), 1.0f, random.nextInt(kMaxParts));
+        }
+    }
+    if (block % 32 == 0) {
+        const ParamInfo& info = kParamInfo[static_cast<int>(ParamId::DelayTime)];
+        pushParameter(engine, ParamId::DelayTime, randomInRange(random, info));
+    }
+}
+
+// All of the above at once
+void everythingSetup(SynthEngine& engine, Random& random) {
+    sequencerSetup(engine, random);
+    effectsSetup(engine, random);
+}
+
+void everythingStep(SynthEngine& engine, Random& random, int block) {
+    voiceStealStep(engine, random, block);
+    parameterStep(engine, random, block);
+    sequencerStep(engine, random, block);
+    effectsStep(engine, random, block);
+    // The parameter flood would switch the effects off again
+    if (block % 64 == 0) {
+        engine.setDelayEnabled(true);
+        engine.setChorusEnabled(true);
+        engine.setReverbEnabled(true);
+    }
+}
+
+struct Storm {
+    const char* name;
+    void (*setup)(SynthEngine&, Random&);
+    void (*step)(SynthEngine&, Random&, int);
+};
+
+const Storm kStorms[] = {
+    {"voice-steal", voiceStealSetup, voiceStealStep},
+    {"parameters", nullptr, parameterStep},
+    {"sequencer", sequencerSetup, sequencerStep},
+    {"effects", effectsSetup, effectsStep},
+    {"everything", everythingSetup, everythingStep},
+};
+
+double nowSeconds(bool wallClock) {
+    if (wallClock) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+// Nearest rank; sorted must be sorted and not empty
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+bool runStorm(const Storm& storm, const Options& options, uint32_t seed) {
+    SynthEngine engine(false);
+    engine.prepare(options.sampleRate, options.frames);
+    engine.setRandomSeed(seed);
+    Random random(seed);
+    if (storm.setup) {
+        storm.setup(engine, random);
+    }
+
+    std::vector<float> buffer(static_cast<size_t>(options.frames));
+    std::vector<double> times;
+    times.reserve(static_cast<size_t>(options.blocks));
+    for (int block = -kWarmupBlocks; block < options.blocks; ++block) {
+        storm.step(engine, random, block + kWarmupBlocks);
+        double start = nowSeconds(options.wallClock);
+        engine.render(buffer.data(), options.frames);
+        double elapsed = nowSeconds(options.wallClock) - start;
+        if (block >= 0) {
+            times.push_back(elapsed);
+        }
+    }
+    std::sort(times.begin(), times.end());
+
+    double budget = options.frames / static_cast<double>(options.sampleRate);
+    double p50 = percentile(times, 0.5);
+    double p99 = percentile(times, 0.99);
+    double p999 = percentile(times, 0.999);
+    double max = times.back();
+    bool ok = !options.limits
+        || (p999 <= budget * options.p999Limit / 100.0 && max <= budget * options.maxLimit / 100.0);
+    const char* status = !options.limits ? "-" : ok ? "ok" : "FAIL";
+    std::printf("%-4s %-12s %8.1f %8.1f %8.1f %8.1f   %5.1f%% %5.1f%%\n", status, storm.name,
+                p50 * 1e6, p99 * 1e6, p999 * 1e6, max * 1e6, p999 / budget * 100.0, max / budget * 100.0);
+    return ok;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--wall") == 0) {
+            options.wallClock = true;
+        } else if (std::strcmp(arg, "--no-limits") == 0) {
+            options.limits = false;
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--blocks") == 0 && hasValue) {
+            options.blocks = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--frames") == 0 && hasValue) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--rate") == 0 && hasValue) {
+            options.sampleRate = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--p999") == 0 && hasValue) {
+            options.p999Limit = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--max") == 0 && hasValue) {
+            options.maxLimit = std::atof(argv[++i]);
+        } else if (arg[0] != '-' && !options.storm) {
+            options.storm = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.blocks > 0 && options.frames > 0 && options.sampleRate > 0.0f;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [--seed n] [--blocks n] [--frames n] [--rate hz] "
+                             "[--p999 percent] [--max percent] [--no-limits] [--wall] [storm]\n", argv[0]);
+        return 2;
+    }
+
+    double budget = options.frames / static_cast<double>(options.sampleRate);
+    std::printf("seed %u, %d blocks of %d frames at %.0f Hz (budget %.1f us), %s time, ",
+                options.seed, options.blocks, options.frames, options.sampleRate, budget * 1e6,
+                options.wallClock ? "wall" : "cpu");
+    if (options.limits) {
+        std::printf("limits p99.9 %.0f%% max %.0f%%\n", options.p999Limit, options.maxLimit);
+    } else {
+        std::printf("no limits\n");
+    }
+    std::printf("     %-12s %8s %8s %8s %8s   %6s %6s\n", "storm", "p50 us", "p99 us", "p99.9 us", "max us",
+                "p99.9", "max");
+
+    int failures = 0;
+    int run = 0;
+    for (size_t i = 0; i < sizeof(kStorms) / sizeof(kStorms[0]); ++i) {
+        const Storm& storm = kStorms[i];
+        if (options.storm && std::strcmp(options.storm, storm.name) != 0) {
+            continue;
+        }
+        // Each storm gets its own stream, so running one alone replays it exactly
+        if (!runStorm(storm, options, options.seed * 2654435761u + static_cast<uint32_t>(i))) {
+            ++failures;
+        }
+        ++run;
+    }
+    if (run == 0) {
+        std::fprintf(stderr, "no storm named %s\n", options.storm);
+        return 2;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -1,5 +1,10 @@
 package com.example.noisysynth
 
+import android.os.Looper
+import android.view.Choreographer
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
 /**
  * Kotlin wrapper for the native C++ synthesizer engine
  * This class interfaces with the Oboe-based audio engine written in C++
@@ -13,178 +18,505 @@ class SynthEngine {
     // Native method declarations
     private external fun create(): Long
     private external fun destroy(engineHandle: Long)
-    private external fun native_noteOn(engineHandle: Long, midiNote: Int)
-    private external fun native_noteOff(engineHandle: Long, midiNote: Int)
-    private external fun native_setWaveform(engineHandle: Long, waveform: Int)
-    private external fun native_setFilterCutoff(engineHandle: Long, cutoff: Float)
-    private external fun native_setFilterResonance(engineHandle: Long, resonance: Float)
-    private external fun native_setAttack(engineHandle: Long, attack: Float)
-    private external fun native_setDecay(engineHandle: Long, decay: Float)
-    private external fun native_setSustain(engineHandle: Long, sustain: Float)
-    private external fun native_setRelease(engineHandle: Long, release: Float)
-    private external fun native_setFilterAttack(engineHandle: Long, attack: Float)
-    private external fun native_setFilterDecay(engineHandle: Long, decay: Float)
-    private external fun native_setFilterSustain(engineHandle: Long, sustain: Float)
-    private external fun native_setFilterRelease(engineHandle: Long, release: Float)
-    private external fun native_setFilterEnvelopeAmount(engineHandle: Long, amount: Float)
-    private external fun native_setLFORate(engineHandle: Long, rate: Float)
-    private external fun native_setLFOAmount(engineHandle: Long, amount: Float)
-    private external fun native_setDelayEnabled(engineHandle: Long, enabled: Boolean)
-    private external fun native_setDelayTime(engineHandle: Long, time: Float)
-    private external fun native_setDelayFeedback(engineHandle: Long, feedback: Float)
-    private external fun native_setDelayMix(engineHandle: Long, mix: Float)
-    private external fun native_setChorusEnabled(engineHandle: Long, enabled: Boolean)
-    private external fun native_setChorusRate(engineHandle: Long, rate: Float)
-    private external fun native_setChorusDepth(engineHandle: Long, depth: Float)
-    private external fun native_setChorusMix(engineHandle: Long, mix: Float)
-    private external fun native_setReverbEnabled(engineHandle: Long, enabled: Boolean)
-    private external fun native_setReverbSize(engineHandle: Long, size: Float)
-    private external fun native_setReverbDamping(engineHandle: Long, damping: Float)
-    private external fun native_setReverbMix(engineHandle: Long, mix: Float)
-    private external fun native_setArpeggiatorEnabled(engineHandle: Long, enabled: Boolean)
-    private external fun native_setArpeggiatorPattern(engineHandle: Long, pattern: Int)
-    private external fun native_setArpeggiatorRate(engineHandle: Long, bpm: Float)
-    private external fun native_setArpeggiatorGate(engineHandle: Long, gate: Float)
-    private external fun native_setArpeggiatorSubdivision(engineHandle: Long, subdivision: Int)
     private external fun native_setSequencerEnabled(engineHandle: Long, enabled: Boolean)
     private external fun native_setSequencerTempo(engineHandle: Long, bpm: Float)
     private external fun native_setSequencerStepLength(engineHandle: Long, stepLength: Int)
     private external fun native_setSequencerMeasures(engineHandle: Long, measures: Int)
     private external fun native_setSequencerStep(engineHandle: Long, index: Int, midiNote: Int, active: Boolean)
+    private external fun native_setSequencerPatternLength(engineHandle: Long, pattern: Int, steps: Int, stepLength: Int)
+    private external fun native_setSequencerChordStep(
+        engineHandle: Long, pattern: Int, track: Int, step: Int, notes: IntArray, velocity: Float, gate: Float
+    )
+    private external fun native_clearSequencerPattern(engineHandle: Long, pattern: Int)
+    private external fun native_copySequencerPattern(engineHandle: Long, from: Int, to: Int)
+    private external fun native_setSequencerTrack(engineHandle: Long, track: Int, part: Int, muted: Boolean)
+    private external fun native_selectSequencerPattern(engineHandle: Long, pattern: Int)
+    private external fun native_setSequencerSong(engineHandle: Long, patterns: IntArray, repeats: IntArray)
+    private external fun native_setSequencerSongMode(engineHandle: Long, enabled: Boolean)
+    private external fun native_setSequencerLane(engineHandle: Long, pattern: Int, lane: Int, param: Int, part: Int, glide: Boolean): Boolean
+    private external fun native_setSequencerParameterLock(engineHandle: Long, pattern: Int, step: Int, id: Int, part: Int, value: Float): Boolean
+    private external fun native_clearSequencerParameterLock(engineHandle: Long, pattern: Int, step: Int, id: Int, part: Int)
+    private external fun native_recordSequencerParameter(engineHandle: Long, id: Int, part: Int, value: Float): Boolean
+    private external fun native_loadPresetBank(engineHandle: Long, path: String): Boolean
+    private external fun native_getPresetCount(engineHandle: Long): Int
+    private external fun native_getPresetName(engineHandle: Long, index: Int): String
+    private external fun native_getSortedPresetIndex(engineHandle: Long, position: Int): Int
+    private external fun native_findPreset(engineHandle: Long, name: String): Int
+    private external fun native_findPresetsByTag(engineHandle: Long, tag: String): IntArray
+    private external fun native_getPresetValues(engineHandle: Long, index: Int): FloatArray?
+    private external fun native_getControlBuffer(engineHandle: Long): ByteBuffer
+    private external fun native_commitControlEvents(engineHandle: Long, writeIndex: Int): Boolean
+    private external fun native_loadMidiFile(engineHandle: Long, path: String): Boolean
+    private external fun native_startMidiPlayback(engineHandle: Long, loop: Boolean)
+    private external fun native_stopMidiPlayback(engineHandle: Long)
+    private external fun native_isMidiPlaying(engineHandle: Long): Boolean
+    private external fun native_loadScalaTuning(engineHandle: Long, sclPath: String, kbmPath: String?): Boolean
+    private external fun native_setTuningReference(engineHandle: Long, referenceHz: Float): Boolean
+    private external fun native_resetTuning(engineHandle: Long): Boolean
+    private external fun native_setRenderAheadEnabled(engineHandle: Long, enabled: Boolean)
+    private external fun native_isRenderingAhead(engineHandle: Long): Boolean
+    private external fun native_setLoopFreezeEnabled(engineHandle: Long, enabled: Boolean)
+    private external fun native_getLoopFreezeState(engineHandle: Long): Int
+    private external fun native_setVisualTapsEnabled(engineHandle: Long, enabled: Boolean)
+    private external fun native_getScopeBuffer(engineHandle: Long): ByteBuffer?
+    private external fun native_getSpectrumBuffer(engineHandle: Long): ByteBuffer?
+    private external fun native_acquireScopeFrame(engineHandle: Long): Int
+    private external fun native_acquireSpectrumFrame(engineHandle: Long): Int
+    private external fun native_startRecording(engineHandle: Long, path: String, format: Int): Boolean
+    private external fun native_stopRecording(engineHandle: Long): Boolean
+    private external fun native_isRecording(engineHandle: Long): Boolean
+    private external fun native_getRecordedFrames(engineHandle: Long): Long
+    private external fun native_getRecordingDroppedBlocks(engineHandle: Long): Int
+    private external fun native_getRecordingLatencyMs(engineHandle: Long): Float
+    private external fun native_getRecordingMaxLatencyMs(engineHandle: Long): Float
+    private external fun native_hasRecordingFailed(engineHandle: Long): Boolean
+    private external fun native_writeRenderTrace(path: String): Boolean
+    private external fun native_clearRenderTrace()
+    private external fun native_isRenderTraceAvailable(): Boolean
+    private external fun native_setQualityGovernorEnabled(engineHandle: Long, enabled: Boolean)
+    private external fun native_getQualityTier(engineHandle: Long): Int
+    private external fun native_getRenderLoad(engineHandle: Long): Float
+    private external fun native_getPeakRenderLoad(engineHandle: Long): Float
+    private external fun native_setRenderRateMode(engineHandle: Long, mode: Int)
+    private external fun native_getDeviceSampleRate(engineHandle: Long): Int
+    private external fun native_getRenderSampleRate(engineHandle: Long): Int
+    private external fun native_getResamplerLatency(engineHandle: Long): Float
+    private external fun native_getResamplerLoad(engineHandle: Long): Float
     
     private val engineHandle: Long = create()
     
-    fun noteOn(midiNote: Int) {
-        native_noteOn(engineHandle, midiNote)
+    // Shared control ring, layout mirrors ControlRing.h
+    private val controlBuffer: ByteBuffer =
+        native_getControlBuffer(engineHandle).order(ByteOrder.nativeOrder())
+    private val controlCapacity = controlBuffer.getInt(CONTROL_CAPACITY_OFFSET)
+    private var controlWriteIndex = 0
+    private var batchDepth = 0
+    private var commitScheduled = false
+    private var released = false
+
+    // Latest pending value per (note, lane); flushed into the ring on commit,
+    // so a touch that moves many times per frame still costs one event per lane
+    private val pendingExpression = FloatArray(128 * NoteExpression.LANE_COUNT)
+    private val pendingExpressionSlots = IntArray(128 * NoteExpression.LANE_COUNT)
+    private val pendingExpressionQueued = BooleanArray(128 * NoteExpression.LANE_COUNT)
+    private var pendingExpressionCount = 0
+
+    // Events waiting for room in the ring, oldest first (see queueOverflow)
+    private var overflowTypes = IntArray(64)
+    private var overflowIds = IntArray(64)
+    private var overflowValues = FloatArray(64)
+    private var overflowArgs = IntArray(64)
+    private var overflowCount = 0
+    private var overflowNoteEnd = 0   // entries before this are not coalesced into
+
+    private val frameCommit = Choreographer.FrameCallback {
+        synchronized(this) {
+            commitScheduled = false
+            commitControlEvents()
+        }
     }
-    
+
+    /** @param velocity 0..1 */
+    @Synchronized
+    fun noteOn(midiNote: Int, velocity: Float = 1f) {
+        dropPendingExpression(midiNote)
+        queueControlEvent(EVENT_NOTE_ON, midiNote, velocity.coerceIn(0.001f, 1f), immediate = true)
+    }
+
+    @Synchronized
     fun noteOff(midiNote: Int) {
-        native_noteOff(engineHandle, midiNote)
+        dropPendingExpression(midiNote)
+        queueControlEvent(EVENT_NOTE_OFF, midiNote, 0f, immediate = true)
+    }
+
+    /**
+     * Per-note expression for a held note (see NoteExpression for lanes and
+     * ranges). Updates are coalesced per note and lane and reach the engine
+     * with the next frame commit; the engine smooths them at control rate.
+     */
+    @Synchronized
+    fun setNoteExpression(midiNote: Int, lane: Int, value: Float) {
+        if (released || midiNote !in 0..127 || lane !in 0 until NoteExpression.LANE_COUNT) return
+
+        val slot = midiNote * NoteExpression.LANE_COUNT + lane
+        pendingExpression[slot] = value
+        if (!pendingExpressionQueued[slot]) {
+            pendingExpressionQueued[slot] = true
+            pendingExpressionSlots[pendingExpressionCount++] = slot
+        }
+        if (batchDepth == 0) {
+            scheduleFrameCommit()
+        }
+    }
+
+    // Stale updates must not land on the next note with this number
+    private fun dropPendingExpression(midiNote: Int) {
+        var kept = 0
+        for (i in 0 until pendingExpressionCount) {
+            val slot = pendingExpressionSlots[i]
+            if (slot / NoteExpression.LANE_COUNT == midiNote) {
+                pendingExpressionQueued[slot] = false
+            } else {
+                pendingExpressionSlots[kept++] = slot
+            }
+        }
+        pendingExpressionCount = kept
+    }
+
+    private fun flushPendingExpression() {
+        val count = pendingExpressionCount
+        pendingExpressionCount = 0
+        for (i in 0 until count) {
+            val slot = pendingExpressionSlots[i]
+            pendingExpressionQueued[slot] = false
+            queueControlEvent(
+                EVENT_NOTE_EXPRESSION, slot / NoteExpression.LANE_COUNT, pendingExpression[slot],
+                immediate = false, arg = slot % NoteExpression.LANE_COUNT, deferCommit = true
+            )
+        }
+    }
+
+    /** Plays one part only, ignoring its key range. @param velocity 0..1 */
+    @Synchronized
+    fun partNoteOn(part: Int, midiNote: Int, velocity: Float = 1f) {
+        dropPendingExpression(midiNote)
+        queueControlEvent(EVENT_PART_NOTE_ON, midiNote, velocity.coerceIn(0.001f, 1f), immediate = true, arg = part)
+    }
+
+    @Synchronized
+    fun partNoteOff(part: Int, midiNote: Int) {
+        dropPendingExpression(midiNote)
+        queueControlEvent(EVENT_PART_NOTE_OFF, midiNote, 0f, immediate = true, arg = part)
+    }
+
+    /** @param bend -1..1, scaled by the pitch bend range parameter */
+    fun setPitchBend(bend: Float) {
+        queueControlEvent(EVENT_PITCH_BEND, 0, bend, immediate = true)
+    }
+
+    /**
+     * Sets any parameter by its SynthParam ID. Parameter changes are written
+     * into the shared control ring and committed to the engine at most once
+     * per UI frame, so slider sweeps cost one JNI call per frame.
+     */
+    fun setParameter(id: Int, value: Float) {
+        queueControlEvent(EVENT_PARAMETER, id, value, immediate = false)
+        if (sequencerRecording && !released) {
+            native_recordSequencerParameter(engineHandle, id, -1, value)
+        }
+    }
+
+    /**
+     * Sets a per-voice parameter (WAVEFORM .. FILTER_ENV_AMOUNT) of one part.
+     * Part 0 is the patch [setParameter] edits; other IDs are ignored.
+     */
+    fun setPartParameter(part: Int, id: Int, value: Float) {
+        queueControlEvent(EVENT_PART_PARAMETER, id, value, immediate = false, arg = part)
+        if (sequencerRecording && !released) {
+            native_recordSequencerParameter(engineHandle, id, part, value)
+        }
+    }
+
+    /**
+     * Groups notes and parameter changes so they reach the engine together,
+     * with a single commit at the end of the block.
+     */
+    @Synchronized
+    fun batch(block: SynthEngine.() -> Unit) {
+        batchDepth++
+        try {
+            block()
+        } finally {
+            batchDepth--
+            if (batchDepth == 0) {
+                commitControlEvents()
+            }
+        }
+    }
+
+    @Synchronized
+    private fun queueControlEvent(
+        type: Int, id: Int, value: Float, immediate: Boolean,
+        arg: Int = 0, deferCommit: Boolean = false
+    ) {
+        if (released) return
+
+        // Anything already waiting goes first, so nothing overtakes it
+        if (overflowCount > 0 || !writeControlEvent(type, id, value, arg)) {
+            queueOverflow(type, id, value, arg)
+        }
+
+        if (batchDepth > 0 || deferCommit) return
+        if (immediate) {
+            commitControlEvents()
+        } else {
+            scheduleFrameCommit()
+        }
+    }
+
+    // Returns false if the ring is full
+    private fun writeControlEvent(type: Int, id: Int, value: Float, arg: Int): Boolean {
+        val readIndex = controlBuffer.getInt(CONTROL_READ_INDEX_OFFSET)
+        if (controlWriteIndex - readIndex >= controlCapacity) return false
+
+        val position = CONTROL_HEADER_BYTES +
+            (controlWriteIndex and (controlCapacity - 1)) * CONTROL_EVENT_BYTES
+        controlBuffer.putInt(position, type)
+        controlBuffer.putInt(position + 4, id)
+        controlBuffer.putFloat(position + 8, value)
+        controlBuffer.putInt(position + 12, arg)
+        controlWriteIndex++
+        return true
+    }
+
+    /**
+     * Holds an event the full ring has no room for: the audio thread is
+     * behind (a large batch) or not running at all. A continuous value
+     * replaces its own earlier one, unless a note came in between.
+     */
+    private fun queueOverflow(type: Int, id: Int, value: Float, arg: Int) {
+        val continuous = type == EVENT_PARAMETER || type == EVENT_PART_PARAMETER ||
+            type == EVENT_PITCH_BEND || type == EVENT_NOTE_EXPRESSION ||
+            type == EVENT_PART_LEVEL || type == EVENT_PART_SEND
+        if (continuous) {
+            for (i in overflowCount - 1 downTo overflowNoteEnd) {
+                if (overflowTypes[i] == type && overflowIds[i] == id && overflowArgs[i] == arg) {
+                    overflowValues[i] = value
+                    return
+                }
+            }
+        }
+        if (overflowCount == overflowTypes.size) {
+            val size = overflowCount * 2
+            overflowTypes = overflowTypes.copyOf(size)
+            overflowIds = overflowIds.copyOf(size)
+            overflowValues = overflowValues.copyOf(size)
+            overflowArgs = overflowArgs.copyOf(size)
+        }
+        overflowTypes[overflowCount] = type
+        overflowIds[overflowCount] = id
+        overflowValues[overflowCount] = value
+        overflowArgs[overflowCount] = arg
+        overflowCount++
+        if (!continuous) {
+            overflowNoteEnd = overflowCount
+        }
+    }
+
+    // Moves as much of the overflow into the ring as fits, oldest first
+    private fun flushOverflow() {
+        var moved = 0
+        while (moved < overflowCount &&
+            writeControlEvent(overflowTypes[moved], overflowIds[moved], overflowValues[moved], overflowArgs[moved])
+        ) {
+            moved++
+        }
+        if (moved == 0) return
+        val left = overflowCount - moved
+        System.arraycopy(overflowTypes, moved, overflowTypes, 0, left)
+        System.arraycopy(overflowIds, moved, overflowIds, 0, left)
+        System.arraycopy(overflowValues, moved, overflowValues, 0, left)
+        System.arraycopy(overflowArgs, moved, overflowArgs, 0, left)
+        overflowCount = left
+        overflowNoteEnd = maxOf(0, overflowNoteEnd - moved)
+    }
+
+    private fun scheduleFrameCommit() {
+        if (Looper.myLooper() != Looper.getMainLooper()) {
+            commitControlEvents()
+        } else {
+            postFrameCommit()
+        }
+    }
+
+    private fun postFrameCommit() {
+        if (!commitScheduled) {
+            commitScheduled = true
+            Choreographer.getInstance().postFrameCallback(frameCommit)
+        }
+    }
+
+    // Publishing needs a release barrier, which a ByteBuffer write cannot give
+    // us below API 33, so the write index goes through one JNI call.
+    private fun commitControlEvents() {
+        if (!released) {
+            flushOverflow()
+            flushPendingExpression()
+            native_commitControlEvents(engineHandle, controlWriteIndex)
+            // Whatever is left waits for the audio thread to make room; off
+            // the main thread the next event retries
+            if (overflowCount > 0 && Looper.myLooper() == Looper.getMainLooper()) {
+                postFrameCommit()
+            }
+        }
     }
     
     fun setWaveform(waveform: Int) {
-        native_setWaveform(engineHandle, waveform)
+        setParameter(SynthParam.WAVEFORM, waveform.toFloat())
     }
     
     fun setFilterCutoff(cutoff: Float) {
-        native_setFilterCutoff(engineHandle, cutoff)
+        setParameter(SynthParam.FILTER_CUTOFF, cutoff)
     }
     
     fun setFilterResonance(resonance: Float) {
-        native_setFilterResonance(engineHandle, resonance)
+        setParameter(SynthParam.FILTER_RESONANCE, resonance)
     }
     
     fun setAttack(attack: Float) {
-        native_setAttack(engineHandle, attack)
+        setParameter(SynthParam.ATTACK, attack)
     }
     
     fun setDecay(decay: Float) {
-        native_setDecay(engineHandle, decay)
+        setParameter(SynthParam.DECAY, decay)
     }
     
     fun setSustain(sustain: Float) {
-        native_setSustain(engineHandle, sustain)
+        setParameter(SynthParam.SUSTAIN, sustain)
     }
     
     fun setRelease(release: Float) {
-        native_setRelease(engineHandle, release)
+        setParameter(SynthParam.RELEASE, release)
     }
     
     fun setFilterAttack(attack: Float) {
-        native_setFilterAttack(engineHandle, attack)
+        setParameter(SynthParam.FILTER_ATTACK, attack)
     }
     
     fun setFilterDecay(decay: Float) {
-        native_setFilterDecay(engineHandle, decay)
+        setParameter(SynthParam.FILTER_DECAY, decay)
     }
     
     fun setFilterSustain(sustain: Float) {
-        native_setFilterSustain(engineHandle, sustain)
+        setParameter(SynthParam.FILTER_SUSTAIN, sustain)
     }
     
     fun setFilterRelease(release: Float) {
-        native_setFilterRelease(engineHandle, release)
+        setParameter(SynthParam.FILTER_RELEASE, release)
     }
     
     fun setFilterEnvelopeAmount(amount: Float) {
-        native_setFilterEnvelopeAmount(engineHandle, amount)
+        setParameter(SynthParam.FILTER_ENV_AMOUNT, amount)
     }
     
     fun setLFORate(rate: Float) {
-        native_setLFORate(engineHandle, rate)
+        setParameter(SynthParam.LFO_RATE, rate)
     }
     
     fun setLFOAmount(amount: Float) {
-        native_setLFOAmount(engineHandle, amount)
+        setParameter(SynthParam.LFO_AMOUNT, amount)
+    }
+
+    fun setGlideTime(seconds: Float) {
+        setParameter(SynthParam.GLIDE_TIME, seconds)
+    }
+
+    fun setPitchBendRange(semitones: Float) {
+        setParameter(SynthParam.PITCH_BEND_RANGE, semitones)
     }
 
     
     fun setDelayEnabled(enabled: Boolean) {
-        native_setDelayEnabled(engineHandle, enabled)
+        setParameter(SynthParam.DELAY_ENABLED, if (enabled) 1f else 0f)
     }
 
     fun setDelayTime(time: Float) {
-        native_setDelayTime(engineHandle, time)
+        setParameter(SynthParam.DELAY_TIME, time)
     }
 
     fun setDelayFeedback(feedback: Float) {
-        native_setDelayFeedback(engineHandle, feedback)
+        setParameter(SynthParam.DELAY_FEEDBACK, feedback)
     }
 
     fun setDelayMix(mix: Float) {
-        native_setDelayMix(engineHandle, mix)
+        setParameter(SynthParam.DELAY_MIX, mix)
     }
 
     fun setChorusEnabled(enabled: Boolean) {
-        native_setChorusEnabled(engineHandle, enabled)
+        setParameter(SynthParam.CHORUS_ENABLED, if (enabled) 1f else 0f)
     }
 
     fun setChorusRate(rate: Float) {
-        native_setChorusRate(engineHandle, rate)
+        setParameter(SynthParam.CHORUS_RATE, rate)
     }
 
     fun setChorusDepth(depth: Float) {
-        native_setChorusDepth(engineHandle, depth)
+        setParameter(SynthParam.CHORUS_DEPTH, depth)
     }
 
     fun setChorusMix(mix: Float) {
-        native_setChorusMix(engineHandle, mix)
+        setParameter(SynthParam.CHORUS_MIX, mix)
     }
 
     fun setReverbEnabled(enabled: Boolean) {
-        native_setReverbEnabled(engineHandle, enabled)
+        setParameter(SynthParam.REVERB_ENABLED, if (enabled) 1f else 0f)
     }
 
     fun setReverbSize(size: Float) {
-        native_setReverbSize(engineHandle, size)
+        setParameter(SynthParam.REVERB_SIZE, size)
     }
 
     fun setReverbDamping(damping: Float) {
-        native_setReverbDamping(engineHandle, damping)
+        setParameter(SynthParam.REVERB_DAMPING, damping)
     }
 
     fun setReverbMix(mix: Float) {
-        native_setReverbMix(engineHandle, mix)
+        setParameter(SynthParam.REVERB_MIX, mix)
     }
     
     fun setArpeggiatorEnabled(enabled: Boolean) {
-        native_setArpeggiatorEnabled(engineHandle, enabled)
+        setParameter(SynthParam.ARP_ENABLED, if (enabled) 1f else 0f)
     }
 
     fun setArpeggiatorPattern(pattern: Int) {
-        native_setArpeggiatorPattern(engineHandle, pattern)
+        setParameter(SynthParam.ARP_PATTERN, pattern.toFloat())
     }
 
     fun setArpeggiatorRate(bpm: Float) {
-        native_setArpeggiatorRate(engineHandle, bpm)
+        setParameter(SynthParam.ARP_RATE, bpm)
     }
 
     fun setArpeggiatorGate(gate: Float) {
-        native_setArpeggiatorGate(engineHandle, gate)
+        setParameter(SynthParam.ARP_GATE, gate)
     }
 
     fun setArpeggiatorSubdivision(subdivision: Int) {
-        native_setArpeggiatorSubdivision(engineHandle, subdivision)
+        setParameter(SynthParam.ARP_SUBDIVISION, subdivision.toFloat())
+    }
+
+    /**
+     * Configures one of the mod matrix routes. Amount is -1..1; a route with
+     * source or destination NONE (or amount 0) is removed from the render path.
+     */
+    /**
+     * Configure one LFO slot (0-based; slot 0 is the LFO set by setLFORate).
+     * @param syncDivision 0 for free running at [rate] Hz, 1..11 for tempo divisions
+     */
+    fun setLfo(lfo: Int, rate: Float, shape: Int, syncDivision: Int, perVoice: Boolean) {
+        val perVoiceValue = if (perVoice) 1f else 0f
+        batch {
+            if (lfo == 0) {
+                setParameter(SynthParam.LFO_RATE, rate)
+                setParameter(SynthParam.LFO1_SHAPE, shape.toFloat())
+                setParameter(SynthParam.LFO1_SYNC, syncDivision.toFloat())
+                setParameter(SynthParam.LFO1_PER_VOICE, perVoiceValue)
+            } else {
+                val base = SynthParam.LFO_EXTRA_BASE + (lfo - 1) * 4
+                setParameter(base, rate)
+                setParameter(base + 1, shape.toFloat())
+                setParameter(base + 2, syncDivision.toFloat())
+                setParameter(base + 3, perVoiceValue)
+            }
+        }
+    }
+
+    fun setModRoute(route: Int, source: Int, destination: Int, amount: Float) {
+        val base = SynthParam.MOD_ROUTE_BASE + route * 3
+        batch {
+            setParameter(base, source.toFloat())
+            setParameter(base + 1, destination.toFloat())
+            setParameter(base + 2, amount)
+        }
     }
 
     fun setSequencerEnabled(enabled: Boolean) {
@@ -206,8 +538,417 @@ class SynthEngine {
     fun setSequencerStep(index: Int, midiNote: Int, active: Boolean) {
         native_setSequencerStep(engineHandle, index, midiNote, active)
     }
+
+    /*
+     * Multi-track sequencer: 16 patterns of up to 128 steps, 4 tracks, up to
+     * 4 notes per step. Each edit is published to the audio thread whole at
+     * its next callback. The single-track setters above edit track 0 of the
+     * selected pattern.
+     */
+
+    fun setSequencerPatternLength(pattern: Int, steps: Int, stepLength: Int) {
+        native_setSequencerPatternLength(engineHandle, pattern, steps, stepLength)
+    }
+
+    /** An empty [notes] makes the step a rest. velocity and gate are 0..1. */
+    fun setSequencerChordStep(pattern: Int, track: Int, step: Int, notes: IntArray, velocity: Float = 1f, gate: Float = 0.9f) {
+        native_setSequencerChordStep(engineHandle, pattern, track, step, notes, velocity, gate)
+    }
+
+    fun clearSequencerPattern(pattern: Int) {
+        native_clearSequencerPattern(engineHandle, pattern)
+    }
+
+    fun copySequencerPattern(from: Int, to: Int) {
+        native_copySequencerPattern(engineHandle, from, to)
+    }
+
+    /** part -1 plays the track through every part whose key range holds the note. */
+    fun setSequencerTrack(track: Int, part: Int, muted: Boolean) {
+        native_setSequencerTrack(engineHandle, track, part, muted)
+    }
+
+    /** Takes over when the playing pattern ends. */
+    fun selectSequencerPattern(pattern: Int) {
+        native_selectSequencerPattern(engineHandle, pattern)
+    }
+
+    /** Slot i plays patterns[i] repeats[i] times; the song loops. */
+    fun setSequencerSong(patterns: IntArray, repeats: IntArray) {
+        native_setSequencerSong(engineHandle, patterns, repeats)
+    }
+
+    fun setSequencerSongMode(enabled: Boolean) {
+        native_setSequencerSongMode(engineHandle, enabled)
+    }
+
+    /*
+     * Automation: up to 8 parameter lanes per pattern. A value on a step
+     * locks the parameter for that step; the engine applies it on the
+     * step's first sample, so timing does not depend on this thread.
+     * part -1 is the patch setParameter() edits.
+     */
+
+    /** param -1 frees the lane. Returns false if another lane of the pattern has the parameter. */
+    fun setSequencerLane(pattern: Int, lane: Int, param: Int, part: Int = -1, glide: Boolean = false): Boolean =
+        native_setSequencerLane(engineHandle, pattern, lane, param, part, glide)
+
+    /** Returns false if the pattern has no lane for the parameter and none free. */
+    fun setSequencerParameterLock(pattern: Int, step: Int, id: Int, value: Float, part: Int = -1): Boolean =
+        native_setSequencerParameterLock(engineHandle, pattern, step, id, part, value)
+
+    fun clearSequencerParameterLock(pattern: Int, step: Int, id: Int, part: Int = -1) {
+        native_clearSequencerParameterLock(engineHandle, pattern, step, id, part)
+    }
+
+    /**
+     * While set and the sequencer is playing, [setParameter] and
+     * [setPartParameter] also lock the value on the step playing now.
+     */
+    @Volatile
+    var sequencerRecording = false
+    
+    /**
+     * Memory-maps a binary preset bank (.nspb). Returns false if the file
+     * is missing or not a valid bank.
+     */
+    fun loadPresetBank(path: String): Boolean {
+        return native_loadPresetBank(engineHandle, path)
+    }
+
+    fun getPresetCount(): Int {
+        return native_getPresetCount(engineHandle)
+    }
+
+    fun getPresetName(index: Int): String {
+        return native_getPresetName(engineHandle, index)
+    }
+
+    /** Maps an alphabetical browse position to a preset index */
+    fun getSortedPresetIndex(position: Int): Int {
+        return native_getSortedPresetIndex(engineHandle, position)
+    }
+
+    /** Returns the preset index, or -1 if no preset has this name */
+    fun findPreset(name: String): Int {
+        return native_findPreset(engineHandle, name)
+    }
+
+    fun findPresetsByTag(tag: String): IntArray {
+        return native_findPresetsByTag(engineHandle, tag)
+    }
+
+    /** Sends every parameter of a bank preset through the control ring */
+    @Synchronized
+    fun applyPreset(index: Int): Boolean {
+        val values = native_getPresetValues(engineHandle, index) ?: return false
+        batch {
+            for (id in values.indices) {
+                queueControlEvent(EVENT_PARAMETER, id, values[id], immediate = false)
+            }
+        }
+        return true
+    }
+
+    /**
+     * Multi-timbral parts 0-7 (kMaxParts). They share the voice pool and
+     * the effects; part 0 is always on and is the patch the plain setters
+     * edit. Notes go to every enabled part whose key range holds them.
+     * Part changes go through the control ring like notes, so the engine
+     * only ever sees them between audio blocks.
+     */
+    fun setPartEnabled(part: Int, enabled: Boolean) {
+        queueControlEvent(EVENT_PART_ENABLED, 0, if (enabled) 1f else 0f, immediate = true, arg = part)
+    }
+
+    fun setPartKeyRange(part: Int, lowNote: Int, highNote: Int) {
+        queueControlEvent(EVENT_PART_KEY_RANGE, lowNote, highNote.toFloat(), immediate = true, arg = part)
+    }
+
+    /** MIDI file channel 0-15 the part plays, -1 for all */
+    fun setPartMidiChannel(part: Int, channel: Int) {
+        queueControlEvent(EVENT_PART_MIDI_CHANNEL, channel, 0f, immediate = true, arg = part)
+    }
+
+    /** 0..2, 1 = unity */
+    fun setPartLevel(part: Int, level: Float) {
+        queueControlEvent(EVENT_PART_LEVEL, 0, level, immediate = false, arg = part)
+    }
+
+    /** @param send one of the [PartSend] constants, @param level 0..1 */
+    fun setPartSend(part: Int, send: Int, level: Float) {
+        queueControlEvent(EVENT_PART_SEND, send, level, immediate = false, arg = part)
+    }
+
+    /** Sends the per-voice parameters of a bank preset to one part */
+    @Synchronized
+    fun applyPartPreset(part: Int, index: Int): Boolean {
+        val values = native_getPresetValues(engineHandle, index) ?: return false
+        batch {
+            for (id in SynthParam.WAVEFORM..SynthParam.FILTER_ENV_AMOUNT) {
+                queueControlEvent(EVENT_PART_PARAMETER, id, values[id], immediate = false, arg = part)
+            }
+        }
+        return true
+    }
     
+    /**
+     * Loads a Standard MIDI File (format 0 or 1) for playback. Call from a
+     * background thread for large files; returns false on parse errors.
+     */
+    fun loadMidiFile(path: String): Boolean {
+        return native_loadMidiFile(engineHandle, path)
+    }
+
+    fun startMidiPlayback(loop: Boolean = false) {
+        native_startMidiPlayback(engineHandle, loop)
+    }
+
+    fun stopMidiPlayback() {
+        native_stopMidiPlayback(engineHandle)
+    }
+
+    fun isMidiPlaying(): Boolean {
+        return native_isMidiPlaying(engineHandle)
+    }
+
+    /**
+     * Load a Scala scale (.scl) and optional keyboard mapping (.kbm). The
+     * tuning table is rebuilt on the calling thread; call off the UI thread.
+     * Returns false if a file fails to parse or the previous tuning change
+     * has not reached the audio thread yet.
+     */
+    fun loadScalaTuning(sclPath: String, kbmPath: String? = null): Boolean {
+        return native_loadScalaTuning(engineHandle, sclPath, kbmPath)
+    }
+
+    /** Frequency of the mapping's reference key (A4 unless a .kbm says otherwise) */
+    fun setTuningReference(referenceHz: Float): Boolean {
+        return native_setTuningReference(engineHandle, referenceHz)
+    }
+
+    /** Back to 12-tone equal temperament, keeping the reference pitch */
+    fun resetTuning(): Boolean {
+        return native_resetTuning(engineHandle)
+    }
+
+    /**
+     * Allow render-ahead playback: after a couple of seconds of sequencer,
+     * arpeggiator or MIDI file playback without UI input, audio is rendered
+     * about 300 ms ahead on a background thread so CPU hiccups cannot glitch
+     * it. Any note or parameter change switches straight back to low latency.
+     */
+    fun setRenderAheadEnabled(enabled: Boolean) {
+        native_setRenderAheadEnabled(engineHandle, enabled)
+    }
+
+    fun isRenderingAhead(): Boolean {
+        return native_isRenderingAhead(engineHandle)
+    }
+
+    /**
+     * Loop freeze: once the sequencer has played a whole loop with nothing
+     * changing, the next loop's voice mix is cached and replayed instead of
+     * synthesized, with effects still live. Any patch, step or tempo change
+     * brings the voices back at the next step. The first enable allocates
+     * an 8 MB cache.
+     */
+    fun setLoopFreezeEnabled(enabled: Boolean) {
+        native_setLoopFreezeEnabled(engineHandle, enabled)
+    }
+
+    /** One of the [LoopFreezeState] constants */
+    fun getLoopFreezeState(): Int {
+        return native_getLoopFreezeState(engineHandle)
+    }
+
+    /**
+     * Scope and meter frames: three frames of [VisualTap.SCOPE_FRAME_BYTES]
+     * back to back, laid out as in [VisualTap]. Null until the taps were
+     * first enabled.
+     */
+    var scopeBuffer: ByteBuffer? = null
+        private set
+
+    /** Spectrum frames of [VisualTap.SPECTRUM_FRAME_BYTES], like [scopeBuffer] */
+    var spectrumBuffer: ByteBuffer? = null
+        private set
+
+    /**
+     * Visualization taps: the engine publishes scope, meter and spectrum
+     * frames into [scopeBuffer] and [spectrumBuffer], and the UI picks up
+     * the newest with [acquireScopeFrame] / [acquireSpectrumFrame] whenever
+     * it draws. Off costs nothing; on adds a copy per block and an analysis
+     * thread.
+     */
+    fun setVisualTapsEnabled(enabled: Boolean) {
+        native_setVisualTapsEnabled(engineHandle, enabled)
+        if (enabled && scopeBuffer == null) {
+            scopeBuffer = native_getScopeBuffer(engineHandle)?.order(ByteOrder.nativeOrder())
+            spectrumBuffer = native_getSpectrumBuffer(engineHandle)?.order(ByteOrder.nativeOrder())
+        }
+    }
+
+    /**
+     * Byte offset in [scopeBuffer] of the newest scope frame, or -1 before
+     * the taps were enabled. The frame stays as it is until the next call,
+     * so call this from one thread only, once per drawn frame.
+     */
+    fun acquireScopeFrame(): Int {
+        val index = native_acquireScopeFrame(engineHandle)
+        return if (index < 0) -1 else index * VisualTap.SCOPE_FRAME_BYTES
+    }
+
+    /** Byte offset in [spectrumBuffer] of the newest spectrum frame, like [acquireScopeFrame] */
+    fun acquireSpectrumFrame(): Int {
+        val index = native_acquireSpectrumFrame(engineHandle)
+        return if (index < 0) -1 else index * VisualTap.SPECTRUM_FRAME_BYTES
+    }
+
+    /**
+     * Record what the device plays to a mono WAV file at the device rate.
+     * The audio thread only copies into a ring; a background thread does
+     * the file writes. [format] is one of the [RecordFormat] constants.
+     * Opens the file, so keep it off the UI thread where that matters.
+     */
+    fun startRecording(path: String, format: Int = RecordFormat.FLOAT32): Boolean {
+        return native_startRecording(engineHandle, path, format)
+    }
+
+    /** Writes out what is still queued and closes the file; false if any write failed */
+    fun stopRecording(): Boolean {
+        return native_stopRecording(engineHandle)
+    }
+
+    fun isRecording(): Boolean {
+        return native_isRecording(engineHandle)
+    }
+
+    /** Frames in the file so far */
+    fun getRecordedFrames(): Long {
+        return native_getRecordedFrames(engineHandle)
+    }
+
+    /** Callback blocks lost because the writer fell a whole ring (about 21 s) behind */
+    fun getRecordingDroppedBlocks(): Int {
+        return native_getRecordingDroppedBlocks(engineHandle)
+    }
+
+    /** Audio waiting to be written at the writer's last pass, and the most so far */
+    fun getRecordingLatencyMs(): Float {
+        return native_getRecordingLatencyMs(engineHandle)
+    }
+
+    fun getRecordingMaxLatencyMs(): Float {
+        return native_getRecordingMaxLatencyMs(engineHandle)
+    }
+
+    /** The file stopped taking data, e.g. the disk is full; recording carries on discarding */
+    fun hasRecordingFailed(): Boolean {
+        return native_hasRecordingFailed(engineHandle)
+    }
+
+    /**
+     * Render tracing: with the native library built with NOISYSYNTH_TRACE
+     * (pass -DNOISYSYNTH_TRACE=ON in the cmake arguments), the engine keeps
+     * the last few seconds of per-stage render timings. Call this right
+     * after a glitch and open the file in ui.perfetto.dev or
+     * chrome://tracing. False when tracing is compiled out or the file
+     * cannot be written.
+     */
+    fun writeRenderTrace(path: String): Boolean {
+        return native_writeRenderTrace(path)
+    }
+
+    /** Start the next trace from here */
+    fun clearRenderTrace() {
+        native_clearRenderTrace()
+    }
+
+    fun isRenderTraceAvailable(): Boolean {
+        return native_isRenderTraceAvailable()
+    }
+
+    /**
+     * Let the engine trade polyphony, reverb density and filter accuracy for
+     * CPU when callbacks run close to their deadline. On by default.
+     */
+    fun setQualityGovernorEnabled(enabled: Boolean) {
+        native_setQualityGovernorEnabled(engineHandle, enabled)
+    }
+
+    /** One of the [QualityTier] constants */
+    fun getQualityTier(): Int {
+        return native_getQualityTier(engineHandle)
+    }
+
+    /** Smoothed render time as a fraction of the callback period */
+    fun getRenderLoad(): Float {
+        return native_getRenderLoad(engineHandle)
+    }
+
+    /** Recent worst-case render time as a fraction of the callback period */
+    fun getPeakRenderLoad(): Float {
+        return native_getPeakRenderLoad(engineHandle)
+    }
+
+    /**
+     * One of the [RenderRateMode] constants. Switching briefly stops the
+     * stream while the engine re-prepares.
+     */
+    fun setRenderRateMode(mode: Int) {
+        native_setRenderRateMode(engineHandle, mode)
+    }
+
+    /** Rate the output device runs at */
+    fun getDeviceSampleRate(): Int {
+        return native_getDeviceSampleRate(engineHandle)
+    }
+
+    /** Rate the engine renders at; differs from the device rate while resampling */
+    fun getRenderSampleRate(): Int {
+        return native_getRenderSampleRate(engineHandle)
+    }
+
+    /** Added latency of the resampler in seconds, 0 when not resampling */
+    fun getResamplerLatency(): Float {
+        return native_getResamplerLatency(engineHandle)
+    }
+
+    /** Resampler time as a fraction of the callback period */
+    fun getResamplerLoad(): Float {
+        return native_getResamplerLoad(engineHandle)
+    }
+
     fun delete() {
+        synchronized(this) {
+            released = true
+            if (commitScheduled) {
+                Choreographer.getInstance().removeFrameCallback(frameCommit)
+                commitScheduled = false
+            }
+        }
         destroy(engineHandle)
     }
+
+    private companion object {
+        const val CONTROL_READ_INDEX_OFFSET = 64
+        const val CONTROL_CAPACITY_OFFSET = 128
+        const val CONTROL_HEADER_BYTES = 192
+        const val CONTROL_EVENT_BYTES = 16
+
+        const val EVENT_PARAMETER = 1
+        const val EVENT_NOTE_ON = 2
+        const val EVENT_NOTE_OFF = 3
+        const val EVENT_PITCH_BEND = 4
+        const val EVENT_NOTE_EXPRESSION = 5
+        const val EVENT_PART_NOTE_ON = 6
+        const val EVENT_PART_NOTE_OFF = 7
+        const val EVENT_PART_PARAMETER = 8
+        const val EVENT_PART_ENABLED = 9
+        const val EVENT_PART_KEY_RANGE = 10
+        const val EVENT_PART_MIDI_CHANNEL = 11
+        const val EVENT_PART_LEVEL = 12
+        const val EVENT_PART_SEND = 13
+    }
 }
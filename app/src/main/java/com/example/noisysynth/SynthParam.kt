@@ -0,0 +1,188 @@
+package com.example.noisysynth
+
+/**
+ * Parameter IDs understood by the native engine.
+ * Must match enum class ParamId in SynthParams.h.
+ */
+object SynthParam {
+    const val WAVEFORM = 0
+    const val FILTER_CUTOFF = 1
+    const val FILTER_RESONANCE = 2
+    const val ATTACK = 3
+    const val DECAY = 4
+    const val SUSTAIN = 5
+    const val RELEASE = 6
+    const val FILTER_ATTACK = 7
+    const val FILTER_DECAY = 8
+    const val FILTER_SUSTAIN = 9
+    const val FILTER_RELEASE = 10
+    const val FILTER_ENV_AMOUNT = 11
+    const val LFO_RATE = 12
+    const val LFO_AMOUNT = 13
+    const val DELAY_ENABLED = 14
+    const val DELAY_TIME = 15
+    const val DELAY_FEEDBACK = 16
+    const val DELAY_MIX = 17
+    const val CHORUS_ENABLED = 18
+    const val CHORUS_RATE = 19
+    const val CHORUS_DEPTH = 20
+    const val CHORUS_MIX = 21
+    const val REVERB_ENABLED = 22
+    const val REVERB_SIZE = 23
+    const val REVERB_DAMPING = 24
+    const val REVERB_MIX = 25
+    const val ARP_ENABLED = 26
+    const val ARP_PATTERN = 27
+    const val ARP_RATE = 28
+    const val ARP_GATE = 29
+    const val ARP_SUBDIVISION = 30
+
+    /** Mod route n (0-based) uses IDs MOD_ROUTE_BASE + n * 3 + {0: source, 1: destination, 2: amount} */
+    const val MOD_ROUTE_BASE = 31
+    const val MOD_ROUTE_COUNT = 8
+
+    const val LFO1_SHAPE = 55
+    const val LFO1_SYNC = 56
+    const val LFO1_PER_VOICE = 57
+
+    /** LFO n (1..3 for LFOs 2-4) uses IDs LFO_EXTRA_BASE + (n - 1) * 4 + {0: rate, 1: shape, 2: sync, 3: per voice} */
+    const val LFO_EXTRA_BASE = 58
+
+    const val GLIDE_TIME = 70
+    const val PITCH_BEND_RANGE = 71
+}
+
+/** Must match enum class Waveform in SynthEngine.h */
+object Waveform {
+    const val SINE = 0
+    const val SAWTOOTH = 1
+    const val SQUARE = 2
+    const val TRIANGLE = 3
+    const val NOISE = 4
+    const val PINK_NOISE = 5
+}
+
+/** Must match enum class LfoShape in SynthEngine.h */
+object LfoShape {
+    const val SINE = 0
+    const val TRIANGLE = 1
+    const val SAW = 2
+    const val SQUARE = 3
+    const val SAMPLE_AND_HOLD = 4
+}
+
+/** Must match enum class ModSource in ModMatrix.h */
+object ModSource {
+    const val NONE = 0
+    const val LFO = 1
+    const val AMP_ENVELOPE = 2
+    const val FILTER_ENVELOPE = 3
+    const val VELOCITY = 4
+    const val KEY_TRACK = 5
+    const val LFO2 = 6
+    const val LFO3 = 7
+    const val LFO4 = 8
+    const val PRESSURE = 9
+    const val TIMBRE = 10
+}
+
+/** Per-note expression lanes, must match enum class NoteExpression in SynthEngine.h */
+object NoteExpression {
+    /** Semitones relative to the note, -48..48 */
+    const val PITCH_BEND = 0
+    /** 0..1 */
+    const val PRESSURE = 1
+    /** 0..1, 0.5 at note on */
+    const val TIMBRE = 2
+
+    const val LANE_COUNT = 3
+}
+
+/** Must match enum class ModDestination in ModMatrix.h */
+object ModDestination {
+    const val NONE = 0
+    const val PITCH = 1
+    const val CUTOFF = 2
+    const val RESONANCE = 3
+    const val AMPLITUDE = 4
+    const val DELAY_MIX = 5
+    const val CHORUS_DEPTH = 6
+    const val REVERB_MIX = 7
+}
+
+/** Must match enum class QualityTier in QualityGovernor.h */
+object QualityTier {
+    const val FULL = 0
+    /** Cheaper reverb, filter coefficients every 4 samples */
+    const val REDUCED = 1
+    /** 6 voices, filter coefficients every 16 samples */
+    const val LOW = 2
+    /** 4 voices, filter coefficients every 32 samples */
+    const val MINIMAL = 3
+}
+
+/** Must match enum class LoopFreezeState in LoopFreeze.h */
+object LoopFreezeState {
+    const val OFF = 0
+    /** For one whole sequencer loop with nothing changing */
+    const val WAITING = 1
+    /** Recording this loop's voice mix */
+    const val CAPTURING = 2
+    /** Replaying it instead of running the voices */
+    const val PLAYING = 3
+}
+
+/**
+ * Taps and frame layouts of the visualization buffers.
+ * Must match enum class VisualTap and ScopeFrame / SpectrumFrame in VisualTaps.h
+ */
+object VisualTap {
+    /** The dry voice mix, before any effect */
+    const val VOICES = 0
+    /** After chorus, delay and reverb, before the master gain and limiter */
+    const val EFFECTS = 1
+    /** What goes to the device */
+    const val OUTPUT = 2
+    const val COUNT = 3
+
+    const val SCOPE_FRAMES = 512
+    const val SCOPE_FRAME_BYTES = 6184
+    const val SCOPE_SEQUENCE_OFFSET = 0
+    const val SCOPE_SAMPLE_RATE_OFFSET = 8
+    /** One float per tap */
+    const val SCOPE_PEAK_OFFSET = 16
+    const val SCOPE_RMS_OFFSET = 28
+    /** SCOPE_FRAMES floats per tap, tap after tap */
+    const val SCOPE_SAMPLES_OFFSET = 40
+
+    const val SPECTRUM_BINS = 1024
+    const val SPECTRUM_FRAME_BYTES = 4112
+    const val SPECTRUM_SEQUENCE_OFFSET = 0
+    const val SPECTRUM_BIN_HZ_OFFSET = 12
+    /** SPECTRUM_BINS floats of the output tap, 0 dB being a full-scale sine */
+    const val SPECTRUM_MAGNITUDE_OFFSET = 16
+    const val SPECTRUM_FLOOR_DB = -120f
+}
+
+/** Must match enum class WavSampleFormat in WavWriter.h */
+object RecordFormat {
+    /** 32-bit float, exactly what the engine renders */
+    const val FLOAT32 = 0
+    /** Half the size; clipped and rounded to 16 bits */
+    const val PCM16 = 1
+}
+
+/** Must match enum class RenderRateMode in SynthEngine.h */
+object RenderRateMode {
+    /** Render at the device's rate */
+    const val NATIVE = 0
+    /** Render at 48 kHz and resample to the device's rate */
+    const val INTERNAL = 1
+}
+
+/** Must match enum class PartSend in SynthEngine.h */
+object PartSend {
+    const val CHORUS = 0
+    const val DELAY = 1
+    const val REVERB = 2
+}
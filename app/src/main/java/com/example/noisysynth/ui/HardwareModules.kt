@@ -1,11 +1,18 @@
 package com.example.noisysynth
 
+import androidx.compose.foundation.Canvas
 import androidx.compose.foundation.layout.*
 import androidx.compose.runtime.*
 import androidx.compose.ui.Alignment
 import androidx.compose.ui.Modifier
+import androidx.compose.ui.geometry.Offset
+import androidx.compose.ui.geometry.Size
 import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.graphics.Path
+import androidx.compose.ui.graphics.drawscope.Stroke
 import androidx.compose.ui.unit.dp
+import kotlin.math.log10
+import kotlin.math.max
 
 /**
  * Example: Oscillator module with hardware-style controls
@@ -22,39 +29,27 @@ fun HardwareOscillatorModule(
         accentColor = accentColor,
         modifier = modifier
     ) {
-        // Waveform buttons in 2x2 grid
-        val waveforms = listOf("SINE", "SAW", "SQUARE", "TRI")
+        // Waveform buttons in a 2-column grid
+        val waveforms = listOf("SINE", "SAW", "SQUARE", "TRI", "NOISE", "PINK")
         
-        Row(
-            modifier = Modifier.fillMaxWidth(),
-            horizontalArrangement = Arrangement.spacedBy(6.dp)
-        ) {
-            waveforms.take(2).forEachIndexed { index, name ->
-                HardwareButton(
-                    text = name,
-                    selected = waveform == index,
-                    onClick = { onWaveformChange(index) },
-                    accentColor = accentColor,
-                    modifier = Modifier.weight(1f)
-                )
+        waveforms.chunked(2).forEachIndexed { row, pair ->
+            if (row > 0) {
+                Spacer(modifier = Modifier.height(6.dp))
             }
-        }
-        
-        Spacer(modifier = Modifier.height(6.dp))
-        
-        Row(
-            modifier = Modifier.fillMaxWidth(),
-            horizontalArrangement = Arrangement.spacedBy(6.dp)
-        ) {
-            waveforms.drop(2).forEachIndexed { relativeIndex, name ->
-                val index = relativeIndex + 2
-                HardwareButton(
-                    text = name,
-                    selected = waveform == index,
-                    onClick = { onWaveformChange(index) },
-                    accentColor = accentColor,
-                    modifier = Modifier.weight(1f)
-                )
+            Row(
+                modifier = Modifier.fillMaxWidth(),
+                horizontalArrangement = Arrangement.spacedBy(6.dp)
+            ) {
+                pair.forEachIndexed { column, name ->
+                    val index = row * 2 + column
+                    HardwareButton(
+                        text = name,
+                        selected = waveform == index,
+                        onClick = { onWaveformChange(index) },
+                        accentColor = accentColor,
+                        modifier = Modifier.weight(1f)
+                    )
+                }
             }
         }
     }
@@ -396,3 +391,109 @@ fun HardwareEffectsModule(
         }
     }
 }
+
+/**
+ * Oscilloscope, level meters and spectrum from the engine's visualization
+ * taps. Enables the taps while shown; each display frame takes the newest
+ * published frames and draws straight from the shared buffers.
+ */
+@Composable
+fun HardwareScopeModule(
+    synthEngine: SynthEngine,
+    accentColor: Color = Color(0xFF00E5FF),
+    modifier: Modifier = Modifier
+) {
+    DisposableEffect(synthEngine) {
+        synthEngine.setVisualTapsEnabled(true)
+        onDispose { synthEngine.setVisualTapsEnabled(false) }
+    }
+
+    // Byte offsets of the frames being drawn; a new value per display frame redraws
+    var scopeOffset by remember { mutableStateOf(-1) }
+    var spectrumOffset by remember { mutableStateOf(-1) }
+    var frameTime by remember { mutableStateOf(0L) }
+    LaunchedEffect(synthEngine) {
+        while (true) {
+            withFrameNanos { time ->
+                scopeOffset = synthEngine.acquireScopeFrame()
+                spectrumOffset = synthEngine.acquireSpectrumFrame()
+                frameTime = time
+            }
+        }
+    }
+
+    HardwareModulePanel(
+        title = "SCOPE",
+        accentColor = accentColor,
+        modifier = modifier
+    ) {
+        Row(
+            modifier = Modifier.fillMaxWidth().height(72.dp),
+            horizontalArrangement = Arrangement.spacedBy(8.dp)
+        ) {
+            // Output waveform
+            Canvas(modifier = Modifier.weight(2f).fillMaxHeight()) {
+                val buffer = synthEngine.scopeBuffer ?: return@Canvas
+                // Reading frameTime redraws on every display frame
+                if (scopeOffset < 0 || frameTime == 0L) return@Canvas
+                val base = scopeOffset + VisualTap.SCOPE_SAMPLES_OFFSET +
+                    VisualTap.OUTPUT * VisualTap.SCOPE_FRAMES * 4
+                val path = Path()
+                val step = size.width / (VisualTap.SCOPE_FRAMES - 1)
+                val mid = size.height / 2f
+                for (i in 0 until VisualTap.SCOPE_FRAMES) {
+                    val y = mid - buffer.getFloat(base + i * 4) * mid
+                    if (i == 0) path.moveTo(0f, y) else path.lineTo(i * step, y)
+                }
+                drawLine(Color(0xFF3A3A3A), Offset(0f, mid), Offset(size.width, mid))
+                drawPath(path, accentColor, style = Stroke(width = 1.5.dp.toPx()))
+            }
+
+            // Peak (line) and RMS (bar) of each tap, -60..0 dB
+            Canvas(modifier = Modifier.weight(1f).fillMaxHeight()) {
+                val buffer = synthEngine.scopeBuffer ?: return@Canvas
+                if (scopeOffset < 0 || frameTime == 0L) return@Canvas
+                val barHeight = size.height / VisualTap.COUNT
+                for (tap in 0 until VisualTap.COUNT) {
+                    val peak = buffer.getFloat(scopeOffset + VisualTap.SCOPE_PEAK_OFFSET + tap * 4)
+                    val rms = buffer.getFloat(scopeOffset + VisualTap.SCOPE_RMS_OFFSET + tap * 4)
+                    val top = tap * barHeight + 2.dp.toPx()
+                    val height = barHeight - 4.dp.toPx()
+                    drawRect(Color(0xFF2A2A2A), Offset(0f, top), Size(size.width, height))
+                    drawRect(
+                        if (peak >= 1f) Color(0xFFFF1744) else accentColor,
+                        Offset(0f, top),
+                        Size(size.width * meterPosition(rms), height)
+                    )
+                    val peakX = size.width * meterPosition(peak)
+                    drawLine(Color.White, Offset(peakX, top), Offset(peakX, top + height), 2.dp.toPx())
+                }
+            }
+        }
+
+        Spacer(modifier = Modifier.height(8.dp))
+
+        // Output spectrum on a log frequency axis, 20 Hz to Nyquist, -90..0 dB
+        Canvas(modifier = Modifier.fillMaxWidth().height(64.dp)) {
+            val buffer = synthEngine.spectrumBuffer ?: return@Canvas
+            if (spectrumOffset < 0 || frameTime == 0L) return@Canvas
+            val binHz = buffer.getFloat(spectrumOffset + VisualTap.SPECTRUM_BIN_HZ_OFFSET)
+            if (binHz <= 0f) return@Canvas
+            val minLog = log10(20f)
+            val maxLog = log10(binHz * VisualTap.SPECTRUM_BINS)
+            val path = Path()
+            for (bin in 1 until VisualTap.SPECTRUM_BINS) {
+                val db = buffer.getFloat(spectrumOffset + VisualTap.SPECTRUM_MAGNITUDE_OFFSET + bin * 4)
+                val x = (log10(max(bin * binHz, 20f)) - minLog) / (maxLog - minLog) * size.width
+                val y = size.height * (db / -90f).coerceIn(0f, 1f)
+                if (bin == 1) path.moveTo(x, y) else path.lineTo(x, y)
+            }
+            drawPath(path, accentColor, style = Stroke(width = 1.dp.toPx()))
+        }
+    }
+}
+
+private fun meterPosition(level: Float): Float {
+    if (level <= 0f) return 0f
+    return ((20f * log10(level) + 60f) / 60f).coerceIn(0f, 1f)
+}
@@ -130,6 +130,8 @@ fun HardwareSynthDemo(synthEngine: SynthEngine) {
                 .padding(8.dp),
             verticalArrangement = Arrangement.spacedBy(8.dp)
         ) {
+            HardwareScopeModule(synthEngine = synthEngine)
+
             // Row 1: OSC + Filter + LFO
             Row(
                 modifier = Modifier.fillMaxWidth(),
@@ -312,8 +314,9 @@ fun HardwareSynthDemo(synthEngine: SynthEngine) {
                 contentAlignment = Alignment.Center
             ) {
                 SimplePianoKeyboard(
-                    onNoteOn = { note -> synthEngine.noteOn(note) },
+                    onNoteOn = { note, velocity -> synthEngine.noteOn(note, velocity) },
                     onNoteOff = { note -> synthEngine.noteOff(note) },
+                    onNoteExpression = { note, lane, value -> synthEngine.setNoteExpression(note, lane, value) },
                     height = 90
                 )
             }
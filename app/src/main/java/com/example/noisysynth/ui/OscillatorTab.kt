@@ -45,7 +45,9 @@ fun OscillatorTab(
                 "Sine Wave" to 0,
                 "Sawtooth" to 1,
                 "Square Wave" to 2,
-                "Triangle" to 3
+                "Triangle" to 3,
+                "White Noise" to 4,
+                "Pink Noise" to 5
             ).forEach { (name, index) ->
                 Button(
                     onClick = { onWaveformChange(index) },
@@ -2,7 +2,8 @@ package com.example.noisysynth
 
 import androidx.compose.foundation.background
 import androidx.compose.foundation.border
-import androidx.compose.foundation.gestures.detectTapGestures
+import androidx.compose.foundation.gestures.awaitEachGesture
+import androidx.compose.foundation.gestures.awaitFirstDown
 import androidx.compose.foundation.layout.*
 import androidx.compose.foundation.shape.RoundedCornerShape
 import androidx.compose.material3.*
@@ -12,6 +13,7 @@ import androidx.compose.ui.Modifier
 import androidx.compose.ui.draw.shadow
 import androidx.compose.ui.graphics.Brush
 import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.input.pointer.PointerInputScope
 import androidx.compose.ui.input.pointer.pointerInput
 import androidx.compose.ui.unit.dp
 import androidx.compose.ui.unit.sp
@@ -24,10 +26,18 @@ data class PianoKey(
     val label: String = ""
 )
 
+/**
+ * Two-octave touch keyboard. Each touch is one note with its own expression:
+ * - velocity from where the key is struck (further down = louder)
+ * - NoteExpression.PITCH_BEND from sliding sideways (one key width = 1 semitone)
+ * - NoteExpression.TIMBRE from the vertical position while held
+ * - NoteExpression.PRESSURE from the touch pressure, where the screen reports it
+ */
 @Composable
 fun SimplePianoKeyboard(
-    onNoteOn: (Int) -> Unit,
+    onNoteOn: (Int, Float) -> Unit,
     onNoteOff: (Int) -> Unit,
+    onNoteExpression: ((Int, Int, Float) -> Unit)? = null,
     height: Int = 100 // Default height in dp, can be customized
 ) {
     // Define 2 octaves from C3 (48) to C5 (72) for better screen coverage
@@ -101,6 +111,7 @@ fun SimplePianoKeyboard(
                     key = key,
                     onNoteOn = onNoteOn,
                     onNoteOff = onNoteOff,
+                    onNoteExpression = onNoteExpression,
                     modifier = Modifier.weight(1f)
                 )
             }
@@ -117,6 +128,7 @@ fun SimplePianoKeyboard(
                     key = key,
                     onNoteOn = onNoteOn,
                     onNoteOff = onNoteOff,
+                    onNoteExpression = onNoteExpression,
                     modifier = Modifier
                         .offset(x = whiteKeyWidth * key.position)
                         .zIndex(1f)
@@ -129,8 +141,9 @@ fun SimplePianoKeyboard(
 @Composable
 fun WhiteKey(
     key: PianoKey,
-    onNoteOn: (Int) -> Unit,
+    onNoteOn: (Int, Float) -> Unit,
     onNoteOff: (Int) -> Unit,
+    onNoteExpression: ((Int, Int, Float) -> Unit)?,
     modifier: Modifier = Modifier
 ) {
     var isPressed by remember { mutableStateOf(false) }
@@ -175,18 +188,12 @@ fun WhiteKey(
                 )
             )
             .pointerInput(key.midiNote) {
-                detectTapGestures(
-                    onPress = { offset ->
-                        try {
-                            isPressed = true
-                            onNoteOn(key.midiNote)
-                            tryAwaitRelease()
-                        } finally {
-                            // ALWAYS call noteOff, even if interrupted
-                            isPressed = false
-                            onNoteOff(key.midiNote)
-                        }
-                    }
+                trackKeyPress(
+                    midiNote = key.midiNote,
+                    onPressedChange = { isPressed = it },
+                    onNoteOn = onNoteOn,
+                    onNoteOff = onNoteOff,
+                    onNoteExpression = onNoteExpression
                 )
             },
         contentAlignment = Alignment.BottomCenter
@@ -206,8 +213,9 @@ fun WhiteKey(
 @Composable
 fun BlackKey(
     key: PianoKey,
-    onNoteOn: (Int) -> Unit,
+    onNoteOn: (Int, Float) -> Unit,
     onNoteOff: (Int) -> Unit,
+    onNoteExpression: ((Int, Int, Float) -> Unit)?,
     modifier: Modifier = Modifier
 ) {
     var isPressed by remember { mutableStateOf(false) }
@@ -253,19 +261,59 @@ fun BlackKey(
                 )
             )
             .pointerInput(key.midiNote) {
-                detectTapGestures(
-                    onPress = { offset ->
-                        try {
-                            isPressed = true
-                            onNoteOn(key.midiNote)
-                            tryAwaitRelease()
-                        } finally {
-                            // ALWAYS call noteOff, even if interrupted
-                            isPressed = false
-                            onNoteOff(key.midiNote)
-                        }
-                    }
+                trackKeyPress(
+                    midiNote = key.midiNote,
+                    onPressedChange = { isPressed = it },
+                    onNoteOn = onNoteOn,
+                    onNoteOff = onNoteOff,
+                    onNoteExpression = onNoteExpression
                 )
             }
     )
 }
+
+/**
+ * Plays one note per touch and streams its expression while it is held.
+ * Expression updates are sent on every move; SynthEngine coalesces them to
+ * one update per note and lane per frame.
+ */
+private suspend fun PointerInputScope.trackKeyPress(
+    midiNote: Int,
+    onPressedChange: (Boolean) -> Unit,
+    onNoteOn: (Int, Float) -> Unit,
+    onNoteOff: (Int) -> Unit,
+    onNoteExpression: ((Int, Int, Float) -> Unit)?
+) {
+    awaitEachGesture {
+        val down = awaitFirstDown()
+        val keyHeight = size.height.toFloat().coerceAtLeast(1f)
+        val keyWidth = size.width.toFloat().coerceAtLeast(1f)
+        val velocity = (0.3f + 0.7f * down.position.y / keyHeight).coerceIn(0.05f, 1f)
+
+        try {
+            onPressedChange(true)
+            onNoteOn(midiNote, velocity)
+            if (onNoteExpression != null && down.pressure > 0f) {
+                onNoteExpression(midiNote, NoteExpression.PRESSURE, down.pressure.coerceIn(0f, 1f))
+            }
+
+            while (true) {
+                val event = awaitPointerEvent()
+                val change = event.changes.firstOrNull { it.id == down.id } ?: break
+                if (!change.pressed) break
+                change.consume()
+
+                if (onNoteExpression != null) {
+                    val bend = (change.position.x - down.position.x) / keyWidth
+                    onNoteExpression(midiNote, NoteExpression.PITCH_BEND, bend)
+                    onNoteExpression(midiNote, NoteExpression.TIMBRE, (change.position.y / keyHeight).coerceIn(0f, 1f))
+                    onNoteExpression(midiNote, NoteExpression.PRESSURE, change.pressure.coerceIn(0f, 1f))
+                }
+            }
+        } finally {
+            // ALWAYS call noteOff, even if interrupted
+            onPressedChange(false)
+            onNoteOff(midiNote)
+        }
+    }
+}
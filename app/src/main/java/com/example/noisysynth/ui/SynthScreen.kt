@@ -408,8 +408,9 @@ fun SynthScreen(synthEngine: SynthEngine) {
             ) {
          // Piano Keyboard
                 SimplePianoKeyboard(
-                    onNoteOn = { note -> synthEngine.noteOn(note) },
-                    onNoteOff = { note -> synthEngine.noteOff(note) }
+                    onNoteOn = { note, velocity -> synthEngine.noteOn(note, velocity) },
+                    onNoteOff = { note -> synthEngine.noteOff(note) },
+                    onNoteExpression = { note, lane, value -> synthEngine.setNoteExpression(note, lane, value) }
                 )
             }
         }
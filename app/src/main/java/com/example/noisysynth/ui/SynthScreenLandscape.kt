@@ -162,7 +162,7 @@ fun SynthScreenLandscape(synthEngine: SynthEngine) {
                     accentColor = Color(0xFF6200EA),
                     modifier = Modifier.weight(1f)
                 ) {
-                    val waveforms = listOf("Sine", "Saw", "Sqr", "Tri")
+                    val waveforms = listOf("Sine", "Saw", "Sqr", "Tri", "Noise", "Pink")
                     waveforms.forEachIndexed { index, name ->
                         Button(
                             onClick = {
@@ -650,8 +650,9 @@ fun SynthScreenLandscape(synthEngine: SynthEngine) {
                 contentAlignment = Alignment.Center
             ) {
                 SimplePianoKeyboard(
-                    onNoteOn = { note -> synthEngine.noteOn(note) },
+                    onNoteOn = { note, velocity -> synthEngine.noteOn(note, velocity) },
                     onNoteOff = { note -> synthEngine.noteOff(note) },
+                    onNoteExpression = { note, lane, value -> synthEngine.setNoteExpression(note, lane, value) },
                     height = 90
                 )
             }
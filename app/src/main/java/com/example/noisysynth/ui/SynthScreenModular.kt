@@ -126,7 +126,7 @@ fun SynthScreenModular(synthEngine: SynthEngine) {
                     accentColor = Color(0xFF6200EA),
                     modifier = Modifier.weight(1f)
                 ) {
-                    val waveforms = listOf("Sine", "Saw", "Square", "Triangle")
+                    val waveforms = listOf("Sine", "Saw", "Square", "Triangle", "Noise", "Pink")
                     waveforms.forEachIndexed { index, name ->
                         Button(
                             onClick = {
@@ -455,8 +455,9 @@ fun SynthScreenModular(synthEngine: SynthEngine) {
                 horizontalAlignment = Alignment.CenterHorizontally
             ) {
                 SimplePianoKeyboard(
-                    onNoteOn = { note -> synthEngine.noteOn(note) },
-                    onNoteOff = { note -> synthEngine.noteOff(note) }
+                    onNoteOn = { note, velocity -> synthEngine.noteOn(note, velocity) },
+                    onNoteOff = { note -> synthEngine.noteOff(note) },
+                    onNoteExpression = { note, lane, value -> synthEngine.setNoteExpression(note, lane, value) }
                 )
             }
         }